@@ -100,6 +100,9 @@ GetConsoleKeyboardLayoutNameW(
 #define CONSOLE_REGISTRY_DEFAULTFOREGROUND             L"DefaultForeground"
 #define CONSOLE_REGISTRY_DEFAULTBACKGROUND             L"DefaultBackground"
 #define CONSOLE_REGISTRY_TERMINALSCROLLING             L"TerminalScrolling"
+#define CONSOLE_REGISTRY_FRAMERATELIMIT                L"FrameRateLimit"
+#define CONSOLE_REGISTRY_FLOODTHRESHOLD                L"FloodThreshold"
+#define CONSOLE_REGISTRY_FLOODFRAMERATE                L"FloodFrameRate"
 // end V2 console settings
 
     /*
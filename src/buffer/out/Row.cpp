@@ -196,3 +196,32 @@ OutputCellIterator ROW::WriteCells(OutputCellIterator it, const size_t index, co
 
     return it;
 }
+
+// Routine Description:
+// - writes a run of printable ASCII characters to the row, all with the same
+//   attributes. Each of them takes up exactly one cell, so this needs none of
+//   the measuring and DBCS handling of WriteCells.
+// Arguments:
+// - index - column in row to start writing at
+// - chars - the characters to write. They must fit in the row.
+// - attr - the attributes to write them with
+// Return Value:
+// - <none>
+void ROW::WriteAsciiRun(const size_t index, const std::wstring_view chars, const TextAttribute& attr)
+{
+    THROW_HR_IF(E_INVALIDARG, index > _charRow.size() || chars.size() > _charRow.size() - index);
+    if (chars.empty())
+    {
+        return;
+    }
+
+    auto cell = _charRow.begin() + index;
+    for (const auto wch : chars)
+    {
+        cell->Char() = wch;
+        cell->DbcsAttr() = DbcsAttribute{};
+        ++cell;
+    }
+
+    _attrRow.Replace(gsl::narrow_cast<uint16_t>(index), gsl::narrow_cast<uint16_t>(index + chars.size()), attr);
+}
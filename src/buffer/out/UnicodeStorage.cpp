@@ -3,6 +3,7 @@
 
 #include "precomp.h"
 #include "UnicodeStorage.hpp"
+#include "til/counters.h"
 
 UnicodeStorage::UnicodeStorage() noexcept :
     _map{}
@@ -28,6 +29,8 @@ const UnicodeStorage::mapped_type& UnicodeStorage::GetText(const key_type key) c
 // - glyph - the glyph data to store
 void UnicodeStorage::StoreGlyph(const key_type key, const mapped_type& glyph)
 {
+    TIL_COUNTER_INCREMENT(glyph_allocations);
+
     _map.insert_or_assign(key, glyph);
 }
 
@@ -96,3 +99,36 @@ void UnicodeStorage::Remap(const std::unordered_map<SHORT, SHORT>& rowMap, const
     // Swap into the stored map, free the temporary when we exit.
     _map.swap(newMap);
 }
+
+// Routine Description:
+// - Moves the stored items of some rows to new row IDs. Unlike Remap, the
+//   items of rows that aren't in the map are kept where they are.
+// Arguments:
+// - rowMap - A map of the old row IDs to the new row IDs of the rows that moved.
+void UnicodeStorage::MoveRows(const std::unordered_map<SHORT, SHORT>& rowMap)
+{
+    // Nothing moved or nothing stored, so there's nothing to re-key.
+    if (rowMap.empty() || _map.empty())
+    {
+        return;
+    }
+
+    // Make a temporary map to hold all the new row positioning
+    std::unordered_map<key_type, mapped_type> newMap;
+
+    for (auto& pair : _map)
+    {
+        auto coord = pair.first;
+
+        const auto mapIter = rowMap.find(coord.Y);
+        if (mapIter != rowMap.end())
+        {
+            coord.Y = mapIter->second;
+        }
+
+        newMap.emplace(coord, std::move(pair.second));
+    }
+
+    // Swap into the stored map, free the temporary when we exit.
+    _map.swap(newMap);
+}
@@ -288,6 +288,34 @@ void Cursor::CopyProperties(const Cursor& OtherCursor) noexcept
     _color = OtherCursor._color;
 }
 
+// Routine Description:
+// - Puts the cursor back into the state it was constructed in, for a buffer
+//   that is being reused instead of created anew.
+// Arguments:
+// - ulSize - The size of the cursor, as given to the constructor
+// Return Value:
+// - <none>
+void Cursor::Reset(const ULONG ulSize) noexcept
+{
+    _cPosition = { 0 };
+    _fHasMoved = false;
+    _fIsVisible = true;
+    _fIsOn = true;
+    _fIsDouble = false;
+    _fBlinkingAllowed = true;
+    _fDelay = false;
+    _fIsConversionArea = false;
+    _fIsPopupShown = false;
+    _fDelayedEolWrap = false;
+    _coordDelayedAt = { 0 };
+    _fDeferCursorRedraw = false;
+    _fHaveDeferredCursorRedraw = false;
+    _ulSize = ulSize;
+    _cursorType = CursorType::Legacy;
+    _fUseColor = false;
+    _color = s_InvertCursorColor;
+}
+
 void Cursor::DelayEOLWrap(const COORD coordDelayedAt) noexcept
 {
     _coordDelayedAt = coordDelayedAt;
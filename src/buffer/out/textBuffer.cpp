@@ -9,6 +9,7 @@
 #include "../types/inc/utils.hpp"
 #include "../types/inc/convert.hpp"
 #include "../../types/inc/GlyphWidth.hpp"
+#include "til/counters.h"
 
 #pragma hdrstop
 
@@ -379,6 +380,8 @@ OutputCellIterator TextBuffer::WriteLine(const OutputCellIterator givenIt,
         return givenIt;
     }
 
+    TIL_COUNTER_INCREMENT(rows_written);
+
     //  Get the row and write the cells
     ROW& row = GetRowByOffset(target.Y);
     const auto newIt = row.WriteCells(givenIt, target.X, wrap, limitRight);
@@ -391,6 +394,30 @@ OutputCellIterator TextBuffer::WriteLine(const OutputCellIterator givenIt,
     return newIt;
 }
 
+// Routine Description:
+// - Writes a run of printable ASCII characters to one line of the output
+//   buffer, all with the same attributes. This is a faster WriteLine for the
+//   most common kind of text. See ROW::WriteAsciiRun.
+// Arguments:
+// - chars - The characters to write. They must fit on the line.
+// - target - Coordinate targeted within output buffer
+// - attr - The attributes to write the characters with
+// Return Value:
+// - <none>
+void TextBuffer::WriteAsciiRun(const std::wstring_view chars, const COORD target, const TextAttribute& attr)
+{
+    if (chars.empty() || !GetSize().IsInBounds(target))
+    {
+        return;
+    }
+
+    TIL_COUNTER_INCREMENT(rows_written);
+
+    GetRowByOffset(target.Y).WriteAsciiRun(target.X, chars, attr);
+
+    _NotifyPaint(Viewport::FromDimensions(target, { gsl::narrow<SHORT>(chars.size()), 1 }));
+}
+
 //Routine Description:
 // - Inserts one codepoint into the buffer at the current cursor position and advances the cursor as appropriate.
 //Arguments:
@@ -690,95 +717,88 @@ void TextBuffer::ScrollRows(const SHORT firstRow, const SHORT size, const SHORT
 
     // OK. We're about to play games by moving rows around within the deque to
     // scroll a massive region in a faster way than copying things.
-    // To make this easier, first correct the circular buffer to have the first row be 0 again.
-    if (_firstRow != 0)
+    // Only the rows that are moved and the rows they're moved over take part.
+    const size_t rangeTop = delta < 0 ? firstRow + delta : firstRow;
+    const size_t rangeHeight = size + std::abs(delta);
+    const size_t totalRows = TotalRowCount();
+
+    // Rows are stored circularly. As long as the range doesn't wrap around the
+    // end of the storage, we can rotate it right where it is. Otherwise, first
+    // correct the circular buffer to have the first row be 0 again.
+    size_t storageTop = (_firstRow + rangeTop) % totalRows;
+    const bool wrapped = storageTop + rangeHeight > totalRows;
+    if (wrapped)
     {
         // Rotate the buffer to put the first row at the front.
         std::rotate(_storage.begin(), _storage.begin() + _firstRow, _storage.end());
 
         // The first row is now at the top.
         _firstRow = 0;
+        storageTop = rangeTop;
     }
 
+    const auto rangeBegin = _storage.begin() + storageTop;
+    const auto rangeEnd = rangeBegin + rangeHeight;
+
     // Rotate just the subsection specified
     if (delta < 0)
     {
         // The layout is like this:
         // delta is -2, size is 3, firstRow is 5
         // We want 3 rows from 5 (5, 6, and 7) to move up 2 spots.
-        // --- (storage) ----
-        // | 0 begin
-        // | 1
-        // | 2
-        // | 3 A. begin + firstRow + delta (because delta is negative)
+        // --- (range) ----
+        // | 3 A. rangeBegin
         // | 4
-        // | 5 B. begin + firstRow
+        // | 5 B. rangeBegin - delta (because delta is negative)
         // | 6
         // | 7
-        // | 8 C. begin + firstRow + size
-        // | 9
-        // | 10
-        // | 11
-        // - end
+        // - C. rangeEnd
         // We want B to slide up to A (the negative delta) and everything from [B,C) to slide up with it.
         // So the final layout will be
-        // --- (storage) ----
-        // | 0 begin
-        // | 1
-        // | 2
+        // --- (range) ----
         // | 5
         // | 6
         // | 7
         // | 3
         // | 4
-        // | 8
-        // | 9
-        // | 10
-        // | 11
-        // - end
-        std::rotate(_storage.begin() + firstRow + delta, _storage.begin() + firstRow, _storage.begin() + firstRow + size);
+        // - rangeEnd
+        std::rotate(rangeBegin, rangeBegin - delta, rangeEnd);
     }
     else
     {
         // The layout is like this:
         // delta is 2, size is 3, firstRow is 5
         // We want 3 rows from 5 (5, 6, and 7) to move down 2 spots.
-        // --- (storage) ----
-        // | 0 begin
-        // | 1
-        // | 2
-        // | 3
-        // | 4
-        // | 5 A. begin + firstRow
+        // --- (range) ----
+        // | 5 A. rangeBegin
         // | 6
         // | 7
-        // | 8 B. begin + firstRow + size
+        // | 8 B. rangeBegin + size
         // | 9
-        // | 10 C. begin + firstRow + size + delta
-        // | 11
-        // - end
+        // - C. rangeEnd
         // We want B-1 to slide down to C-1 (the positive delta) and everything from [A, B) to slide down with it.
         // So the final layout will be
-        // --- (storage) ----
-        // | 0 begin
-        // | 1
-        // | 2
-        // | 3
-        // | 4
+        // --- (range) ----
         // | 8
         // | 9
         // | 5
         // | 6
         // | 7
-        // | 10
-        // | 11
-        // - end
-        std::rotate(_storage.begin() + firstRow, _storage.begin() + firstRow + size, _storage.begin() + firstRow + size + delta);
+        // - rangeEnd
+        std::rotate(rangeBegin, rangeBegin + size, rangeEnd);
     }
 
     // Renumber the IDs now that we've rearranged where the rows sit within the buffer.
     // Refreshing should also delegate to the UnicodeStorage to re-key all the stored unicode sequences (where applicable).
-    _RefreshRowIDs(std::nullopt);
+    // If we didn't have to rotate the whole buffer, only the rows in the range have moved.
+    if (wrapped)
+    {
+        _RefreshRowIDs(std::nullopt);
+    }
+    else
+    {
+        _RefreshRowIDs(storageTop, storageTop + rangeHeight);
+    }
 }
 
 Cursor& TextBuffer::GetCursor() noexcept
@@ -886,6 +906,28 @@ void TextBuffer::Reset()
     }
 }
 
+// Routine Description:
+// - Puts this buffer back into the state it was constructed in, keeping its
+//   size and the storage of its rows. This lets a buffer be reused for the
+//   same purpose at the cost of clearing it, rather than reallocating it.
+// Arguments:
+// - defaultAttributes - the attributes the buffer would be constructed with
+// - cursorSize - the cursor size the buffer would be constructed with
+// Return Value:
+// - <none>
+void TextBuffer::ResetToDefaults(const TextAttribute defaultAttributes, const UINT cursorSize)
+{
+    _currentAttributes = defaultAttributes;
+    _cursor.Reset(cursorSize);
+    _SetFirstRowIndex(0);
+    Reset();
+
+    _unicodeStorage = UnicodeStorage{};
+    _hyperlinkMap.clear();
+    _hyperlinkCustomIdMap.clear();
+    _currentHyperlinkId = 1;
+}
+
 // Routine Description:
 // - This is the legacy screen resize with minimal changes
 // Arguments:
@@ -988,6 +1030,37 @@ void TextBuffer::_RefreshRowIDs(std::optional<SHORT> newRowWidth)
     _unicodeStorage.Remap(rowMap, newRowWidth);
 }
 
+// Routine Description:
+// - Renumbers the rows in the given range of the storage after they have been
+//   moved around, without touching the rest of the buffer.
+// Arguments:
+// - begin - The index of the first row in the storage to renumber
+// - end - The index after the last row in the storage to renumber
+// Return Value:
+// - <none>
+void TextBuffer::_RefreshRowIDs(const size_t begin, const size_t end)
+{
+    std::unordered_map<SHORT, SHORT> rowMap;
+    for (auto i = begin; i < end; ++i)
+    {
+        auto& row = _storage.at(i);
+        const auto id = gsl::narrow_cast<SHORT>(i);
+
+        // Build a map so we can update Unicode Storage
+        if (row.GetId() != id)
+        {
+            rowMap.emplace(row.GetId(), id);
+            row.SetId(id);
+        }
+
+        // Also update the char row parent pointers as they can get shuffled up in the rotates.
+        row.GetCharRow().UpdateParent(&row);
+    }
+
+    // Give the new mapping to Unicode Storage
+    _unicodeStorage.MoveRows(rowMap);
+}
+
 void TextBuffer::_NotifyPaint(const Viewport& viewport) const
 {
     _renderTarget.TriggerRedraw(viewport);
@@ -2116,6 +2189,8 @@ HRESULT TextBuffer::Reflow(TextBuffer& oldBuffer,
                            const std::optional<Viewport> lastCharacterViewport,
                            std::optional<std::reference_wrapper<PositionInformation>> positionInfo)
 {
+    TIL_COUNTER_INCREMENT(reflows);
+
     const Cursor& oldCursor = oldBuffer.GetCursor();
     Cursor& newCursor = newBuffer.GetCursor();
 
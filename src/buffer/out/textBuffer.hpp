@@ -97,6 +97,8 @@ public:
                                  const std::optional<bool> setWrap = std::nullopt,
                                  const std::optional<size_t> limitRight = std::nullopt);
 
+    void WriteAsciiRun(const std::wstring_view chars, const COORD target, const TextAttribute& attr);
+
     bool InsertCharacter(const wchar_t wch, const DbcsAttribute dbcsAttribute, const TextAttribute attr);
     bool InsertCharacter(const std::wstring_view chars, const DbcsAttribute dbcsAttribute, const TextAttribute attr);
     bool IncrementCursor();
@@ -133,6 +135,7 @@ public:
     COORD BufferToScreenPosition(const COORD position) const;
 
     void Reset();
+    void ResetToDefaults(const TextAttribute defaultAttributes, const UINT cursorSize);
 
     [[nodiscard]] HRESULT ResizeTraditional(const COORD newSize) noexcept;
 
@@ -218,6 +221,7 @@ private:
     uint16_t _currentHyperlinkId;
 
     void _RefreshRowIDs(std::optional<SHORT> newRowWidth);
+    void _RefreshRowIDs(const size_t begin, const size_t end);
 
     Microsoft::Console::Render::IRenderTarget& _renderTarget;
 
@@ -9,6 +9,7 @@
 #include "../../inc/argb.h"
 #include "../../types/inc/utils.hpp"
 #include "../../types/inc/colorTable.hpp"
+#include "til/counters.h"
 
 #include <winrt/Microsoft.Terminal.Core.h>
 
@@ -426,6 +427,21 @@ void Terminal::Write(std::wstring_view stringView)
     _stateMachine->ProcessString(stringView);
 }
 
+// Method Description:
+// - Writes UTF-8 encoded output to the terminal. The state machine transcodes
+//   the printable text itself, which spares the caller a UTF-16 copy of
+//   every chunk. Code points may be split across calls.
+// Arguments:
+// - stringView - the UTF-8 output to process
+// Return Value:
+// - <none>
+void Terminal::WriteUtf8(std::string_view stringView)
+{
+    auto lock = LockForWriting();
+
+    _stateMachine->ProcessUtf8(stringView);
+}
+
 void Terminal::WritePastedText(std::wstring_view stringView)
 {
     auto option = ::Microsoft::Console::Utils::FilterOption::CarriageReturnNewline |
@@ -862,6 +878,7 @@ WORD Terminal::_TakeVirtualKeyFromLastKeyEvent(const WORD scanCode) noexcept
 //      will release this lock when it's destructed.
 [[nodiscard]] std::unique_lock<til::ticket_lock> Terminal::LockForReading()
 {
+    TIL_HISTOGRAM_TIME_SCOPE(lock_wait_ns);
     return std::unique_lock{ _readWriteLock };
 }
 
@@ -872,6 +889,7 @@ WORD Terminal::_TakeVirtualKeyFromLastKeyEvent(const WORD scanCode) noexcept
 //      will release this lock when it's destructed.
 [[nodiscard]] std::unique_lock<til::ticket_lock> Terminal::LockForWriting()
 {
+    TIL_HISTOGRAM_TIME_SCOPE(lock_wait_ns);
     return std::unique_lock{ _readWriteLock };
 }
 
@@ -75,6 +75,7 @@ public:
 
     // Write goes through the parser
     void Write(std::wstring_view stringView);
+    void WriteUtf8(std::string_view stringView);
 
     // WritePastedText goes directly to the connection
     void WritePastedText(std::wstring_view stringView);
@@ -80,6 +80,15 @@ CATCH_LOG_RETURN_FALSE()
 
 bool TerminalDispatch::CursorUp(const size_t distance) noexcept
 try
+{
+    const auto cursorPos = _terminalApi.GetCursorPosition();
+    const COORD newCursorPos{ cursorPos.X, cursorPos.Y - gsl::narrow<short>(distance) };
+    return _terminalApi.SetCursorPosition(newCursorPos.X, newCursorPos.Y);
+}
+CATCH_LOG_RETURN_FALSE()
+
+bool TerminalDispatch::CursorDown(const size_t distance) noexcept
+try
 {
     const auto cursorPos = _terminalApi.GetCursorPosition();
     const COORD newCursorPos{ cursorPos.X, cursorPos.Y + gsl::narrow<short>(distance) };
@@ -87,6 +96,24 @@ try
 }
 CATCH_LOG_RETURN_FALSE()
 
+bool TerminalDispatch::CursorHorizontalPositionAbsolute(const size_t column) noexcept
+try
+{
+    const auto cursorPos = _terminalApi.GetCursorPosition();
+    const COORD newCursorPos{ gsl::narrow<short>(column - 1), cursorPos.Y };
+    return _terminalApi.SetCursorPosition(newCursorPos.X, newCursorPos.Y);
+}
+CATCH_LOG_RETURN_FALSE()
+
+bool TerminalDispatch::VerticalLinePositionAbsolute(const size_t line) noexcept
+try
+{
+    const auto cursorPos = _terminalApi.GetCursorPosition();
+    const COORD newCursorPos{ cursorPos.X, gsl::narrow<short>(line - 1) };
+    return _terminalApi.SetCursorPosition(newCursorPos.X, newCursorPos.Y);
+}
+CATCH_LOG_RETURN_FALSE()
+
 bool TerminalDispatch::LineFeed(const DispatchTypes::LineFeedType lineFeedType) noexcept
 try
 {
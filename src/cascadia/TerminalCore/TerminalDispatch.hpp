@@ -32,6 +32,9 @@ public:
     bool CursorForward(const size_t distance) noexcept override;
     bool CursorBackward(const size_t distance) noexcept override;
     bool CursorUp(const size_t distance) noexcept override;
+    bool CursorDown(const size_t distance) noexcept override;
+    bool CursorHorizontalPositionAbsolute(const size_t column) noexcept override; // HPA, CHA
+    bool VerticalLinePositionAbsolute(const size_t line) noexcept override; // VPA
 
     bool LineFeed(const ::Microsoft::Console::VirtualTerminal::DispatchTypes::LineFeedType lineFeedType) noexcept override;
 
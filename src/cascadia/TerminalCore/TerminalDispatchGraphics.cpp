@@ -3,6 +3,7 @@
 
 #include "pch.h"
 #include "TerminalDispatch.hpp"
+#include "../../terminal/adapter/CommonGraphicsRendition.hpp"
 
 using namespace Microsoft::Console::VirtualTerminal;
 using namespace Microsoft::Console::VirtualTerminal::DispatchTypes;
@@ -30,6 +31,8 @@ const BYTE BRIGHT_CYAN    = BRIGHT_ATTR | GREEN_ATTR | BLUE_ATTR;
 const BYTE BRIGHT_WHITE   = BRIGHT_ATTR | RED_ATTR | GREEN_ATTR | BLUE_ATTR;
 // clang-format on
 
+static constexpr auto colorTransitions = CommonGraphicsRendition::s_BuildColorTransitions({ DARK_BLACK, DARK_RED, DARK_GREEN, DARK_YELLOW, DARK_BLUE, DARK_MAGENTA, DARK_CYAN, DARK_WHITE });
+
 // Routine Description:
 // - Helper to parse extended graphics options, which start with 38 (FG) or 48 (BG)
 //     These options are followed by either a 2 (RGB) or 5 (xterm index)
@@ -94,6 +97,16 @@ bool TerminalDispatch::SetGraphicsRendition(const VTParameters options) noexcept
 {
     TextAttribute attr = _terminalApi.GetTextAttributes();
 
+    // Most sequences only reset and/or change one color. Those don't need to
+    // go through the loop below.
+    if (CommonGraphicsRendition::s_TryApply(options, attr, colorTransitions, [&](const VTParameters subOptions, const bool isForeground) noexcept {
+            _SetRgbColorsHelper(subOptions, attr, isForeground);
+        }))
+    {
+        _terminalApi.SetTextAttributes(attr);
+        return true;
+    }
+
     // Run through the graphics options and apply them
     for (size_t i = 0; i < options.size(); i++)
     {
@@ -4,6 +4,7 @@
 #include "pch.h"
 #include "Terminal.hpp"
 #include <DefaultSettings.h>
+#include "til/counters.h"
 using namespace Microsoft::Terminal::Core;
 using namespace Microsoft::Console::Types;
 using namespace Microsoft::Console::Render;
@@ -230,6 +231,7 @@ catch (...)
 //      they're done with any querying they need to do.
 void Terminal::LockConsole() noexcept
 {
+    TIL_HISTOGRAM_TIME_SCOPE(lock_wait_ns);
     _readWriteLock.lock();
 }
 
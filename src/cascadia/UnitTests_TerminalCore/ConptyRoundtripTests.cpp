@@ -9,6 +9,9 @@
 // output, and then flush the output of the VtEngine straight to the Terminal.
 
 #include "pch.h"
+
+#include <chrono>
+
 #include "../../types/inc/Viewport.hpp"
 #include "../../types/inc/convert.hpp"
 
@@ -218,6 +221,11 @@ class TerminalCoreUnitTests::ConptyRoundtripTests final
 
     TEST_METHOD(ResizeInitializeBufferWithDefaultAttrs);
 
+    TEST_METHOD(PassthroughModeWritesOutputOnce);
+    TEST_METHOD(PassthroughModeAnswersQueriesOnce);
+    TEST_METHOD(PassthroughModeKeepsSplitSequences);
+    TEST_METHOD(PassthroughModeThroughput);
+
 private:
     bool _writeCallback(const char* const pch, size_t const cch);
     void _flushFirstFrame();
@@ -233,6 +241,7 @@ private:
     // Tests can set these variables how they link to configure the behavior of the test harness.
     bool _checkConptyOutput{ true }; // If true, the test class will check that the output from conpty was expected
     bool _logConpty{ false }; // If true, the test class will log all the output from conpty. Helpful for debugging.
+    size_t _writtenBytes{ 0 }; // The number of bytes conpty wrote to the terminal.
 
     DummyRenderTarget emptyRT;
     std::unique_ptr<Terminal> term;
@@ -243,6 +252,7 @@ private:
 bool ConptyRoundtripTests::_writeCallback(const char* const pch, size_t const cch)
 {
     std::string actualString = std::string(pch, cch);
+    _writtenBytes += cch;
 
     if (_checkConptyOutput)
     {
@@ -412,8 +422,10 @@ void ConptyRoundtripTests::WriteAFewSimpleLines()
     expectedOutput.push_back("\r\n");
     expectedOutput.push_back("BBB");
     // Jump down to the fourth line because emitting spaces didn't do anything
-    // and we will skip to emitting the CCC segment.
-    expectedOutput.push_back("\x1b[4;1H");
+    // and we will skip to emitting the CCC segment. Two line feeds and a
+    // carriage return are shorter than a CUP.
+    expectedOutput.push_back("\n\n");
+    expectedOutput.push_back("\r");
     expectedOutput.push_back("CCC");
 
     // Cursor goes back on.
@@ -521,8 +533,9 @@ void ConptyRoundtripTests::TestAdvancedWrapping()
     expectedOutput.push_back(R"(qrstuvwxyz{|}~!"#$%&)");
     // This is the hard line break
     expectedOutput.push_back("\r\n");
-    // Now write row 2 of the buffer
-    expectedOutput.push_back("          1234567890");
+    // Now write row 2 of the buffer. The leading spaces are sent as one
+    // space, followed by a REP of the other nine.
+    expectedOutput.push_back(" \x1b[9b1234567890");
     VERIFY_SUCCEEDED(renderer.PaintFrame());
 
     verifyBuffer(termTb);
@@ -654,8 +667,9 @@ void ConptyRoundtripTests::TestExactWrappingWithSpaces()
 
     // This is the hard line break
     expectedOutput.push_back("\r\n");
-    // Now write row 2 of the buffer
-    expectedOutput.push_back("          1234567890");
+    // Now write row 2 of the buffer. The leading spaces are sent as one
+    // space, followed by a REP of the other nine.
+    expectedOutput.push_back(" \x1b[9b1234567890");
     VERIFY_SUCCEEDED(renderer.PaintFrame());
 
     verifyBuffer(termTb);
@@ -690,7 +704,7 @@ void ConptyRoundtripTests::MoveCursorAtEOL()
     // TODO: GH#405/#4415 - Before #405 merges, the VT sequences conpty emits
     // might change, but the buffer contents shouldn't.
     // If they do change and these tests break, that's to be expected.
-    expectedOutput.push_back(std::string(TerminalViewWidth, 'A'));
+    expectedOutput.push_back("A\x1b[79b"); // 80 'A's, using REP
     expectedOutput.push_back("\x1b[1;80H");
 
     VERIFY_SUCCEEDED(renderer.PaintFrame());
@@ -996,10 +1010,10 @@ void ConptyRoundtripTests::PassthroughClearScrollback()
         }
         else
         {
-            // After we hit the bottom of the viewport, the newlines come in
-            // separated by empty writes for whatever reason.
-            expectedOutput.push_back("\r");
-            expectedOutput.push_back("\n");
+            // After we hit the bottom of the viewport, the newline that
+            // scrolls in the new bottom line is followed by an empty write,
+            // since there's nothing on that line yet.
+            expectedOutput.push_back("\r\n");
             expectedOutput.push_back("");
         }
 
@@ -1160,10 +1174,10 @@ void ConptyRoundtripTests::PassthroughHardReset()
         }
         else
         {
-            // After we hit the bottom of the viewport, the newlines come in
-            // separated by empty writes for whatever reason.
-            expectedOutput.push_back("\r");
-            expectedOutput.push_back("\n");
+            // After we hit the bottom of the viewport, the newline that
+            // scrolls in the new bottom line is followed by an empty write,
+            // since there's nothing on that line yet.
+            expectedOutput.push_back("\r\n");
             expectedOutput.push_back("");
         }
 
@@ -1236,8 +1250,8 @@ void ConptyRoundtripTests::OutputWrappedLinesAtTopOfBuffer()
 
     verifyBuffer(hostTb);
 
-    expectedOutput.push_back(std::string(TerminalViewWidth, 'A'));
-    expectedOutput.push_back(std::string(20, 'A'));
+    expectedOutput.push_back("A\x1b[79b"); // 80 'A's, using REP
+    expectedOutput.push_back("A\x1b[19b"); // 20 'A's
     VERIFY_SUCCEEDED(renderer.PaintFrame());
 
     verifyBuffer(termTb);
@@ -1272,10 +1286,10 @@ void ConptyRoundtripTests::OutputWrappedLinesAtBottomOfBuffer()
         }
         else
         {
-            // After we hit the bottom of the viewport, the newlines come in
-            // separated by empty writes for whatever reason.
-            expectedOutput.push_back("\r");
-            expectedOutput.push_back("\n");
+            // After we hit the bottom of the viewport, the newline that
+            // scrolls in the new bottom line is followed by an empty write,
+            // since there's nothing on that line yet.
+            expectedOutput.push_back("\r\n");
             expectedOutput.push_back("");
         }
 
@@ -1299,7 +1313,7 @@ void ConptyRoundtripTests::OutputWrappedLinesAtBottomOfBuffer()
     // |X              | (b)
     // |_              | (b)
 
-    expectedOutput.push_back(std::string(TerminalViewWidth, 'A'));
+    expectedOutput.push_back("A\x1b[79b"); // 80 'A's, using REP
     // |X              | (b)
     // |X              | (b)
     // ...
@@ -1332,7 +1346,7 @@ void ConptyRoundtripTests::OutputWrappedLinesAtBottomOfBuffer()
     // |AAAAAAAA...AAAA|_ (w) The cursor is actually on the last A here
     // |               | (b)
 
-    expectedOutput.push_back(std::string(20, 'A')); // Print the second line.
+    expectedOutput.push_back("A\x1b[19b"); // Print the second line, 20 'A's.
     // |X              | (b)
     // |X              | (b)
     // ...
@@ -1405,10 +1419,10 @@ void ConptyRoundtripTests::ScrollWithChangesInMiddle()
         }
         else
         {
-            // After we hit the bottom of the viewport, the newlines come in
-            // separated by empty writes for whatever reason.
-            expectedOutput.push_back("\r");
-            expectedOutput.push_back("\n");
+            // After we hit the bottom of the viewport, the newline that
+            // scrolls in the new bottom line is followed by an empty write,
+            // since there's nothing on that line yet.
+            expectedOutput.push_back("\r\n");
             expectedOutput.push_back("");
         }
 
@@ -1420,10 +1434,11 @@ void ConptyRoundtripTests::ScrollWithChangesInMiddle()
     const auto wrappedLineLength = TerminalViewWidth + 20;
 
     // In the Terminal, we're going to expect:
-    expectedOutput.push_back("\x1b[15;1H"); // Move the cursor to row 14, col 0
+    expectedOutput.push_back("\x1b[17A"); // Move the cursor up to row 14, col 0
     expectedOutput.push_back("Y"); // Print a 'Y'
-    expectedOutput.push_back("\x1b[32;1H"); // Move the cursor to the last row
-    expectedOutput.push_back(std::string(TerminalViewWidth, 'A')); // Print the first 80 'A's
+    expectedOutput.push_back("\x1b[17B"); // Move the cursor down to the last row...
+    expectedOutput.push_back("\r"); // ...and back to col 0
+    expectedOutput.push_back("A\x1b[79b"); // Print the first 80 'A's, using REP
     // This is going to be the end of the first frame - b/c we moved the cursor
     // in the middle of the frame, we're going to hide/show the cursor during
     // this frame
@@ -1434,7 +1449,7 @@ void ConptyRoundtripTests::ScrollWithChangesInMiddle()
     expectedOutput.push_back("\n"); // add a newline to the bottom of the buffer
     expectedOutput.push_back("\x1b[31;80H"); // Move the cursor BACK to the wrapped row
     expectedOutput.push_back(std::string(1, 'A')); // Reprint the last character of the wrapped row
-    expectedOutput.push_back(std::string(20, 'A')); // Print the second line.
+    expectedOutput.push_back("A\x1b[19b"); // Print the second line, 20 'A's.
 
     _logConpty = true;
 
@@ -1559,8 +1574,10 @@ void ConptyRoundtripTests::ScrollWithMargins()
         expectedOutput.push_back("\r\n");
     }
     {
-        const std::string expectedString(initialTermView.Width() - 1, '*');
-        expectedOutput.push_back(expectedString);
+        // The asterisks are sent as one, followed by a REP of the rest.
+        std::stringstream ss;
+        ss << "*\x1b[" << initialTermView.Width() - 2 << "b";
+        expectedOutput.push_back(ss.str());
     }
 
     Log::Comment(L"Verify host buffer contains pattern.");
@@ -1693,9 +1710,12 @@ void ConptyRoundtripTests::ScrollWithMargins()
         expectedOutput.push_back("\r\n");
     }
     {
-        const std::string expectedString(initialTermView.Width() - 1, '*');
+        // The asterisks are sent as one, followed by a REP of the rest.
+        std::stringstream ss;
+        ss << "*\x1b[" << initialTermView.Width() - 2 << "b";
         // There will be one extra blank space at the end of the line, to prevent delayed EOL wrapping
-        expectedOutput.push_back(expectedString + " ");
+        ss << " ";
+        expectedOutput.push_back(ss.str());
     }
     {
         // Cursor gets reset into second line from bottom, left most column
@@ -2141,7 +2161,8 @@ void ConptyRoundtripTests::OutputWrappedLineWithSpace()
     Log::Comment(L"========== Checking the host buffer state ==========");
     verifyBuffer(hostTb);
 
-    std::string firstLine = std::string(firstTextLength, 'A');
+    // The 'A's are sent as one, followed by a REP of the rest.
+    std::string firstLine = "A\x1b[" + std::to_string(firstTextLength - 1) + "b";
     firstLine += "  ";
     std::string secondLine{ " B" };
 
@@ -2185,10 +2206,10 @@ void ConptyRoundtripTests::OutputWrappedLineWithSpaceAtBottomOfBuffer()
         }
         else
         {
-            // After we hit the bottom of the viewport, the newlines come in
-            // separated by empty writes for whatever reason.
-            expectedOutput.push_back("\r");
-            expectedOutput.push_back("\n");
+            // After we hit the bottom of the viewport, the newline that
+            // scrolls in the new bottom line is followed by an empty write,
+            // since there's nothing on that line yet.
+            expectedOutput.push_back("\r\n");
             expectedOutput.push_back("");
         }
 
@@ -2201,7 +2222,8 @@ void ConptyRoundtripTests::OutputWrappedLineWithSpaceAtBottomOfBuffer()
     const auto spacesLength = 3;
     const auto secondTextLength = 1;
 
-    std::string firstLine = std::string(firstTextLength, 'A');
+    // The 'A's are sent as one, followed by a REP of the rest.
+    std::string firstLine = "A\x1b[" + std::to_string(firstTextLength - 1) + "b";
     firstLine += "  ";
     std::string secondLine{ " B" };
 
@@ -3675,3 +3697,221 @@ void ConptyRoundtripTests::HyperlinkIdConsistency()
     verifyData(hostTb);
     verifyData(termTb);
 }
+
+void doWriteChars(SCREEN_INFORMATION& screenInfo, const std::wstring_view string)
+{
+    size_t dwNumBytes = string.size() * sizeof(wchar_t);
+    VERIFY_SUCCESS_NTSTATUS(WriteChars(screenInfo,
+                                       string.data(),
+                                       string.data(),
+                                       string.data(),
+                                       &dwNumBytes,
+                                       nullptr,
+                                       screenInfo.GetTextBuffer().GetCursor().GetPosition().X,
+                                       WC_LIMIT_BACKSPACE,
+                                       nullptr));
+}
+
+void ConptyRoundtripTests::PassthroughModeWritesOutputOnce()
+{
+    Log::Comment(L"In passthrough mode, the output of a client that writes VT "
+                 L"must reach the terminal unmodified and only once, while the "
+                 L"host buffer is still updated.");
+
+    auto& g = ServiceLocator::LocateGlobals();
+    auto& renderer = *g.pRender;
+    auto& gci = g.getConsoleInformation();
+    auto& si = gci.GetActiveOutputBuffer();
+    auto& hostSm = si.GetStateMachine();
+    auto& hostTb = si.GetTextBuffer();
+    auto& termTb = *term->_buffer;
+
+    _flushFirstFrame();
+
+    const auto originalOutputMode = si.OutputMode;
+    WI_SetFlag(si.OutputMode, ENABLE_VIRTUAL_TERMINAL_PROCESSING);
+    gci.GetVtIo()->SetPassthroughModeForTests(true);
+    auto restore = wil::scope_exit([&]() {
+        gci.GetVtIo()->SetPassthroughModeForTests(false);
+        si.OutputMode = originalOutputMode;
+    });
+
+    expectedOutput.push_back("\x1b[31mHello\x1b[m\r\nWorld");
+    doWriteChars(si, L"\x1b[31mHello\x1b[m\r\nWorld");
+
+    Log::Comment(L"The terminal already got everything, there's nothing left to paint");
+    VERIFY_SUCCEEDED(renderer.PaintFrame());
+
+    auto verifyBuffer = [](const TextBuffer& tb) {
+        TestUtils::VerifyExpectedString(tb, L"Hello", { 0, 0 });
+        TestUtils::VerifyExpectedString(tb, L"World", { 0, 1 });
+        VERIFY_ARE_EQUAL(COORD({ 5, 1 }), tb.GetCursor().GetPosition());
+    };
+
+    Log::Comment(L"Checking the host buffer...");
+    verifyBuffer(hostTb);
+    Log::Comment(L"Checking the terminal buffer...");
+    verifyBuffer(termTb);
+
+    Log::Comment(L"Changes that didn't come from a client's VT output are still painted");
+    hostSm.ProcessString(L"!");
+    expectedOutput.push_back("!");
+    VERIFY_SUCCEEDED(renderer.PaintFrame());
+
+    TestUtils::VerifyExpectedString(termTb, L"World!", { 0, 1 });
+}
+
+void ConptyRoundtripTests::PassthroughModeAnswersQueriesOnce()
+{
+    Log::Comment(L"The terminal doesn't answer the queries in passed through "
+                 L"output, so conhost still has to. The client must get exactly "
+                 L"one reply to each of them.");
+
+    auto& g = ServiceLocator::LocateGlobals();
+    auto& gci = g.getConsoleInformation();
+    auto& si = gci.GetActiveOutputBuffer();
+
+    _flushFirstFrame();
+
+    const auto originalOutputMode = si.OutputMode;
+    WI_SetFlag(si.OutputMode, ENABLE_VIRTUAL_TERMINAL_PROCESSING);
+    gci.GetVtIo()->SetPassthroughModeForTests(true);
+    auto restore = wil::scope_exit([&]() {
+        gci.GetVtIo()->SetPassthroughModeForTests(false);
+        si.OutputMode = originalOutputMode;
+        gci.pInputBuffer->Flush();
+    });
+
+    gci.pInputBuffer->Flush();
+
+    // Neither query moves the cursor, so the CPR reports where it is now.
+    const auto cursor = si.GetTextBuffer().GetCursor().GetPosition();
+    const auto expectedReplies = wil::str_printf<std::wstring>(L"\x1b[?1;0c\x1b[%d;%dR",
+                                                               cursor.Y - si.GetViewport().Top() + 1,
+                                                               cursor.X + 1);
+
+    expectedOutput.push_back("\x1b[c\x1b[6n");
+    doWriteChars(si, L"\x1b[c\x1b[6n");
+
+    std::vector<INPUT_RECORD> records;
+    VERIFY_SUCCESS_NTSTATUS(gci.pInputBuffer->Read(records,
+                                                   gci.pInputBuffer->GetNumberOfReadyEvents(),
+                                                   false, // peek
+                                                   false, // wait for data
+                                                   true, // unicode
+                                                   false)); // stream
+
+    std::wstring replies;
+    for (const auto& record : records)
+    {
+        if (record.EventType == KEY_EVENT && record.Event.KeyEvent.bKeyDown)
+        {
+            replies += record.Event.KeyEvent.uChar.UnicodeChar;
+        }
+    }
+    VERIFY_ARE_EQUAL(expectedReplies, replies);
+}
+
+void ConptyRoundtripTests::PassthroughModeKeepsSplitSequences()
+{
+    Log::Comment(L"A sequence split across two writes must reach the terminal "
+                 L"in one piece, without anything painted in between.");
+
+    auto& g = ServiceLocator::LocateGlobals();
+    auto& renderer = *g.pRender;
+    auto& gci = g.getConsoleInformation();
+    auto& si = gci.GetActiveOutputBuffer();
+    auto& termTb = *term->_buffer;
+
+    _flushFirstFrame();
+
+    const auto originalOutputMode = si.OutputMode;
+    WI_SetFlag(si.OutputMode, ENABLE_VIRTUAL_TERMINAL_PROCESSING);
+    auto restore = wil::scope_exit([&]() {
+        gci.GetVtIo()->SetPassthroughModeForTests(false);
+        si.OutputMode = originalOutputMode;
+    });
+
+    Log::Comment(L"Leave a change pending from before the passthrough");
+    si.GetStateMachine().ProcessString(L"A");
+
+    gci.GetVtIo()->SetPassthroughModeForTests(true);
+
+    expectedOutput.push_back("\x1b[3");
+    doWriteChars(si, L"\x1b[3");
+    expectedOutput.push_back("1mB");
+    doWriteChars(si, L"1mB");
+
+    Log::Comment(L"The pending change is painted afterwards, from the buffer");
+    _checkConptyOutput = false;
+    VERIFY_SUCCEEDED(renderer.PaintFrame());
+
+    TestUtils::VerifyExpectedString(termTb, L"AB", { 0, 0 });
+    auto redAttrs = TextAttribute();
+    redAttrs.SetIndexedForeground(XTERM_RED_ATTR);
+    VERIFY_ARE_EQUAL(redAttrs, termTb.GetCellDataAt({ 1, 0 })->TextAttr());
+}
+
+void ConptyRoundtripTests::PassthroughModeThroughput()
+{
+    Log::Comment(L"Writes the same colored output with and without passthrough "
+                 L"mode and logs how long it took and how many bytes conpty wrote. "
+                 L"The timings aren't checked, but the terminal must end up with "
+                 L"the same text either way.");
+
+    auto& g = ServiceLocator::LocateGlobals();
+    auto& renderer = *g.pRender;
+    auto& gci = g.getConsoleInformation();
+    auto& si = gci.GetActiveOutputBuffer();
+    auto& hostTb = si.GetTextBuffer();
+    auto& termTb = *term->_buffer;
+
+    _flushFirstFrame();
+    _checkConptyOutput = false;
+
+    const auto originalOutputMode = si.OutputMode;
+    WI_SetFlag(si.OutputMode, ENABLE_VIRTUAL_TERMINAL_PROCESSING);
+    auto restore = wil::scope_exit([&]() {
+        gci.GetVtIo()->SetPassthroughModeForTests(false);
+        si.OutputMode = originalOutputMode;
+    });
+
+    // Each line is shorter than the buffer is wide, so nothing wraps.
+    const std::wstring padding(40, L'x');
+    std::wstring chunk;
+    for (auto i = 0; i < 100; ++i)
+    {
+        chunk += L"\x1b[3" + std::to_wstring(i % 8) + L"mline " + std::to_wstring(i) + L"\x1b[m " + padding + L"\r\n";
+    }
+    const auto lastLine = L"line 99 " + padding;
+
+    constexpr auto iterations = 20;
+    for (const auto passthrough : { false, true })
+    {
+        gci.GetVtIo()->SetPassthroughModeForTests(passthrough);
+        _writtenBytes = 0;
+
+        const auto start = std::chrono::steady_clock::now();
+        for (auto i = 0; i < iterations; ++i)
+        {
+            doWriteChars(si, chunk);
+            // Paint as often as the render thread might.
+            VERIFY_SUCCEEDED(renderer.PaintFrame());
+        }
+        const auto elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+        Log::Comment(NoThrowString().Format(L"%s: %.2f ms, %zu bytes written to the terminal",
+                                            passthrough ? L"passthrough" : L"rendered",
+                                            elapsed,
+                                            _writtenBytes));
+
+        if (passthrough)
+        {
+            VERIFY_ARE_EQUAL(chunk.size() * iterations, _writtenBytes);
+        }
+
+        TestUtils::VerifyExpectedString(hostTb, lastLine, { 0, TerminalViewHeight - 2 });
+        const auto termLastLine = gsl::narrow<SHORT>(term->_mutableViewport.Top() + TerminalViewHeight - 2);
+        TestUtils::VerifyExpectedString(termTb, lastLine, { 0, termLastLine });
+    }
+}
@@ -0,0 +1,271 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#include "precomp.h"
+
+#include "ConsoleLockProfiler.hpp"
+
+#pragma hdrstop
+
+using namespace Microsoft::Console;
+
+// Routine Description:
+// - Creates a profiler with empty statistics.
+// Arguments:
+// - reportPath: where WriteReport puts the report. May be empty if the report
+//      is only read with ToJson.
+ConsoleLockProfiler::ConsoleLockProfiler(std::wstring reportPath) :
+    _reportPath{ std::move(reportPath) }
+{
+}
+
+// Routine Description:
+// - Creates a profiler if the environment asks for one.
+// Arguments:
+// - <none>
+// Return Value:
+// - A profiler that reports to the file named by OPENCONSOLE_LOCK_PROFILE, or
+//      nullptr if it isn't set. Failures are logged and leave profiling off.
+[[nodiscard]] std::unique_ptr<ConsoleLockProfiler> ConsoleLockProfiler::s_CreateFromEnvironment() noexcept
+try
+{
+    const auto cch = GetEnvironmentVariableW(EnvironmentVariable.data(), nullptr, 0);
+    if (cch <= 1)
+    {
+        return nullptr;
+    }
+
+    std::wstring reportPath(cch, L'\0');
+    const auto cchWritten = GetEnvironmentVariableW(EnvironmentVariable.data(), reportPath.data(), cch);
+    THROW_LAST_ERROR_IF(cchWritten == 0 || cchWritten >= cch);
+    reportPath.resize(cchWritten);
+
+    return std::make_unique<ConsoleLockProfiler>(std::move(reportPath));
+}
+catch (...)
+{
+    LOG_CAUGHT_EXCEPTION();
+    return nullptr;
+}
+
+// Routine Description:
+// - Records the wait for an outermost acquisition of the console lock and
+//      starts measuring how long it's held.
+// Arguments:
+// - callSite: the return address of whoever took the lock.
+// - waitStart: when the thread started waiting for the lock.
+void ConsoleLockProfiler::LockAcquired(const void* const callSite, const clock::time_point waitStart) noexcept
+{
+    _holdStart = clock::now();
+    _holdSite = callSite;
+
+    const auto waited = std::chrono::duration_cast<std::chrono::nanoseconds>(_holdStart - waitStart);
+
+    try
+    {
+        const auto threadId = GetCurrentThreadId();
+        std::lock_guard<std::mutex> lock{ _mutex };
+        if (_threadNames.find(threadId) == _threadNames.end())
+        {
+            _threadNames.emplace(threadId, s_GetThreadName());
+        }
+        til::counters::record(_entries[{ callSite, threadId }].wait, gsl::narrow_cast<uint64_t>(waited.count()));
+    }
+    CATCH_LOG();
+}
+
+// Routine Description:
+// - Records how long the console lock was held, right before its outermost
+//      release. The hold is attributed to the call site that acquired it.
+// Arguments:
+// - <none>
+void ConsoleLockProfiler::LockReleasing() noexcept
+{
+    // The profiler may have been installed while the lock was held.
+    if (!_holdSite)
+    {
+        return;
+    }
+
+    const auto held = std::chrono::duration_cast<std::chrono::nanoseconds>(clock::now() - _holdStart);
+    const auto callSite = std::exchange(_holdSite, nullptr);
+
+    try
+    {
+        std::lock_guard<std::mutex> lock{ _mutex };
+        til::counters::record(_entries[{ callSite, GetCurrentThreadId() }].hold, gsl::narrow_cast<uint64_t>(held.count()));
+    }
+    CATCH_LOG();
+}
+
+// Routine Description:
+// - Discards everything recorded so far.
+// Arguments:
+// - <none>
+void ConsoleLockProfiler::Reset()
+{
+    std::lock_guard<std::mutex> lock{ _mutex };
+    _entries.clear();
+}
+
+// Routine Description:
+// - Formats the statistics as JSON. Times are in nanoseconds, in the
+//      histogram format of til::counters. For example:
+//   {"threads":[{"id":1234,"name":"Render Thread","wait":{...},"hold":{...}}],
+//    "sites":[{"site":"OpenConsole.exe+0x1a2b","thread":1234,"wait":{...},"hold":{...}}]}
+//   Threads sum up all of their call sites. Both lists are sorted by the
+//      total time the lock was held, longest first.
+// Arguments:
+// - <none>
+// Return Value:
+// - The JSON report.
+std::string ConsoleLockProfiler::ToJson() const
+{
+    std::lock_guard<std::mutex> lock{ _mutex };
+
+    const auto addTo = [](til::counters::histogram_data& total, const til::counters::histogram_data& h) {
+        total.sum += h.sum;
+        for (size_t i = 0; i < h.buckets.size(); ++i)
+        {
+            total.buckets[i] += h.buckets[i];
+        }
+    };
+    const auto byHoldTime = [](const auto& a, const auto& b) {
+        return a.second.hold.sum > b.second.hold.sum;
+    };
+
+    std::map<DWORD, Entry> threadTotals;
+    for (const auto& [key, entry] : _entries)
+    {
+        auto& total = threadTotals[key.second];
+        addTo(total.wait, entry.wait);
+        addTo(total.hold, entry.hold);
+    }
+
+    std::vector<std::pair<DWORD, Entry>> threads{ threadTotals.begin(), threadTotals.end() };
+    std::stable_sort(threads.begin(), threads.end(), byHoldTime);
+
+    std::vector<std::pair<Key, Entry>> sites{ _entries.begin(), _entries.end() };
+    std::stable_sort(sites.begin(), sites.end(), byHoldTime);
+
+    std::string json{ "{\"threads\":[" };
+    for (const auto& [threadId, entry] : threads)
+    {
+        json.append(json.back() == '[' ? "{" : ",{");
+        json.append("\"id\":").append(std::to_string(threadId));
+
+        // Thread names are set by us, but escape them anyway to be safe.
+        json.append(",\"name\":\"");
+        const auto name = _threadNames.find(threadId);
+        for (const auto ch : name == _threadNames.end() ? std::string_view{} : std::string_view{ name->second })
+        {
+            if (ch == '"' || ch == '\\')
+            {
+                json.push_back('\\');
+                json.push_back(ch);
+            }
+            else if (static_cast<unsigned char>(ch) >= 0x20)
+            {
+                json.push_back(ch);
+            }
+        }
+
+        json.append("\",\"wait\":");
+        til::counters::append_json(json, entry.wait);
+        json.append(",\"hold\":");
+        til::counters::append_json(json, entry.hold);
+        json.push_back('}');
+    }
+
+    json.append("],\"sites\":[");
+    for (const auto& [key, entry] : sites)
+    {
+        json.append(json.back() == '[' ? "{" : ",{");
+        json.append("\"site\":\"").append(s_FormatCallSite(key.first)).append("\"");
+        json.append(",\"thread\":").append(std::to_string(key.second));
+        json.append(",\"wait\":");
+        til::counters::append_json(json, entry.wait);
+        json.append(",\"hold\":");
+        til::counters::append_json(json, entry.hold);
+        json.push_back('}');
+    }
+
+    json.append("]}");
+    return json;
+}
+
+// Routine Description:
+// - Writes the JSON report to the file this profiler was created for,
+//      replacing whatever was there.
+// Arguments:
+// - <none>
+// Return Value:
+// - S_OK, S_FALSE if there's no file to write to, or a file error.
+[[nodiscard]] HRESULT ConsoleLockProfiler::WriteReport() const noexcept
+try
+{
+    RETURN_HR_IF(S_FALSE, _reportPath.empty());
+
+    const auto json = ToJson();
+
+    wil::unique_hfile file{ CreateFileW(_reportPath.c_str(), GENERIC_WRITE, 0, nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr) };
+    RETURN_LAST_ERROR_IF(!file);
+    RETURN_IF_WIN32_BOOL_FALSE(WriteFile(file.get(), json.data(), gsl::narrow<DWORD>(json.size()), nullptr, nullptr));
+    return S_OK;
+}
+CATCH_RETURN();
+
+// Routine Description:
+// - Turns a return address into something that can be looked up in the
+//      symbols of the module it belongs to.
+// Arguments:
+// - callSite: the return address.
+// Return Value:
+// - The module's file name and the offset into it, like "OpenConsole.exe+0x1a2b",
+//      or just the address if it isn't part of a module.
+std::string ConsoleLockProfiler::s_FormatCallSite(const void* const callSite)
+{
+    HMODULE module{ nullptr };
+    if (GetModuleHandleExW(GET_MODULE_HANDLE_EX_FLAG_FROM_ADDRESS | GET_MODULE_HANDLE_EX_FLAG_UNCHANGED_REFCOUNT,
+                           static_cast<LPCWSTR>(callSite),
+                           &module))
+    {
+        wchar_t path[MAX_PATH];
+        const auto cch = GetModuleFileNameW(module, path, ARRAYSIZE(path));
+        if (cch != 0 && cch < ARRAYSIZE(path))
+        {
+            const std::wstring_view pathView{ path, cch };
+            const auto fileName = pathView.substr(pathView.find_last_of(L'\\') + 1);
+            const auto offset = reinterpret_cast<uintptr_t>(callSite) - reinterpret_cast<uintptr_t>(module);
+            return fmt::format("{}+{:#x}", til::u16u8(fileName), offset);
+        }
+    }
+
+    return fmt::format("{:#x}", reinterpret_cast<uintptr_t>(callSite));
+}
+
+// Routine Description:
+// - Gets the description of the calling thread, which our threads set to
+//      say what they are.
+// Arguments:
+// - <none>
+// Return Value:
+// - The thread's description, or an empty string if it has none or it can't
+//      be retrieved on this version of Windows.
+std::string ConsoleLockProfiler::s_GetThreadName()
+{
+    // GetThreadDescription only works on 1607 and higher, like its setter.
+    static const auto func = GetProcAddressByFunctionDeclaration(GetModuleHandleW(L"kernel32.dll"), GetThreadDescription);
+    if (!func)
+    {
+        return {};
+    }
+
+    wil::unique_hlocal_string description;
+    if (FAILED(func(GetCurrentThread(), description.put())) || !description)
+    {
+        return {};
+    }
+
+    return til::u16u8(std::wstring_view{ description.get() });
+}
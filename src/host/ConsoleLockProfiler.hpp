@@ -0,0 +1,69 @@
+/*++
+Copyright (c) Microsoft Corporation
+Licensed under the MIT license.
+
+Module Name:
+- ConsoleLockProfiler.hpp
+
+Abstract:
+- Measures how long threads wait for the global console lock and how long they
+  hold it, per thread and per call site, to find out who's making everyone
+  else wait.
+- Only outermost acquisitions are measured. Recursive ones neither wait nor
+  end the hold.
+- Profiling is off unless OPENCONSOLE_LOCK_PROFILE names a file, in which case
+  a JSON report is written to it when the console exits. Tests can install a
+  profiler of their own and read the report with ToJson.
+--*/
+
+#pragma once
+
+#include "til/counters.h"
+
+namespace Microsoft::Console
+{
+    class ConsoleLockProfiler final
+    {
+    public:
+        using clock = std::chrono::steady_clock;
+
+        static constexpr std::wstring_view EnvironmentVariable{ L"OPENCONSOLE_LOCK_PROFILE" };
+
+        explicit ConsoleLockProfiler(std::wstring reportPath = {});
+
+        [[nodiscard]] static std::unique_ptr<ConsoleLockProfiler> s_CreateFromEnvironment() noexcept;
+
+        // Only to be called by the thread that owns the console lock.
+        void LockAcquired(const void* const callSite, const clock::time_point waitStart) noexcept;
+        void LockReleasing() noexcept;
+
+        void Reset();
+        std::string ToJson() const;
+        [[nodiscard]] HRESULT WriteReport() const noexcept;
+
+    private:
+        struct Entry
+        {
+            til::counters::histogram_data wait;
+            til::counters::histogram_data hold;
+        };
+
+        using Key = std::pair<const void*, DWORD>; // call site, thread ID
+
+        static std::string s_FormatCallSite(const void* const callSite);
+        static std::string s_GetThreadName();
+
+        std::wstring _reportPath;
+
+        // Guards the statistics, which are read on exit by whichever thread
+        // happens to exit, without holding the console lock.
+        mutable std::mutex _mutex;
+        std::map<Key, Entry> _entries;
+        std::map<DWORD, std::string> _threadNames;
+
+        // Only touched by the owner of the console lock, so the lock itself
+        // guards these.
+        const void* _holdSite{ nullptr };
+        clock::time_point _holdStart;
+    };
+}
@@ -70,6 +70,7 @@ VtIo::VtIo() :
     _lookingForCursorPosition = pArgs->GetInheritCursor();
     _resizeQuirk = pArgs->IsResizeQuirkEnabled();
     _win32InputMode = pArgs->IsWin32InputModeEnabled();
+    _passthroughMode = pArgs->IsPassthroughModeEnabled();
 
     // If we were already given VT handles, set up the VT IO engine to use those.
     if (pArgs->InConptyMode())
@@ -438,6 +439,18 @@ void VtIo::EnableConptyModeForTests(std::unique_ptr<Microsoft::Console::Render::
     _objectsCreated = true;
     _pVtRenderEngine = std::move(vtRenderEngine);
 }
+
+// Method Description:
+// - This is a test helper method. It turns passthrough mode on or off, as if
+//   we were started with (or without) the `--passthrough` flag.
+// Arguments:
+// - passthroughMode: true to enable passthrough mode
+// Return Value:
+// - <none>
+void VtIo::SetPassthroughModeForTests(const bool passthroughMode) noexcept
+{
+    _passthroughMode = passthroughMode;
+}
 #endif
 
 // Method Description:
@@ -474,3 +487,53 @@ bool VtIo::IsResizeQuirkEnabled() const
     }
     return S_OK;
 }
+
+// Method Description:
+// - Returns true if we were started with the `--passthrough` flag. In this mode
+//   the output of clients that write VT is written to the terminal as is,
+//   instead of being painted again from the buffer after we parsed it. The
+//   buffer is still updated for clients that read it back through the API.
+// Arguments:
+// - <none>
+// Return Value:
+// - true iff passthrough mode is enabled and we have a terminal to write to.
+bool VtIo::IsPassthroughMode() const noexcept
+{
+    return _passthroughMode && _pVtRenderEngine;
+}
+
+// Method Description:
+// - Writes a client's VT output to the terminal as is. Call EndPassthrough
+//   once the output was processed.
+// - We don't paint what's still pending first: the client's output may
+//   continue a sequence that its last write started, and anything we wrote in
+//   between would end up in the middle of it. Pending changes are painted
+//   later from the buffer instead, see VtEngine::BeginPassthrough.
+// - The console lock must be held when calling this.
+// Arguments:
+// - str - the client's output
+// Return Value:
+// - S_OK if we wrote the output, otherwise an appropriate HRESULT
+[[nodiscard]] HRESULT VtIo::BeginPassthrough(const std::wstring_view str) noexcept
+{
+    return _pVtRenderEngine->BeginPassthrough(str);
+}
+
+// Method Description:
+// - Ends a passthrough started by BeginPassthrough. The renderer drops what
+//   was invalidated while processing the output and picks up the cursor and
+//   attributes of the active buffer, which the terminal now shares.
+// Arguments:
+// - <none>
+// Return Value:
+// - <none>
+void VtIo::EndPassthrough() noexcept
+{
+    const auto& screenInfo = ServiceLocator::LocateGlobals().getConsoleInformation().GetActiveOutputBuffer();
+    const auto& cursor = screenInfo.GetTextBuffer().GetCursor();
+
+    auto position = cursor.GetPosition();
+    screenInfo.GetViewport().ConvertToOrigin(&position);
+
+    _pVtRenderEngine->EndPassthrough(position, cursor.IsDelayedEOLWrap(), screenInfo.GetAttributes());
+}
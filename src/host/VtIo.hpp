@@ -41,10 +41,15 @@ namespace Microsoft::Console::VirtualTerminal
 
 #ifdef UNIT_TESTING
         void EnableConptyModeForTests(std::unique_ptr<Microsoft::Console::Render::VtEngine> vtRenderEngine);
+        void SetPassthroughModeForTests(const bool passthroughMode) noexcept;
 #endif
 
         bool IsResizeQuirkEnabled() const;
 
+        bool IsPassthroughMode() const noexcept;
+        [[nodiscard]] HRESULT BeginPassthrough(const std::wstring_view str) noexcept;
+        void EndPassthrough() noexcept;
+
         [[nodiscard]] HRESULT ManuallyClearScrollback() const noexcept;
 
     private:
@@ -63,6 +68,7 @@ namespace Microsoft::Console::VirtualTerminal
 
         bool _resizeQuirk{ false };
         bool _win32InputMode{ false };
+        bool _passthroughMode{ false };
 
         std::unique_ptr<Microsoft::Console::Render::VtEngine> _pVtRenderEngine;
         std::unique_ptr<Microsoft::Console::VtInputThread> _pVtInputThread;
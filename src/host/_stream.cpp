@@ -304,6 +304,26 @@ constexpr unsigned int LOCAL_BUFFER_SIZE = 100;
     return Status;
 }
 
+// Routine Description:
+// - Counts the printable ASCII characters at the start of a string. Those are
+//   the ones WriteCharsLegacy can write to the buffer without processing them.
+// Arguments:
+// - pwch - the string to count in.
+// - cch - the length of the string.
+// - cchMax - the most characters to count.
+// Return Value:
+// - the number of printable ASCII characters the string starts with, up to cchMax.
+static size_t CountPrintableAscii(_In_reads_(cch) const wchar_t* const pwch, const size_t cch, const size_t cchMax) noexcept
+{
+    const auto cchLimit = std::min(cch, cchMax);
+    size_t i = 0;
+    while (i < cchLimit && pwch[i] >= L' ' && pwch[i] < 0x007F)
+    {
+        i++;
+    }
+    return i;
+}
+
 // Routine Description:
 // - This routine writes a string to the screen, processing any embedded
 //   unicode characters.  The string is also copied to the input buffer, if
@@ -388,7 +408,25 @@ constexpr unsigned int LOCAL_BUFFER_SIZE = 100;
         XPosition = cursor.GetPosition().X;
         size_t i = 0;
         wchar_t* LocalBufPtr = LocalBuffer;
-        while (*pcb < BufferSize && i < LOCAL_BUFFER_SIZE && XPosition < coordScreenBufferSize.X)
+
+        // Most output is runs of printable ASCII. Each of those characters
+        // takes up one cell and needs none of the processing below, so we
+        // write as many of them as fit on the line straight from the string.
+        const size_t cchAsciiRun = CountPrintableAscii(lpString,
+                                                       (BufferSize - *pcb) / sizeof(WCHAR),
+                                                       gsl::narrow_cast<size_t>(std::max(coordScreenBufferSize.X - XPosition, 0)));
+        const bool fAsciiRun = cchAsciiRun != 0;
+        if (fAsciiRun)
+        {
+            i = cchAsciiRun;
+            XPosition = gsl::narrow_cast<SHORT>(XPosition + cchAsciiRun);
+            lpString += cchAsciiRun;
+            pwchRealUnicode += cchAsciiRun;
+            pwchBuffer += cchAsciiRun;
+            *pcb += cchAsciiRun * sizeof(WCHAR);
+        }
+
+        while (!fAsciiRun && *pcb < BufferSize && i < LOCAL_BUFFER_SIZE && XPosition < coordScreenBufferSize.X)
         {
 #pragma prefast(suppress : 26019, "Buffer is taken in multiples of 2. Validation is ok.")
             const wchar_t Char = *lpString;
@@ -552,9 +590,24 @@ constexpr unsigned int LOCAL_BUFFER_SIZE = 100;
                 i = gsl::narrow_cast<size_t>(coordScreenBufferSize.X) - CursorPosition.X;
             }
 
-            // line was wrapped if we're writing up to the end of the current row
-            OutputCellIterator it(std::wstring_view(LocalBuffer, i), Attributes);
-            const auto itEnd = screenInfo.Write(it);
+            if (fAsciiRun)
+            {
+                textBuffer.WriteAsciiRun({ lpString - i, i }, CursorPosition, Attributes);
+
+                // The number of "spaces" or "cells" we have consumed needs to be reported and stored for later
+                // when/if we need to erase the command line.
+                TempNumSpaces += i;
+            }
+            else
+            {
+                // line was wrapped if we're writing up to the end of the current row
+                OutputCellIterator it(std::wstring_view(LocalBuffer, i), Attributes);
+                const auto itEnd = screenInfo.Write(it);
+
+                // The number of "spaces" or "cells" we have consumed needs to be reported and stored for later
+                // when/if we need to erase the command line.
+                TempNumSpaces += itEnd.GetCellDistance(it);
+            }
 
             // Notify accessibility
             if (screenInfo.HasAccessibilityEventing())
@@ -562,9 +615,6 @@ constexpr unsigned int LOCAL_BUFFER_SIZE = 100;
                 screenInfo.NotifyAccessibilityEventing(CursorPosition.X, CursorPosition.Y, CursorPosition.X + gsl::narrow<SHORT>(i - 1), CursorPosition.Y);
             }
 
-            // The number of "spaces" or "cells" we have consumed needs to be reported and stored for later
-            // when/if we need to erase the command line.
-            TempNumSpaces += itEnd.GetCellDistance(it);
             // WCL-NOTE: We are using the "estimated" X position delta instead of the actual delta from
             // WCL-NOTE: the iterator. It is not clear why. If they differ, the cursor ends up in the
             // WCL-NOTE: wrong place (typically inside another character).
@@ -972,7 +1022,31 @@ constexpr unsigned int LOCAL_BUFFER_SIZE = 100;
                 StateMachine& machine = screenInfo.GetStateMachine();
                 size_t const cch = BufferSize / sizeof(WCHAR);
 
+                // In passthrough mode the terminal gets the output as is,
+                // and we only parse it to keep the buffer up to date.
+                auto& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
+                const auto passthrough = gci.IsInVtIoMode() &&
+                                         gci.GetVtIo()->IsPassthroughMode() &&
+                                         screenInfo.IsActiveScreenBuffer() &&
+                                         SUCCEEDED(gci.GetVtIo()->BeginPassthrough({ pwchRealUnicode, cch }));
+                auto endPassthrough = wil::scope_exit([&] {
+                    if (passthrough)
+                    {
+                        gci.GetVtIo()->EndPassthrough();
+                    }
+                });
+
+                // Line feeds at the bottom margin scroll the same region over and
+                // over, so only let the renderer know once we're done with the string.
+                BeginScrollBatch();
+                auto endScrollBatch = wil::scope_exit([] { EndScrollBatch(); });
+
                 machine.ProcessString({ pwchRealUnicode, cch });
+
+                // The batched scrolls are part of what the terminal already got,
+                // so they have to reach the renderer before the passthrough ends.
+                endScrollBatch.reset();
+                endPassthrough.reset();
                 *pcb += BufferSize;
             }
         }
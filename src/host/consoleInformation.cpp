@@ -2,6 +2,7 @@
 // Licensed under the MIT license.
 
 #include "precomp.h"
+#include <intrin.h>
 #include <intsafe.h>
 
 #include "misc.h"
@@ -11,6 +12,7 @@
 #include "../interactivity/inc/ServiceLocator.hpp"
 #include "../types/inc/convert.hpp"
 
+using Microsoft::Console::ConsoleLockProfiler;
 using Microsoft::Console::Interactivity::ServiceLocator;
 using Microsoft::Console::Render::BlinkingState;
 using Microsoft::Console::VirtualTerminal::VtIo;
@@ -33,6 +35,7 @@ CONSOLE_INFORMATION::CONSOLE_INFORMATION() :
     OutputCP(0),
     CtrlFlags(0),
     LimitingProcessId(0),
+    ScrollBatchDepth(0),
     // ColorTable initialized below
     // CPInfo initialized below
     // OutputCPInfo initialized below
@@ -45,6 +48,7 @@ CONSOLE_INFORMATION::CONSOLE_INFORMATION() :
     ZeroMemory((void*)&CPInfo, sizeof(CPInfo));
     ZeroMemory((void*)&OutputCPInfo, sizeof(OutputCPInfo));
     InitializeCriticalSection(&_csConsoleLock);
+    _lockProfiler = ConsoleLockProfiler::s_CreateFromEnvironment();
 }
 
 CONSOLE_INFORMATION::~CONSOLE_INFORMATION()
@@ -62,18 +66,55 @@ bool CONSOLE_INFORMATION::IsConsoleLocked() const
 #pragma prefast(suppress : 26135, "Adding lock annotation spills into entire project. Future work.")
 void CONSOLE_INFORMATION::LockConsole()
 {
+    LockConsoleFrom(_ReturnAddress());
+}
+
+// Routine Description:
+// - Locks the console like LockConsole, on behalf of the given caller. Wrappers
+//   use this to have the lock profiler attribute the wait to their caller.
+// Arguments:
+// - callSite - The return address to record the acquisition under.
+// Return Value:
+// - <none>
+#pragma prefast(suppress : 26135, "Adding lock annotation spills into entire project. Future work.")
+void CONSOLE_INFORMATION::LockConsoleFrom(const void* const callSite)
+{
+    if (!_lockProfiler)
+    {
+        EnterCriticalSection(&_csConsoleLock);
+        return;
+    }
+
+    const auto waitStart = ConsoleLockProfiler::clock::now();
     EnterCriticalSection(&_csConsoleLock);
+    if (_csConsoleLock.RecursionCount == 1)
+    {
+        _lockProfiler->LockAcquired(callSite, waitStart);
+    }
 }
 
 #pragma prefast(suppress : 26135, "Adding lock annotation spills into entire project. Future work.")
 bool CONSOLE_INFORMATION::TryLockConsole()
 {
-    return !!TryEnterCriticalSection(&_csConsoleLock);
+    if (!TryEnterCriticalSection(&_csConsoleLock))
+    {
+        return false;
+    }
+
+    if (_lockProfiler && _csConsoleLock.RecursionCount == 1)
+    {
+        _lockProfiler->LockAcquired(_ReturnAddress(), ConsoleLockProfiler::clock::now());
+    }
+    return true;
 }
 
 #pragma prefast(suppress : 26135, "Adding lock annotation spills into entire project. Future work.")
 void CONSOLE_INFORMATION::UnlockConsole()
 {
+    if (_lockProfiler && _csConsoleLock.RecursionCount == 1)
+    {
+        _lockProfiler->LockReleasing();
+    }
     LeaveCriticalSection(&_csConsoleLock);
 }
 
@@ -82,6 +123,30 @@ ULONG CONSOLE_INFORMATION::GetCSRecursionCount()
     return _csConsoleLock.RecursionCount;
 }
 
+// Routine Description:
+// - Gets the profiler that measures the console lock, if profiling is on.
+// Arguments:
+// - <none>
+// Return Value:
+// - The profiler, or nullptr.
+ConsoleLockProfiler* CONSOLE_INFORMATION::GetLockProfiler() const noexcept
+{
+    return _lockProfiler.get();
+}
+
+// Routine Description:
+// - Starts, replaces or (with nullptr) stops profiling the console lock.
+// - NOTE: No other thread may be using the lock while this is called. The
+//   profiler is otherwise only set up once, on construction.
+// Arguments:
+// - profiler - The profiler to record the lock's use with from now on.
+// Return Value:
+// - <none>
+void CONSOLE_INFORMATION::SetLockProfiler(std::unique_ptr<ConsoleLockProfiler> profiler) noexcept
+{
+    _lockProfiler = std::move(profiler);
+}
+
 // Routine Description:
 // - This routine allocates and initialized a console and its associated
 //   data - input buffer and screen buffer.
@@ -152,7 +152,7 @@ void EventsToUnicode(_Inout_ std::deque<std::unique_ptr<IInputEvent>>& inEvents,
 // block, this will be returned along with context in *ppWaiter.
 // - Or an out of memory/math/string error message in NTSTATUS format.
 [[nodiscard]] static NTSTATUS _DoGetConsoleInput(InputBuffer& inputBuffer,
-                                                 std::deque<std::unique_ptr<IInputEvent>>& outEvents,
+                                                 std::vector<INPUT_RECORD>& outEvents,
                                                  const size_t eventReadCount,
                                                  INPUT_READ_HANDLE_DATA& readHandleState,
                                                  const bool IsUnicode,
@@ -171,12 +171,12 @@ void EventsToUnicode(_Inout_ std::deque<std::unique_ptr<IInputEvent>>& inEvents,
         LockConsole();
         auto Unlock = wil::scope_exit([&] { UnlockConsole(); });
 
-        std::deque<std::unique_ptr<IInputEvent>> partialEvents;
+        std::vector<INPUT_RECORD> partialEvents;
         if (!IsUnicode)
         {
             if (inputBuffer.IsReadPartialByteSequenceAvailable())
             {
-                partialEvents.push_back(inputBuffer.FetchReadPartialByteSequence(IsPeek));
+                partialEvents.push_back(inputBuffer.FetchReadPartialByteSequence(IsPeek)->ToInputRecord());
             }
         }
 
@@ -185,7 +185,7 @@ void EventsToUnicode(_Inout_ std::deque<std::unique_ptr<IInputEvent>>& inEvents,
         {
             return STATUS_INTEGER_OVERFLOW;
         }
-        std::deque<std::unique_ptr<IInputEvent>> readEvents;
+        std::vector<INPUT_RECORD> readEvents;
         NTSTATUS Status = inputBuffer.Read(readEvents,
                                            amountToRead,
                                            IsPeek,
@@ -216,29 +216,17 @@ void EventsToUnicode(_Inout_ std::deque<std::unique_ptr<IInputEvent>>& inEvents,
             }
 
             // combine partial and readEvents
-            while (!partialEvents.empty())
-            {
-                readEvents.push_front(std::move(partialEvents.back()));
-                partialEvents.pop_back();
-            }
+            readEvents.insert(readEvents.begin(), partialEvents.begin(), partialEvents.end());
 
             // move events over
-            for (size_t i = 0; i < eventReadCount; ++i)
-            {
-                if (readEvents.empty())
-                {
-                    break;
-                }
-                outEvents.push_back(std::move(readEvents.front()));
-                readEvents.pop_front();
-            }
+            const auto amountToMove = std::min(eventReadCount, readEvents.size());
+            outEvents.insert(outEvents.end(), readEvents.begin(), readEvents.begin() + amountToMove);
 
             // store partial event if necessary
-            if (!readEvents.empty())
+            if (amountToMove < readEvents.size())
             {
-                inputBuffer.StoreReadPartialByteSequence(std::move(readEvents.front()));
-                readEvents.pop_front();
-                FAIL_FAST_IF(!(readEvents.empty()));
+                FAIL_FAST_IF(readEvents.size() - amountToMove != 1);
+                inputBuffer.StoreReadPartialByteSequence(IInputEvent::Create(readEvents.back()));
             }
         }
         return Status;
@@ -266,7 +254,7 @@ void EventsToUnicode(_Inout_ std::deque<std::unique_ptr<IInputEvent>>& inEvents,
 // buffer), this contains context that will allow the server to
 // restore this call later.
 [[nodiscard]] HRESULT ApiRoutines::PeekConsoleInputAImpl(IConsoleInputObject& context,
-                                                         std::deque<std::unique_ptr<IInputEvent>>& outEvents,
+                                                         std::vector<INPUT_RECORD>& outEvents,
                                                          const size_t eventsToRead,
                                                          INPUT_READ_HANDLE_DATA& readHandleState,
                                                          std::unique_ptr<IWaitRoutine>& waiter) noexcept
@@ -306,7 +294,7 @@ void EventsToUnicode(_Inout_ std::deque<std::unique_ptr<IInputEvent>>& inEvents,
 // buffer), this contains context that will allow the server to
 // restore this call later.
 [[nodiscard]] HRESULT ApiRoutines::PeekConsoleInputWImpl(IConsoleInputObject& context,
-                                                         std::deque<std::unique_ptr<IInputEvent>>& outEvents,
+                                                         std::vector<INPUT_RECORD>& outEvents,
                                                          const size_t eventsToRead,
                                                          INPUT_READ_HANDLE_DATA& readHandleState,
                                                          std::unique_ptr<IWaitRoutine>& waiter) noexcept
@@ -346,7 +334,7 @@ void EventsToUnicode(_Inout_ std::deque<std::unique_ptr<IInputEvent>>& inEvents,
 // buffer), this contains context that will allow the server to
 // restore this call later.
 [[nodiscard]] HRESULT ApiRoutines::ReadConsoleInputAImpl(IConsoleInputObject& context,
-                                                         std::deque<std::unique_ptr<IInputEvent>>& outEvents,
+                                                         std::vector<INPUT_RECORD>& outEvents,
                                                          const size_t eventsToRead,
                                                          INPUT_READ_HANDLE_DATA& readHandleState,
                                                          std::unique_ptr<IWaitRoutine>& waiter) noexcept
@@ -386,7 +374,7 @@ void EventsToUnicode(_Inout_ std::deque<std::unique_ptr<IInputEvent>>& inEvents,
 // buffer), this contains context that will allow the server to
 // restore this call later.
 [[nodiscard]] HRESULT ApiRoutines::ReadConsoleInputWImpl(IConsoleInputObject& context,
-                                                         std::deque<std::unique_ptr<IInputEvent>>& outEvents,
+                                                         std::vector<INPUT_RECORD>& outEvents,
                                                          const size_t eventsToRead,
                                                          INPUT_READ_HANDLE_DATA& readHandleState,
                                                          std::unique_ptr<IWaitRoutine>& waiter) noexcept
@@ -527,9 +515,25 @@ void EventsToUnicode(_Inout_ std::deque<std::unique_ptr<IInputEvent>>& inEvents,
 
     try
     {
-        auto events = IInputEvent::Create(buffer);
+        // The records are stored as they are, so reject the ones that
+        // IInputEvent::Create wouldn't accept either.
+        for (const auto& record : buffer)
+        {
+            switch (record.EventType)
+            {
+            case KEY_EVENT:
+            case MOUSE_EVENT:
+            case WINDOW_BUFFER_SIZE_EVENT:
+            case MENU_EVENT:
+            case FOCUS_EVENT:
+                break;
+            default:
+                return E_INVALIDARG;
+            }
+        }
 
-        return _WriteConsoleInputWImplHelper(context, events, written, append);
+        written = append ? context.Write(buffer) : context.Prepend(buffer);
+        return S_OK;
     }
     CATCH_RETURN();
 }
@@ -0,0 +1,109 @@
+/*++
+Copyright (c) Microsoft Corporation
+Licensed under the MIT license.
+
+Module Name:
+- nullconsole.h
+
+Abstract:
+- Starts a console session that isn't connected to a driver, so that a test
+  harness can drive conhost from inside its own process. Used by the fuzzing
+  harness and by the conhost replay benchmark.
+--*/
+
+#pragma once
+
+#include "../ConsoleArguments.hpp"
+#include "../srvinit.h"
+#include "../../server/Entrypoints.h"
+#include "../../interactivity/inc/ServiceLocator.hpp"
+#include "../../server/DeviceHandle.h"
+#include "../../server/IoThread.h"
+
+struct NullDeviceComm : public IDeviceComm
+{
+    HRESULT SetServerInformation(CD_IO_SERVER_INFORMATION* const) const override
+    {
+        return S_FALSE;
+    }
+    HRESULT ReadIo(PCONSOLE_API_MSG const, CONSOLE_API_MSG* const) const override
+    {
+        // The easiest way to get the IO thread to stop reading from us us to simply
+        // suspend it. A harness doesn't need a device IO thread.
+        SuspendThread(GetCurrentThread());
+        return S_FALSE;
+    }
+    HRESULT CompleteIo(CD_IO_COMPLETE* const) const override
+    {
+        return S_FALSE;
+    }
+    HRESULT ReadInput(CD_IO_OPERATION* const) const override
+    {
+        SuspendThread(GetCurrentThread());
+        return S_FALSE;
+    }
+    HRESULT WriteOutput(CD_IO_OPERATION* const) const override
+    {
+        return S_FALSE;
+    }
+    HRESULT AllowUIAccess() const override
+    {
+        return S_FALSE;
+    }
+    ULONG_PTR PutHandle(const void*) override
+    {
+        return 0;
+    }
+    void* GetHandle(ULONG_PTR) const override
+    {
+        return nullptr;
+    }
+    HRESULT GetServerHandle(HANDLE*) const override
+    {
+        return S_FALSE;
+    }
+};
+
+[[nodiscard]] inline HRESULT StartNullConsole(const ConsoleArguments* const args,
+                                             const std::wstring_view title,
+                                             const til::size bufferSize,
+                                             const til::size windowSize)
+{
+    auto& globals = Microsoft::Console::Interactivity::ServiceLocator::LocateGlobals();
+    globals.pDeviceComm = new NullDeviceComm{}; // quickly, before we "connect". Leak this.
+
+    // it is safe to pass INVALID_HANDLE_VALUE here because the null handle would have been detected
+    // in ConDrvDeviceComm (which has been avoided by setting a global device comm beforehand)
+    RETURN_IF_NTSTATUS_FAILED(ConsoleCreateIoThreadLegacy(INVALID_HANDLE_VALUE, args));
+
+    auto& gci = Microsoft::Console::Interactivity::ServiceLocator::LocateGlobals().getConsoleInformation();
+
+    // Process handle list manipulation must be done under lock
+    gci.LockConsole();
+    ConsoleProcessHandle* pProcessHandle{ nullptr };
+    RETURN_IF_FAILED(gci.ProcessHandleList.AllocProcessData(GetCurrentProcessId(),
+                                                            GetCurrentThreadId(),
+                                                            0,
+                                                            nullptr,
+                                                            &pProcessHandle));
+    pProcessHandle->fRootProcess = true;
+
+    CONSOLE_API_CONNECTINFO fakeConnectInfo{};
+    fakeConnectInfo.ConsoleInfo.SetShowWindow(SW_NORMAL);
+    fakeConnectInfo.ConsoleInfo.SetScreenBufferSize(bufferSize);
+    fakeConnectInfo.ConsoleInfo.SetWindowSize(windowSize);
+    fakeConnectInfo.ConsoleInfo.SetStartupFlags(STARTF_USECOUNTCHARS);
+    wcsncpy_s(fakeConnectInfo.Title, title.data(), title.size());
+    fakeConnectInfo.TitleLength = gsl::narrow_cast<DWORD>(title.size() * sizeof(wchar_t)); // bytes, not wchars
+    wcsncpy_s(fakeConnectInfo.AppName, title.data(), title.size());
+    fakeConnectInfo.AppNameLength = gsl::narrow_cast<DWORD>(title.size() * sizeof(wchar_t)); // bytes, not wchars
+    fakeConnectInfo.ConsoleApp = TRUE;
+    fakeConnectInfo.WindowVisible = TRUE;
+    RETURN_IF_NTSTATUS_FAILED(ConsoleAllocateConsole(&fakeConnectInfo));
+
+    CommandHistory::s_Allocate(title, (HANDLE)pProcessHandle);
+
+    gci.UnlockConsole();
+
+    return S_OK;
+}
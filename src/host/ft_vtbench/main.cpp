@@ -0,0 +1,112 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+//
+// vtbench-conhost
+// Feeds captured VT streams through the console API into conhost, which runs
+// in this process without a driver: WriteConsole -> StateMachine ->
+// AdaptDispatch -> TextBuffer. Takes the same arguments as vtbench and prints
+// the same report, so the two pipelines can be compared corpus by corpus.
+//
+// Frames are painted by conhost's own render thread, so only the writes are
+// timed here, and -r has no effect.
+//
+// Usage: vtbench-conhost [-w width] [-h height] [-c chunkBytes] [-n iterations] [-t] [-j] file...
+//   -t      Transcode every chunk to UTF-16 and write it with WriteConsoleW,
+//           instead of writing UTF-8 with WriteConsoleA.
+
+#include "precomp.h"
+
+#include "../ft_fuzzer/nullconsole.h"
+#include "../../tools/vtbench/replay.hpp"
+#include <til/u8u16convert.h>
+
+using namespace Microsoft::Console::Interactivity;
+using namespace Microsoft::Console::VtBench;
+
+namespace
+{
+    // Writes a string to the active screen buffer, the way a client's
+    // WriteConsole call would.
+    void Write(const std::string_view text, const bool transcode, til::u8state& state, std::wstring& buffer)
+    {
+        auto& globals = ServiceLocator::LocateGlobals();
+        auto& screenInfo = globals.getConsoleInformation().GetActiveOutputBuffer();
+
+        size_t read = 0;
+        std::unique_ptr<IWaitRoutine> waiter;
+        if (transcode)
+        {
+            THROW_IF_FAILED(til::u8u16(text, buffer, state));
+            THROW_IF_FAILED(globals.api.WriteConsoleWImpl(screenInfo, buffer, read, false, waiter));
+        }
+        else
+        {
+            THROW_IF_FAILED(globals.api.WriteConsoleAImpl(screenInfo, text, read, false, waiter));
+        }
+    }
+
+    // Replays a single stream once. A hard reset beforehand clears the
+    // buffer and the VT state left behind by the previous run.
+    void RunOnce(const Options& options, const std::string_view data, Result& result)
+    {
+        til::u8state state;
+        std::wstring text;
+
+        Write("\x1b" "c", false, state, text);
+
+        const Stopwatch stopwatch;
+
+        for (size_t offset = 0; offset < data.size(); offset += options.chunkSize)
+        {
+            const auto chunk = data.substr(offset, options.chunkSize);
+            Time(result.writeTimes, [&]() {
+                Write(chunk, options.transcode, state, text);
+            });
+        }
+
+        stopwatch.Stop(result);
+        result.bytes += data.size();
+    }
+
+    [[nodiscard]] HRESULT StartConsole(const Options& options)
+    {
+        auto& globals = ServiceLocator::LocateGlobals();
+        globals.hInstance = wil::GetModuleInstanceHandle();
+
+        ConsoleArguments args({}, nullptr, nullptr);
+        RETURN_IF_FAILED(args.ParseCommandline());
+
+        constexpr static std::wstring_view title{ L"vtbench-conhost" };
+        RETURN_IF_FAILED(StartNullConsole(&args,
+                                          title,
+                                          til::size{ options.width, ScrollbackLines },
+                                          til::size{ options.width, options.height }));
+
+        auto& screenInfo = globals.getConsoleInformation().GetActiveOutputBuffer();
+        RETURN_IF_FAILED(globals.api.SetConsoleOutputCodePageImpl(CP_UTF8));
+        RETURN_IF_FAILED(globals.api.SetConsoleOutputModeImpl(screenInfo,
+                                                              ENABLE_PROCESSED_OUTPUT |
+                                                                  ENABLE_WRAP_AT_EOL_OUTPUT |
+                                                                  ENABLE_VIRTUAL_TERMINAL_PROCESSING));
+        return S_OK;
+    }
+}
+
+int __cdecl wmain(int argc, wchar_t* argv[])
+try
+{
+    // The console is sized by the same arguments that Run() parses later.
+    Options options;
+    if (ParseArgs(argc, argv, options))
+    {
+        THROW_IF_FAILED(StartConsole(options));
+    }
+
+    return Run(L"conhost", argc, argv, RunOnce);
+}
+catch (...)
+{
+    LOG_CAUGHT_EXCEPTION();
+    fwprintf(stderr, L"vtbench-conhost failed: 0x%08x\n", static_cast<unsigned int>(wil::ResultFromCaughtException()));
+    return 1;
+}
@@ -3,6 +3,8 @@
 
 #include "precomp.h"
 
+#include <intrin.h>
+
 #include "handle.h"
 #include "../interactivity/inc/ServiceLocator.hpp"
 
@@ -13,7 +15,7 @@ using Microsoft::Console::Interactivity::ServiceLocator;
 void LockConsole()
 {
     CONSOLE_INFORMATION& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
-    gci.LockConsole();
+    gci.LockConsoleFrom(_ReturnAddress());
 }
 
 void UnlockConsole()
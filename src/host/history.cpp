@@ -77,6 +77,16 @@ static bool CaseInsensitiveEquality(wchar_t a, wchar_t b)
     return ::towlower(a) == ::towlower(b);
 }
 
+static bool CaseInsensitiveLessThan(wchar_t a, wchar_t b)
+{
+    return ::towlower(a) < ::towlower(b);
+}
+
+bool CommandHistory::CaseInsensitiveLess::operator()(const std::wstring_view lhs, const std::wstring_view rhs) const
+{
+    return std::lexicographical_compare(lhs.cbegin(), lhs.cend(), rhs.cbegin(), rhs.cend(), CaseInsensitiveLessThan);
+}
+
 bool CommandHistory::IsAppNameMatch(const std::wstring_view other) const
 {
     return std::equal(_appName.cbegin(), _appName.cend(), other.cbegin(), other.cend(), CaseInsensitiveEquality);
@@ -124,7 +134,7 @@ void CommandHistory::_Reset()
             // find free record.  if all records are used, free the lru one.
             if ((SHORT)_commands.size() == _maxCommands)
             {
-                _commands.erase(_commands.cbegin());
+                _EraseAt(0);
                 // move LastDisplayed back one in order to stay synced with the
                 // command it referred to before erasing the lru one
                 --LastDisplayed;
@@ -133,11 +143,11 @@ void CommandHistory::_Reset()
             // add newCommand to array
             if (!reuse.empty())
             {
-                _commands.emplace_back(reuse);
+                _PushBack(std::move(reuse));
             }
             else
             {
-                _commands.emplace_back(newCommand);
+                _PushBack(std::wstring{ newCommand });
             }
 
             if (LastDisplayed == -1 ||
@@ -248,7 +258,7 @@ std::wstring_view CommandHistory::GetLastCommand() const
 
 void CommandHistory::Empty()
 {
-    _commands.clear();
+    _Clear();
     LastDisplayed = -1;
     WI_SetFlag(Flags, CLE_RESET);
 }
@@ -282,13 +292,10 @@ void CommandHistory::Realloc(const size_t commands)
         return;
     }
 
-    const auto oldCommands = _commands;
-    const auto newNumberOfCommands = gsl::narrow<SHORT>(std::min(_commands.size(), commands));
-
-    _commands.clear();
-    for (SHORT i = 0; i < newNumberOfCommands; i++)
+    // Keep the oldest commands, dropping from the end.
+    while (_commands.size() > commands)
     {
-        _commands.emplace_back(oldCommands[i]);
+        _EraseAt(_commands.size() - 1);
     }
 
     WI_SetFlag(Flags, CLE_RESET);
@@ -391,7 +398,7 @@ CommandHistory* CommandHistory::s_Allocate(const std::wstring_view appName, cons
     {
         if (!SameApp)
         {
-            BestCandidate->_commands.clear();
+            BestCandidate->_Clear();
             BestCandidate->LastDisplayed = -1;
             BestCandidate->_appName = appName;
         }
@@ -446,6 +453,108 @@ void CommandHistory::_Inc(SHORT& ind) const
     }
 }
 
+// Routine Description:
+// - Appends a command as the newest one.
+// Arguments:
+// - command - the command to add.
+void CommandHistory::_PushBack(std::wstring command)
+{
+    _commands.emplace_back(std::move(command));
+    try
+    {
+        _sequence.emplace_back(_nextSequence++);
+        _IndexInsert(_commands.size() - 1);
+    }
+    catch (...)
+    {
+        // Keep the three of them in step.
+        _sequence.resize(_commands.size() - 1);
+        _commands.pop_back();
+        throw;
+    }
+}
+
+// Routine Description:
+// - Removes the command at the given position.
+// Arguments:
+// - position - the command's position, 0 being the oldest one.
+void CommandHistory::_EraseAt(const size_t position)
+{
+    _IndexErase(position);
+    _commands.erase(_commands.cbegin() + position);
+    _sequence.erase(_sequence.cbegin() + position);
+}
+
+// Routine Description:
+// - Removes all commands.
+void CommandHistory::_Clear() noexcept
+{
+    _commands.clear();
+    _sequence.clear();
+    _index.clear();
+}
+
+// Routine Description:
+// - Adds the command at the given position to the index, under its
+//   sequence number.
+// Arguments:
+// - position - the command's position.
+void CommandHistory::_IndexInsert(const size_t position)
+{
+    const auto sequence = _sequence.at(position);
+    const auto entry = _index.try_emplace(_commands.at(position)).first;
+    auto& sequences = entry->second;
+    try
+    {
+        sequences.insert(std::upper_bound(sequences.cbegin(), sequences.cend(), sequence), sequence);
+    }
+    catch (...)
+    {
+        // Entries without commands must not stay in the index.
+        if (sequences.empty())
+        {
+            _index.erase(entry);
+        }
+        throw;
+    }
+}
+
+// Routine Description:
+// - Removes the command at the given position from the index.
+// Arguments:
+// - position - the command's position.
+void CommandHistory::_IndexErase(const size_t position)
+{
+    const auto entry = _index.find(_commands.at(position));
+    if (entry == _index.end())
+    {
+        return;
+    }
+
+    auto& sequences = entry->second;
+    const auto sequence = std::lower_bound(sequences.cbegin(), sequences.cend(), _sequence.at(position));
+    if (sequence != sequences.cend() && *sequence == _sequence.at(position))
+    {
+        sequences.erase(sequence);
+    }
+
+    if (sequences.empty())
+    {
+        _index.erase(entry);
+    }
+}
+
+// Routine Description:
+// - Finds the current position of a command.
+// Arguments:
+// - sequence - the command's sequence number.
+// Return Value:
+// - the command's position.
+size_t CommandHistory::_PositionOf(const uint64_t sequence) const
+{
+    return gsl::narrow_cast<size_t>(std::lower_bound(_sequence.cbegin(), _sequence.cend(), sequence) - _sequence.cbegin());
+}
+
 std::wstring CommandHistory::Remove(const SHORT iDel)
 {
     SHORT iFirst = 0;
@@ -474,7 +583,7 @@ std::wstring CommandHistory::Remove(const SHORT iDel)
 
         if (iDel < iLast)
         {
-            _commands.erase(_commands.cbegin() + iDel);
+            _EraseAt(iDel);
             if ((iDisp > iDel) && (iDisp <= iLast))
             {
                 _Dec(iDisp);
@@ -483,7 +592,7 @@ std::wstring CommandHistory::Remove(const SHORT iDel)
         }
         else if (iFirst <= iDel)
         {
-            _commands.erase(_commands.cbegin() + iDel);
+            _EraseAt(iDel);
             if ((iDisp >= iFirst) && (iDisp < iDel))
             {
                 _Inc(iDisp);
@@ -529,22 +638,57 @@ std::wstring CommandHistory::Remove(const SHORT iDel)
 
     try
     {
-        for (size_t i = 0; i < _commands.size(); i++)
+        // We're looking for the first match going backwards from indexFound,
+        // wrapping around to the newest command. That's the match with the
+        // highest sequence number up to the starting command's, or failing
+        // that, the highest one overall.
+        const auto startingSequence = _sequence.at(indexFound);
+        std::optional<uint64_t> matchBefore;
+        std::optional<uint64_t> matchNewest;
+
+        const auto consider = [&](const std::vector<uint64_t>& sequences) {
+            matchNewest = std::max(matchNewest.value_or(0), sequences.back());
+
+            const auto after = std::upper_bound(sequences.cbegin(), sequences.cend(), startingSequence);
+            if (after != sequences.cbegin())
+            {
+                matchBefore = std::max(matchBefore.value_or(0), *std::prev(after));
+            }
+        };
+
+        if (WI_IsFlagSet(options, MatchOptions::ExactMatch))
         {
-            const auto& storedCommand = _commands.at(indexFound);
-            if ((WI_IsFlagClear(options, MatchOptions::ExactMatch) && (givenCommand.size() <= storedCommand.size())) || (givenCommand.size() == storedCommand.size()))
+            const auto entry = _index.find(givenCommand);
+            if (entry != _index.end())
             {
-                if (std::equal(storedCommand.begin(),
-                               storedCommand.begin() + givenCommand.size(),
-                               givenCommand.begin(),
-                               givenCommand.end(),
-                               CaseInsensitiveEquality))
+                consider(entry->second);
+            }
+        }
+        else
+        {
+            // The commands starting with givenCommand follow each other in the
+            // index, beginning with the first one that isn't less than it.
+            for (auto entry = _index.lower_bound(givenCommand); entry != _index.end(); ++entry)
+            {
+                const std::wstring_view storedCommand{ entry->first };
+                if (storedCommand.size() < givenCommand.size() ||
+                    !std::equal(givenCommand.cbegin(),
+                                givenCommand.cend(),
+                                storedCommand.cbegin(),
+                                storedCommand.cbegin() + givenCommand.size(),
+                                CaseInsensitiveEquality))
                 {
-                    return true;
+                    break;
                 }
+
+                consider(entry->second);
             }
+        }
 
-            _Prev(indexFound);
+        if (const auto match = matchBefore ? matchBefore : matchNewest)
+        {
+            indexFound = gsl::narrow<SHORT>(_PositionOf(*match));
+            return true;
         }
     }
     CATCH_LOG();
@@ -566,7 +710,21 @@ void CommandHistory::s_ClearHistoryListStorage()
 // - indexB - index of one history item to swap
 void CommandHistory::Swap(const short indexA, const short indexB)
 {
-    std::swap(_commands.at(indexA), _commands.at(indexB));
+    // The sequence numbers stay where they are, so that they keep increasing
+    // along the list. Only the commands move, taking the numbers of their new
+    // positions.
+    auto& commandA = _commands.at(indexA);
+    auto& commandB = _commands.at(indexB);
+    if (indexA == indexB)
+    {
+        return;
+    }
+
+    _IndexErase(indexA);
+    _IndexErase(indexB);
+    std::swap(commandA, commandB);
+    _IndexInsert(indexA);
+    _IndexInsert(indexB);
 }
 
 // Routine Description:
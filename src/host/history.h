@@ -73,8 +73,23 @@ public:
     void Swap(const short indexA, const short indexB);
 
 private:
+    // Orders commands case-insensitively, the way they're matched. Transparent
+    // so that the index can be searched with a string_view.
+    struct CaseInsensitiveLess
+    {
+        using is_transparent = void;
+        bool operator()(const std::wstring_view lhs, const std::wstring_view rhs) const;
+    };
+
     void _Reset();
 
+    void _PushBack(std::wstring command);
+    void _EraseAt(const size_t position);
+    void _Clear() noexcept;
+    void _IndexInsert(const size_t position);
+    void _IndexErase(const size_t position);
+    size_t _PositionOf(const uint64_t sequence) const;
+
     // _Next and _Prev go to the next and prev command
     // _Inc  and _Dec go to the next and prev slots
     // Don't get the two confused - it matters when the cmd history is not full!
@@ -86,6 +101,17 @@ private:
     std::vector<std::wstring> _commands;
     SHORT _maxCommands;
 
+    // Every command gets a sequence number when it's added. They increase from
+    // the oldest command to the newest, which turns an index entry back into a
+    // position with a binary search.
+    std::vector<uint64_t> _sequence;
+    uint64_t _nextSequence = 0;
+
+    // All commands by their text, for matching without looking at each one.
+    // Commands that only differ in case share an entry, which holds the
+    // sequence numbers of all of them in ascending order.
+    std::map<std::wstring, std::vector<uint64_t>, CaseInsensitiveLess> _index;
+
     std::wstring _appName;
     HANDLE _processHandle;
 
@@ -162,11 +162,11 @@ void HandleGenericKeyEvent(_In_ KeyEvent keyEvent, const bool generateBreak)
         size_t EventsWritten = 0;
         try
         {
-            EventsWritten = gci.pInputBuffer->Write(std::make_unique<KeyEvent>(keyEvent));
+            EventsWritten = gci.pInputBuffer->Write(keyEvent.ToInputRecord());
             if (EventsWritten && generateBreak)
             {
                 keyEvent.SetKeyDown(false);
-                EventsWritten = gci.pInputBuffer->Write(std::make_unique<KeyEvent>(keyEvent));
+                EventsWritten = gci.pInputBuffer->Write(keyEvent.ToInputRecord());
             }
         }
         catch (...)
@@ -194,7 +194,7 @@ void HandleFocusEvent(const BOOL fSetFocus)
 
     try
     {
-        const size_t EventsWritten = gci.pInputBuffer->Write(std::make_unique<FocusEvent>(!!fSetFocus));
+        const size_t EventsWritten = gci.pInputBuffer->Write(FocusEvent{ !!fSetFocus }.ToInputRecord());
         FAIL_FAST_IF(EventsWritten != 1);
     }
     catch (...)
@@ -210,7 +210,7 @@ void HandleMenuEvent(const DWORD wParam)
     size_t EventsWritten = 0;
     try
     {
-        EventsWritten = gci.pInputBuffer->Write(std::make_unique<MenuEvent>(wParam));
+        EventsWritten = gci.pInputBuffer->Write(MenuEvent{ wParam }.ToInputRecord());
         if (EventsWritten != 1)
         {
             RIPMSG0(RIP_WARNING, "PutInputInBuffer: EventsWritten != 1, 1 expected");
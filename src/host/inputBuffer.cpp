@@ -9,10 +9,12 @@
 
 #include <functional>
 
+#include "../interactivity/inc/EventSynthesis.hpp"
 #include "../interactivity/inc/ServiceLocator.hpp"
 
 #define INPUT_BUFFER_DEFAULT_INPUT_MODE (ENABLE_LINE_INPUT | ENABLE_PROCESSED_INPUT | ENABLE_ECHO_INPUT | ENABLE_MOUSE_INPUT)
 
+using Microsoft::Console::Interactivity::CharToKeyRecords;
 using Microsoft::Console::Interactivity::ServiceLocator;
 using Microsoft::Console::VirtualTerminal::TerminalInput;
 using namespace Microsoft::Console;
@@ -214,10 +216,9 @@ void InputBuffer::Flush()
 // - The console lock must be held when calling this routine.
 void InputBuffer::FlushAllButKeys()
 {
-    auto newEnd = std::remove_if(_storage.begin(), _storage.end(), [](const std::unique_ptr<IInputEvent>& event) {
-        return event->EventType() != InputEventType::KeyEvent;
+    _storage.remove_if([](const INPUT_RECORD& record) noexcept {
+        return record.EventType != KEY_EVENT;
     });
-    _storage.erase(newEnd, _storage.end());
 }
 
 void InputBuffer::SetTerminalConnection(_In_ ITerminalOutputConnection* const pTtyConnection)
@@ -247,7 +248,7 @@ void InputBuffer::PassThroughWin32MouseRequest(bool enable)
 // Note:
 // - The console lock must be held when calling this routine.
 // Arguments:
-// - OutEvents - deque to store the read events
+// - OutRecords - vector to append the read records to
 // - AmountToRead - the amount of events to try to read
 // - Peek - If true, copy events to pInputRecord but don't remove them from the input buffer.
 // - WaitForData - if true, wait until an event is input (if there aren't enough to fill client buffer). if false, return immediately
@@ -257,7 +258,7 @@ void InputBuffer::PassThroughWin32MouseRequest(bool enable)
 // - STATUS_SUCCESS if records were read into the client buffer and everything is OK.
 // - CONSOLE_STATUS_WAIT if there weren't enough records to satisfy the request (and waits are allowed)
 // - otherwise a suitable memory/math/string error in NTSTATUS form.
-[[nodiscard]] NTSTATUS InputBuffer::Read(_Out_ std::deque<std::unique_ptr<IInputEvent>>& OutEvents,
+[[nodiscard]] NTSTATUS InputBuffer::Read(_Inout_ std::vector<INPUT_RECORD>& OutRecords,
                                          const size_t AmountToRead,
                                          const bool Peek,
                                          const bool WaitForData,
@@ -276,10 +277,9 @@ void InputBuffer::PassThroughWin32MouseRequest(bool enable)
         }
 
         // read from buffer
-        std::deque<std::unique_ptr<IInputEvent>> events;
         size_t eventsRead;
         bool resetWaitEvent;
-        _ReadBuffer(events,
+        _ReadBuffer(OutRecords,
                     AmountToRead,
                     eventsRead,
                     Peek,
@@ -287,13 +287,6 @@ void InputBuffer::PassThroughWin32MouseRequest(bool enable)
                     Unicode,
                     Stream);
 
-        // copy events to outEvents
-        while (!events.empty())
-        {
-            OutEvents.push_back(std::move(events.front()));
-            events.pop_front();
-        }
-
         if (resetWaitEvent)
         {
             ServiceLocator::LocateGlobals().hInputEvent.ResetEvent();
@@ -306,6 +299,110 @@ void InputBuffer::PassThroughWin32MouseRequest(bool enable)
     }
 }
 
+// Routine Description:
+// - This routine reads a single record from the input buffer, without
+//   going through a vector.
+// - See the vector version of Read for details.
+// Note:
+// - The console lock must be held when calling this routine.
+// Arguments:
+// - outRecord - where the read record is stored
+// - recordRead - on output, true if a record was stored in outRecord
+// - Peek - If true, copy the record to outRecord but don't remove it from the input buffer.
+// - WaitForData - if true, wait until an event is input (if there isn't one yet). if false, return immediately
+// - Stream - true if read should unpack KeyEvents that have a >1 repeat count.
+// Return Value:
+// - STATUS_SUCCESS if a record was read or there was none to read without waiting.
+// - CONSOLE_STATUS_WAIT if there wasn't a record to read (and waits are allowed)
+[[nodiscard]] NTSTATUS InputBuffer::Read(_Out_ INPUT_RECORD& outRecord,
+                                         _Out_ bool& recordRead,
+                                         const bool Peek,
+                                         const bool WaitForData,
+                                         const bool Stream) noexcept
+{
+    outRecord = {};
+    recordRead = false;
+
+    if (_storage.empty())
+    {
+        if (!WaitForData)
+        {
+            return STATUS_SUCCESS;
+        }
+        return CONSOLE_STATUS_WAIT;
+    }
+
+    // A single record is read whether the read is unicode or not, so this
+    // only has to deal with splitting coalesced key events.
+    auto& record = _storage.front();
+    outRecord = record;
+    recordRead = true;
+
+    if (Stream && record.EventType == KEY_EVENT && record.Event.KeyEvent.wRepeatCount > 1)
+    {
+        outRecord.Event.KeyEvent.wRepeatCount = 1;
+        if (!Peek)
+        {
+            --record.Event.KeyEvent.wRepeatCount;
+        }
+    }
+    else if (!Peek)
+    {
+        _storage.pop_front();
+    }
+
+    if (_storage.empty())
+    {
+        ServiceLocator::LocateGlobals().hInputEvent.ResetEvent();
+    }
+    return STATUS_SUCCESS;
+}
+
+// Routine Description:
+// - This routine reads from the input buffer into IInputEvents.
+// - See the INPUT_RECORD version of Read for details.
+// Note:
+// - The console lock must be held when calling this routine.
+// Arguments:
+// - OutEvents - deque to store the read events
+// - AmountToRead - the amount of events to try to read
+// - Peek - If true, copy events to pInputRecord but don't remove them from the input buffer.
+// - WaitForData - if true, wait until an event is input (if there aren't enough to fill client buffer). if false, return immediately
+// - Unicode - true if the data in key events should be treated as unicode. false if they should be converted by the current input CP.
+// - Stream - true if read should unpack KeyEvents that have a >1 repeat count. AmountToRead must be 1 if Stream is true.
+// Return Value:
+// - STATUS_SUCCESS if records were read into the client buffer and everything is OK.
+// - CONSOLE_STATUS_WAIT if there weren't enough records to satisfy the request (and waits are allowed)
+// - otherwise a suitable memory/math/string error in NTSTATUS form.
+[[nodiscard]] NTSTATUS InputBuffer::Read(_Out_ std::deque<std::unique_ptr<IInputEvent>>& OutEvents,
+                                         const size_t AmountToRead,
+                                         const bool Peek,
+                                         const bool WaitForData,
+                                         const bool Unicode,
+                                         const bool Stream)
+{
+    try
+    {
+        std::vector<INPUT_RECORD> records;
+        const auto Status = Read(records,
+                                 AmountToRead,
+                                 Peek,
+                                 WaitForData,
+                                 Unicode,
+                                 Stream);
+
+        for (const auto& record : records)
+        {
+            OutEvents.push_back(IInputEvent::Create(record));
+        }
+        return Status;
+    }
+    catch (...)
+    {
+        return NTSTATUS_FROM_HRESULT(wil::ResultFromCaughtException());
+    }
+}
+
 // Routine Description:
 // - This routine reads a single event from the input buffer.
 // - It can convert returned data to through the currently set Input CP, it can optionally return a wait condition
@@ -331,16 +428,16 @@ void InputBuffer::PassThroughWin32MouseRequest(bool enable)
     NTSTATUS Status;
     try
     {
-        std::deque<std::unique_ptr<IInputEvent>> outEvents;
-        Status = Read(outEvents,
+        std::vector<INPUT_RECORD> records;
+        Status = Read(records,
                       1,
                       Peek,
                       WaitForData,
                       Unicode,
                       Stream);
-        if (!outEvents.empty())
+        if (!records.empty())
         {
-            outEvent.swap(outEvents.front());
+            outEvent = IInputEvent::Create(records.front());
         }
     }
     catch (...)
@@ -354,7 +451,7 @@ void InputBuffer::PassThroughWin32MouseRequest(bool enable)
 // Routine Description:
 // - This routine reads from a buffer. It does the buffer manipulation.
 // Arguments:
-// - outEvents - where read events are placed
+// - outRecords - where read records are appended
 // - readCount - amount of events to read
 // - eventsRead - where to store number of events read
 // - peek - if true , don't remove data from buffer, just copy it.
@@ -365,7 +462,7 @@ void InputBuffer::PassThroughWin32MouseRequest(bool enable)
 // - <none>
 // Note:
 // - The console lock must be held when calling this routine.
-void InputBuffer::_ReadBuffer(_Out_ std::deque<std::unique_ptr<IInputEvent>>& outEvents,
+void InputBuffer::_ReadBuffer(_Inout_ std::vector<INPUT_RECORD>& outRecords,
                               const size_t readCount,
                               _Out_ size_t& eventsRead,
                               const bool peek,
@@ -377,156 +474,89 @@ void InputBuffer::_ReadBuffer(_Out_ std::deque<std::unique_ptr<IInputEvent>>& ou
     // event at a time.
     FAIL_FAST_IF(streamRead && readCount != 1);
 
-    resetWaitEvent = false;
+    const auto initialSize = outRecords.size();
 
-    std::deque<std::unique_ptr<IInputEvent>> readEvents;
     // we need another var to keep track of how many we've read
     // because dbcs records count for two when we aren't doing a
     // unicode read but the eventsRead count should return the number
     // of events actually put into outRecords.
     size_t virtualReadCount = 0;
+    // The records are only removed from the storage once we're done, and
+    // only if we aren't peeking.
+    size_t consumed = 0;
 
-    while (!_storage.empty() && virtualReadCount < readCount)
+    while (consumed < _storage.size() && virtualReadCount < readCount)
     {
-        bool performNormalRead = true;
+        auto& record = _storage[consumed];
+
         // for stream reads we need to split any key events that have been coalesced
-        if (streamRead)
+        if (streamRead && record.EventType == KEY_EVENT && record.Event.KeyEvent.wRepeatCount > 1)
         {
-            if (_storage.front()->EventType() == InputEventType::KeyEvent)
+            auto& split = outRecords.emplace_back(record);
+            split.Event.KeyEvent.wRepeatCount = 1;
+            if (!peek)
             {
-                KeyEvent* const pKeyEvent = static_cast<KeyEvent* const>(_storage.front().get());
-                if (pKeyEvent->GetRepeatCount() > 1)
-                {
-                    // split the key event
-                    std::unique_ptr<KeyEvent> streamKeyEvent = std::make_unique<KeyEvent>(*pKeyEvent);
-                    streamKeyEvent->SetRepeatCount(1);
-                    readEvents.push_back(std::move(streamKeyEvent));
-                    pKeyEvent->SetRepeatCount(pKeyEvent->GetRepeatCount() - 1);
-                    performNormalRead = false;
-                }
+                --record.Event.KeyEvent.wRepeatCount;
             }
+            break;
         }
 
-        if (performNormalRead)
-        {
-            readEvents.push_back(std::move(_storage.front()));
-            _storage.pop_front();
-        }
+        outRecords.push_back(record);
+        ++consumed;
 
         ++virtualReadCount;
-        if (!unicode)
+        if (!unicode && record.EventType == KEY_EVENT && IsGlyphFullWidth(record.Event.KeyEvent.uChar.UnicodeChar))
         {
-            if (readEvents.back()->EventType() == InputEventType::KeyEvent)
-            {
-                const KeyEvent* const pKeyEvent = static_cast<const KeyEvent* const>(readEvents.back().get());
-                if (IsGlyphFullWidth(pKeyEvent->GetCharData()))
-                {
-                    ++virtualReadCount;
-                }
-            }
+            ++virtualReadCount;
         }
     }
 
     // the amount of events that were actually read
-    eventsRead = readEvents.size();
-
-    // copy the events back if we were supposed to peek
-    if (peek)
-    {
-        if (streamRead)
-        {
-            // we need to check and see if the event was split from a coalesced key event
-            // or if it was unrelated to the current front event in storage
-            if (!readEvents.empty() &&
-                !_storage.empty() &&
-                readEvents.back()->EventType() == InputEventType::KeyEvent &&
-                _storage.front()->EventType() == InputEventType::KeyEvent &&
-                _CanCoalesce(static_cast<const KeyEvent&>(*readEvents.back()),
-                             static_cast<const KeyEvent&>(*_storage.front())))
-            {
-                KeyEvent& keyEvent = static_cast<KeyEvent&>(*_storage.front());
-                keyEvent.SetRepeatCount(keyEvent.GetRepeatCount() + 1);
-            }
-            else
-            {
-                _storage.push_front(IInputEvent::Create(readEvents.back()->ToInputRecord()));
-            }
-        }
-        else
-        {
-            for (auto it = readEvents.crbegin(); it != readEvents.crend(); ++it)
-            {
-                _storage.push_front(IInputEvent::Create((*it)->ToInputRecord()));
-            }
-        }
-    }
+    eventsRead = outRecords.size() - initialSize;
 
-    // move events read to proper deque
-    while (!readEvents.empty())
+    if (!peek)
     {
-        outEvents.push_back(std::move(readEvents.front()));
-        readEvents.pop_front();
+        _storage.pop_front(consumed);
     }
 
     // signal if we emptied the buffer
-    if (_storage.empty())
-    {
-        resetWaitEvent = true;
-    }
+    resetWaitEvent = _storage.empty();
 }
 
 // Routine Description:
 // -  Writes events to the beginning of the input buffer.
 // Arguments:
-// - inEvents - events to write to buffer.
-// - eventsWritten - The number of events written to the buffer on exit.
+// - inRecords - records to write to buffer.
 // Return Value:
-// S_OK if successful.
+// - The number of events written to the buffer.
 // Note:
 // - The console lock must be held when calling this routine.
-size_t InputBuffer::Prepend(_Inout_ std::deque<std::unique_ptr<IInputEvent>>& inEvents)
+size_t InputBuffer::Prepend(const gsl::span<const INPUT_RECORD> inRecords)
 {
     try
     {
         _vtInputShouldSuppress = true;
         auto resetVtInputSuppress = wil::scope_exit([&]() { _vtInputShouldSuppress = false; });
-        _HandleConsoleSuspensionEvents(inEvents);
-        if (inEvents.empty())
-        {
-            return STATUS_SUCCESS;
-        }
-        // read all of the records out of the buffer, then write the
-        // prepend ones, then write the original set. We need to do it
-        // this way to handle any coalescing that might occur.
-
-        // get all of the existing records, "emptying" the buffer
-        std::deque<std::unique_ptr<IInputEvent>> existingStorage;
-        existingStorage.swap(_storage);
 
-        // We will need this variable to pass to _WriteBuffer so it can attempt to determine wait status.
-        // However, because we swapped the storage out from under it with an empty deque, it will always
-        // return true after the first one (as it is filling the newly emptied backing deque.)
-        // Then after the second one, because we've inserted some input, it will always say false.
-        bool unusedWaitStatus = false;
+        // Move the existing records out of the way, write the prepended
+        // ones, then put the existing ones back after them. The existing
+        // records have already been through coalescing and VT translation
+        // when they were first written, so they're appended back verbatim.
+        auto existingStorage = std::move(_storage);
+        _storage.clear();
 
-        // write the prepend records
         size_t prependEventsWritten;
-        _WriteBuffer(inEvents, prependEventsWritten, unusedWaitStatus);
-        FAIL_FAST_IF(!(unusedWaitStatus));
+        bool unusedWaitStatus;
+        _WriteBuffer(inRecords, prependEventsWritten, unusedWaitStatus);
 
-        // write all previously existing records
-        size_t existingEventsWritten;
-        _WriteBuffer(existingStorage, existingEventsWritten, unusedWaitStatus);
-        FAIL_FAST_IF(!(!unusedWaitStatus));
+        for (size_t i = 0; i < existingStorage.size(); ++i)
+        {
+            _storage.push_back(existingStorage[i]);
+        }
 
         // We need to set the wait event if there were 0 events in the
         // input queue when we started.
-        // Because we did interesting manipulation of the wait queue
-        // in order to prepend, we can't trust what _WriteBuffer said
-        // and instead need to set the event if the original backing
-        // buffer (the one we swapped out at the top) was empty
-        // when this whole thing started.
-        if (existingStorage.empty())
+        if (existingStorage.empty() && !_storage.empty())
         {
             ServiceLocator::LocateGlobals().hInputEvent.SetEvent();
         }
@@ -542,23 +572,20 @@ size_t InputBuffer::Prepend(_Inout_ std::deque<std::unique_ptr<IInputEvent>>& in
 }
 
 // Routine Description:
-// - Writes event to the input buffer. Wakes up any readers that are
-// waiting for additional input events.
+// -  Writes events to the beginning of the input buffer.
 // Arguments:
-// - inEvent - input event to store in the buffer.
+// - inEvents - events to write to buffer.
 // Return Value:
-// - The number of events that were written to input buffer.
+// - The number of events written to the buffer.
 // Note:
 // - The console lock must be held when calling this routine.
-// - any outside references to inEvent will ben invalidated after
-// calling this method.
-size_t InputBuffer::Write(_Inout_ std::unique_ptr<IInputEvent> inEvent)
+size_t InputBuffer::Prepend(_Inout_ std::deque<std::unique_ptr<IInputEvent>>& inEvents)
 {
     try
     {
-        std::deque<std::unique_ptr<IInputEvent>> inEvents;
-        inEvents.push_back(std::move(inEvent));
-        return Write(inEvents);
+        const auto records = IInputEvent::ToInputRecords(inEvents);
+        inEvents.clear();
+        return Prepend(records);
     }
     catch (...)
     {
@@ -568,30 +595,39 @@ size_t InputBuffer::Write(_Inout_ std::unique_ptr<IInputEvent> inEvent)
 }
 
 // Routine Description:
-// - Writes events to the input buffer. Wakes up any readers that are
+// - Writes a record to the input buffer. Wakes up any readers that are
 // waiting for additional input events.
 // Arguments:
-// - inEvents - input events to store in the buffer.
+// - inRecord - input record to store in the buffer.
 // Return Value:
 // - The number of events that were written to input buffer.
 // Note:
 // - The console lock must be held when calling this routine.
-size_t InputBuffer::Write(_Inout_ std::deque<std::unique_ptr<IInputEvent>>& inEvents)
+size_t InputBuffer::Write(const INPUT_RECORD& inRecord)
+{
+    return Write(gsl::span<const INPUT_RECORD>{ &inRecord, 1 });
+}
+
+// Routine Description:
+// - Writes records to the input buffer. Wakes up any readers that are
+// waiting for additional input events.
+// Arguments:
+// - inRecords - input records to store in the buffer.
+// Return Value:
+// - The number of events that were written to input buffer.
+// Note:
+// - The console lock must be held when calling this routine.
+size_t InputBuffer::Write(const gsl::span<const INPUT_RECORD> inRecords)
 {
     try
     {
         _vtInputShouldSuppress = true;
         auto resetVtInputSuppress = wil::scope_exit([&]() { _vtInputShouldSuppress = false; });
-        _HandleConsoleSuspensionEvents(inEvents);
-        if (inEvents.empty())
-        {
-            return 0;
-        }
 
         // Write to buffer.
         size_t EventsWritten;
         bool SetWaitEvent;
-        _WriteBuffer(inEvents, EventsWritten, SetWaitEvent);
+        _WriteBuffer(inRecords, EventsWritten, SetWaitEvent);
 
         if (SetWaitEvent)
         {
@@ -610,9 +646,83 @@ size_t InputBuffer::Write(_Inout_ std::deque<std::unique_ptr<IInputEvent>>& inEv
 }
 
 // Routine Description:
-// - Coalesces input events and transfers them to storage queue.
+// - Writes text to the input buffer as if it had been typed, for instance
+//   when it was pasted. Wakes up any readers that are waiting for additional
+//   input events.
+// - Every character is typed out with the key down and up events that
+//   CharToKeyRecords synthesizes for it, and they're all written at once.
+//   In VT input mode they go through TerminalInput like any other write.
 // Arguments:
-// - inRecords - The events to store.
+// - text - The text to write.
+// Return Value:
+// - The number of events that were written to input buffer.
+// Note:
+// - The console lock must be held when calling this routine.
+size_t InputBuffer::WriteString(const std::wstring_view text)
+{
+    try
+    {
+        const auto codepage = ServiceLocator::LocateGlobals().getConsoleInformation().OutputCP;
+
+        std::vector<INPUT_RECORD> records;
+        records.reserve(text.size() * 2);
+        for (const auto wch : text)
+        {
+            CharToKeyRecords(wch, codepage, records);
+        }
+        return Write(records);
+    }
+    catch (...)
+    {
+        LOG_HR(wil::ResultFromCaughtException());
+        return 0;
+    }
+}
+
+// Routine Description:
+// - Writes event to the input buffer. Wakes up any readers that are
+// waiting for additional input events.
+// Arguments:
+// - inEvent - input event to store in the buffer.
+// Return Value:
+// - The number of events that were written to input buffer.
+// Note:
+// - The console lock must be held when calling this routine.
+// - any outside references to inEvent will ben invalidated after
+// calling this method.
+size_t InputBuffer::Write(_Inout_ std::unique_ptr<IInputEvent> inEvent)
+{
+    return Write(inEvent->ToInputRecord());
+}
+
+// Routine Description:
+// - Writes events to the input buffer. Wakes up any readers that are
+// waiting for additional input events.
+// Arguments:
+// - inEvents - input events to store in the buffer.
+// Return Value:
+// - The number of events that were written to input buffer.
+// Note:
+// - The console lock must be held when calling this routine.
+size_t InputBuffer::Write(_Inout_ std::deque<std::unique_ptr<IInputEvent>>& inEvents)
+{
+    try
+    {
+        const auto records = IInputEvent::ToInputRecords(inEvents);
+        inEvents.clear();
+        return Write(records);
+    }
+    catch (...)
+    {
+        LOG_HR(wil::ResultFromCaughtException());
+        return 0;
+    }
+}
+
+// Routine Description:
+// - Coalesces input records and transfers them to storage queue.
+// Arguments:
+// - inRecords - The records to store.
 // - eventsWritten - The number of events written since this function
 // was called.
 // - setWaitEvent - on exit, true if buffer became non-empty.
@@ -621,29 +731,31 @@ size_t InputBuffer::Write(_Inout_ std::deque<std::unique_ptr<IInputEvent>>& inEv
 // Note:
 // - The console lock must be held when calling this routine.
 // - will throw on failure
-void InputBuffer::_WriteBuffer(_Inout_ std::deque<std::unique_ptr<IInputEvent>>& inEvents,
+void InputBuffer::_WriteBuffer(const gsl::span<const INPUT_RECORD> inRecords,
                                _Out_ size_t& eventsWritten,
                                _Out_ bool& setWaitEvent)
 {
     eventsWritten = 0;
     setWaitEvent = false;
     const bool initiallyEmptyQueue = _storage.empty();
-    const size_t initialInEventsSize = inEvents.size();
     const bool vtInputMode = IsInVirtualTerminalInputMode();
 
-    while (!inEvents.empty())
+    for (const auto& inRecord : inRecords)
     {
-        // Pop the next event.
+        // Records that pause or resume the console are consumed right away.
         // If we're in vt mode, try and handle it with the vt input module.
         // If it was handled, do nothing else for it.
         // If there was one event passed in, try coalescing it with the previous event currently in the buffer.
         // If it's not coalesced, append it to the buffer.
-        std::unique_ptr<IInputEvent> inEvent = std::move(inEvents.front());
-        inEvents.pop_front();
-        if (vtInputMode)
+        if (_HandleConsoleSuspensionEvent(inRecord))
         {
-            const bool handled = _termInput.HandleKey(inEvent.get());
-            if (handled)
+            continue;
+        }
+
+        if (vtInputMode && inRecord.EventType == KEY_EVENT)
+        {
+            const KeyEvent keyEvent{ inRecord.Event.KeyEvent };
+            if (_termInput.HandleKey(&keyEvent))
             {
                 eventsWritten++;
                 continue;
@@ -654,42 +766,19 @@ void InputBuffer::_WriteBuffer(_Inout_ std::deque<std::unique_ptr<IInputEvent>>&
         // record at a time because this is the original behavior of
         // the input buffer. Changing this behavior may break stuff
         // that was depending on it.
-        if (initialInEventsSize == 1 && !_storage.empty())
+        //
+        // this looks kinda weird but we don't want to coalesce a
+        // mouse event and then try to coalesce a key event right after.
+        if (inRecords.size() == 1 &&
+            !_storage.empty() &&
+            (_CoalesceMouseMovedEvents(inRecord) || _CoalesceRepeatedKeyPressEvents(inRecord)))
         {
-            // coalescing requires a deque of events, so push it back onto the front.
-            inEvents.push_front(std::move(inEvent));
-
-            bool coalesced = false;
-            // this looks kinda weird but we don't want to coalesce a
-            // mouse event and then try to coalesce a key event right after.
-            //
-            // we also pass the whole deque to the coalescing methods
-            // even though they only want one event because it should
-            // be their responsibility to maintain the correct state
-            // of the deque if they process any records in it.
-            if (_CoalesceMouseMovedEvents(inEvents))
-            {
-                coalesced = true;
-            }
-            else if (_CoalesceRepeatedKeyPressEvents(inEvents))
-            {
-                coalesced = true;
-            }
-            if (coalesced)
-            {
-                eventsWritten = 1;
-                return;
-            }
-            else
-            {
-                // We didn't coalesce the event. pull it from the queue again,
-                //  to keep the state consistent with the start of this block.
-                inEvent = std::move(inEvents.front());
-                inEvents.pop_front();
-            }
+            eventsWritten = 1;
+            return;
         }
+
         // At this point, the event was neither coalesced, nor processed by VT.
-        _storage.push_back(std::move(inEvent));
+        _storage.push_back(inRecord);
         ++eventsWritten;
     }
     if (initiallyEmptyQueue && !_storage.empty())
@@ -699,67 +788,53 @@ void InputBuffer::_WriteBuffer(_Inout_ std::deque<std::unique_ptr<IInputEvent>>&
 }
 
 // Routine Description:
-// - Checks if the last saved event and the first event of inRecords are
-// both MOUSE_MOVED events. If they are, the last saved event is
-// updated with the new mouse position and the first event of inRecords is
-// dropped.
+// - Checks if the last saved record and the incoming record are both
+// MOUSE_MOVED events. If they are, the last saved record is updated
+// in place with the new mouse position.
 // Arguments:
-// - inRecords - The incoming records to process.
+// - inRecord - The incoming record to process.
 // Return Value:
 // true if events were coalesced, false if they were not.
 // Note:
-// - The size of inRecords must be 1.
 // - Coalescing here means updating a record that already exists in
 // the buffer with updated values from an incoming event, instead of
 // storing the incoming event (which would make the original one
 // redundant/out of date with the most current state).
-bool InputBuffer::_CoalesceMouseMovedEvents(_Inout_ std::deque<std::unique_ptr<IInputEvent>>& inEvents)
+bool InputBuffer::_CoalesceMouseMovedEvents(const INPUT_RECORD& inRecord) noexcept
 {
-    FAIL_FAST_IF(!(inEvents.size() == 1));
     FAIL_FAST_IF(_storage.empty());
-    const IInputEvent* const pFirstInEvent = inEvents.front().get();
-    const IInputEvent* const pLastStoredEvent = _storage.back().get();
-    if (pFirstInEvent->EventType() == InputEventType::MouseEvent &&
-        pLastStoredEvent->EventType() == InputEventType::MouseEvent)
+    auto& lastRecord = _storage.back();
+    if (inRecord.EventType == MOUSE_EVENT &&
+        lastRecord.EventType == MOUSE_EVENT &&
+        inRecord.Event.MouseEvent.dwEventFlags == MOUSE_MOVED &&
+        lastRecord.Event.MouseEvent.dwEventFlags == MOUSE_MOVED)
     {
-        const MouseEvent* const pInMouseEvent = static_cast<const MouseEvent* const>(pFirstInEvent);
-        const MouseEvent* const pLastMouseEvent = static_cast<const MouseEvent* const>(pLastStoredEvent);
-
-        if (pInMouseEvent->IsMouseMoveEvent() &&
-            pLastMouseEvent->IsMouseMoveEvent())
-        {
-            // update mouse moved position
-            MouseEvent* const pMouseEvent = static_cast<MouseEvent* const>(_storage.back().release());
-            pMouseEvent->SetPosition(pInMouseEvent->GetPosition());
-            std::unique_ptr<IInputEvent> tempPtr(pMouseEvent);
-            tempPtr.swap(_storage.back());
-
-            inEvents.pop_front();
-            return true;
-        }
+        // update mouse moved position
+        lastRecord.Event.MouseEvent.dwMousePosition = inRecord.Event.MouseEvent.dwMousePosition;
+        return true;
     }
     return false;
 }
 
 // Routine Description:
-// - checks two KeyEvents to see if they're similar enough to be coalesced
+// - checks two key records to see if they're similar enough to be coalesced
 // Arguments:
-// - a - the first KeyEvent
-// - b - the other KeyEvent
+// - a - the first key record
+// - b - the other key record
 // Return Value:
 // - true if the events could be coalesced, false otherwise
-bool InputBuffer::_CanCoalesce(const KeyEvent& a, const KeyEvent& b) const noexcept
+bool InputBuffer::_CanCoalesce(const KEY_EVENT_RECORD& a, const KEY_EVENT_RECORD& b) const noexcept
 {
-    if (WI_IsFlagSet(a.GetActiveModifierKeys(), NLS_IME_CONVERSION) &&
-        a.GetCharData() == b.GetCharData() &&
-        a.GetActiveModifierKeys() == b.GetActiveModifierKeys())
+    if (WI_IsFlagSet(a.dwControlKeyState, NLS_IME_CONVERSION) &&
+        a.uChar.UnicodeChar == b.uChar.UnicodeChar &&
+        a.dwControlKeyState == b.dwControlKeyState)
     {
         return true;
     }
     // other key events check
-    else if (a.GetVirtualScanCode() == b.GetVirtualScanCode() &&
-             a.GetCharData() == b.GetCharData() &&
-             a.GetActiveModifierKeys() == b.GetActiveModifierKeys())
+    else if (a.wVirtualScanCode == b.wVirtualScanCode &&
+             a.uChar.UnicodeChar == b.uChar.UnicodeChar &&
+             a.dwControlKeyState == b.dwControlKeyState)
     {
         return true;
     }
@@ -767,44 +842,35 @@ bool InputBuffer::_CanCoalesce(const KeyEvent& a, const KeyEvent& b) const noexc
 }
 
 // Routine Description::
-// - If the last input event saved and the first input event in inRecords
-// are both a keypress down event for the same key, update the repeat
-// count of the saved event and drop the first from inRecords.
+// - If the last input record saved and the incoming record are both a
+// keypress down event for the same key, update the repeat count of the
+// saved record in place.
 // Arguments:
-// - inRecords - The incoming records to process.
+// - inRecord - The incoming record to process.
 // Return Value:
 // true if events were coalesced, false if they were not.
 // Note:
-// - The size of inRecords must be 1.
 // - Coalescing here means updating a record that already exists in
 // the buffer with updated values from an incoming event, instead of
 // storing the incoming event (which would make the original one
 // redundant/out of date with the most current state).
-bool InputBuffer::_CoalesceRepeatedKeyPressEvents(_Inout_ std::deque<std::unique_ptr<IInputEvent>>& inEvents)
+bool InputBuffer::_CoalesceRepeatedKeyPressEvents(const INPUT_RECORD& inRecord) noexcept
 {
-    FAIL_FAST_IF(!(inEvents.size() == 1));
     FAIL_FAST_IF(_storage.empty());
-    const IInputEvent* const pFirstInEvent = inEvents.front().get();
-    const IInputEvent* const pLastStoredEvent = _storage.back().get();
-    if (pFirstInEvent->EventType() == InputEventType::KeyEvent &&
-        pLastStoredEvent->EventType() == InputEventType::KeyEvent)
-    {
-        const KeyEvent* const pInKeyEvent = static_cast<const KeyEvent* const>(pFirstInEvent);
-        const KeyEvent* const pLastKeyEvent = static_cast<const KeyEvent* const>(pLastStoredEvent);
-
-        if (pInKeyEvent->IsKeyDown() &&
-            pLastKeyEvent->IsKeyDown() &&
-            !IsGlyphFullWidth(pInKeyEvent->GetCharData()) &&
-            _CanCoalesce(*pInKeyEvent, *pLastKeyEvent))
+    auto& lastRecord = _storage.back();
+    if (inRecord.EventType == KEY_EVENT &&
+        lastRecord.EventType == KEY_EVENT)
+    {
+        const auto& inKey = inRecord.Event.KeyEvent;
+        auto& lastKey = lastRecord.Event.KeyEvent;
+
+        if (inKey.bKeyDown &&
+            lastKey.bKeyDown &&
+            !IsGlyphFullWidth(inKey.uChar.UnicodeChar) &&
+            _CanCoalesce(inKey, lastKey))
         {
             // increment repeat count
-            KeyEvent* const pKeyEvent = static_cast<KeyEvent* const>(_storage.back().release());
-            WORD repeatCount = pKeyEvent->GetRepeatCount() + pInKeyEvent->GetRepeatCount();
-            pKeyEvent->SetRepeatCount(repeatCount);
-            std::unique_ptr<IInputEvent> tempPtr(pKeyEvent);
-            tempPtr.swap(_storage.back());
-
-            inEvents.pop_front();
+            lastKey.wRepeatCount += inKey.wRepeatCount;
             return true;
         }
     }
@@ -812,44 +878,35 @@ bool InputBuffer::_CoalesceRepeatedKeyPressEvents(_Inout_ std::deque<std::unique
 }
 
 // Routine Description:
-// - Handles records that suspend/resume the console.
+// - Handles a record that suspends/resumes the console.
 // Arguments:
-// - records - records to check for pause/unpause events
+// - inRecord - record to check for pause/unpause events
 // Return Value:
-// - None
+// - true if the record was consumed and must not be stored.
 // Note:
 // - The console lock must be held when calling this routine.
 // - will throw exception on error
-void InputBuffer::_HandleConsoleSuspensionEvents(_Inout_ std::deque<std::unique_ptr<IInputEvent>>& inEvents)
+bool InputBuffer::_HandleConsoleSuspensionEvent(const INPUT_RECORD& inRecord)
 {
-    CONSOLE_INFORMATION& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
+    if (inRecord.EventType != KEY_EVENT || !inRecord.Event.KeyEvent.bKeyDown)
+    {
+        return false;
+    }
 
-    std::deque<std::unique_ptr<IInputEvent>> outEvents;
-    while (!inEvents.empty())
+    CONSOLE_INFORMATION& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
+    const KeyEvent keyEvent{ inRecord.Event.KeyEvent };
+    if (WI_IsFlagSet(gci.Flags, CONSOLE_SUSPENDED) &&
+        !IsSystemKey(keyEvent.GetVirtualKeyCode()))
     {
-        std::unique_ptr<IInputEvent> currEvent = std::move(inEvents.front());
-        inEvents.pop_front();
-        if (currEvent->EventType() == InputEventType::KeyEvent)
-        {
-            const KeyEvent* const pKeyEvent = static_cast<const KeyEvent* const>(currEvent.get());
-            if (pKeyEvent->IsKeyDown())
-            {
-                if (WI_IsFlagSet(gci.Flags, CONSOLE_SUSPENDED) &&
-                    !IsSystemKey(pKeyEvent->GetVirtualKeyCode()))
-                {
-                    UnblockWriteConsole(CONSOLE_OUTPUT_SUSPENDED);
-                    continue;
-                }
-                else if (WI_IsFlagSet(InputMode, ENABLE_LINE_INPUT) && pKeyEvent->IsPauseKey())
-                {
-                    WI_SetFlag(gci.Flags, CONSOLE_SUSPENDED);
-                    continue;
-                }
-            }
-        }
-        outEvents.push_back(std::move(currEvent));
+        UnblockWriteConsole(CONSOLE_OUTPUT_SUSPENDED);
+        return true;
     }
-    inEvents.swap(outEvents);
+    else if (WI_IsFlagSet(InputMode, ENABLE_LINE_INPUT) && keyEvent.IsPauseKey())
+    {
+        WI_SetFlag(gci.Flags, CONSOLE_SUSPENDED);
+        return true;
+    }
+    return false;
 }
 
 // Routine Description:
@@ -875,12 +932,11 @@ void InputBuffer::_HandleTerminalInputCallback(std::deque<std::unique_ptr<IInput
     try
     {
         // add all input events to the storage queue
-        while (!inEvents.empty())
+        for (const auto& inEvent : inEvents)
         {
-            std::unique_ptr<IInputEvent> inEvent = std::move(inEvents.front());
-            inEvents.pop_front();
-            _storage.push_back(std::move(inEvent));
+            _storage.push_back(inEvent->ToInputRecord());
         }
+        inEvents.clear();
 
         if (!_vtInputShouldSuppress)
         {
@@ -898,3 +954,74 @@ TerminalInput& InputBuffer::GetTerminalInput()
 {
     return _termInput;
 }
+
+// Routine Description:
+// - Appends a record to the end of the queue, growing the ring if it's full.
+// Arguments:
+// - record - The record to append.
+// Return Value:
+// - <none>
+void InputRecordRing::push_back(const INPUT_RECORD& record)
+{
+    if (_size == _buffer.size())
+    {
+        _Grow();
+    }
+    (*this)[_size] = record;
+    ++_size;
+}
+
+// Routine Description:
+// - Removes records from the front of the queue. Once the queue is empty,
+//   an unusually large ring (for instance after a big paste) is released.
+// Arguments:
+// - count - The number of records to remove. Must not exceed size().
+// Return Value:
+// - <none>
+void InputRecordRing::pop_front(const size_t count) noexcept
+{
+    _head = (_head + count) & (_buffer.size() - 1);
+    _size -= count;
+
+    if (_size == 0)
+    {
+        clear();
+    }
+}
+
+// Routine Description:
+// - Removes all records from the queue.
+// Arguments:
+// - <none>
+// Return Value:
+// - <none>
+void InputRecordRing::clear() noexcept
+{
+    // Keep the memory around for the next events, unless there's a lot of it.
+    static constexpr size_t maxRetainedCapacity = 4096;
+    if (_buffer.size() > maxRetainedCapacity)
+    {
+        _buffer = {};
+    }
+    _head = 0;
+    _size = 0;
+}
+
+// Routine Description:
+// - Doubles the capacity of the ring, moving the records to the start of
+//   the new buffer.
+// Arguments:
+// - <none>
+// Return Value:
+// - <none>
+void InputRecordRing::_Grow()
+{
+    static constexpr size_t initialCapacity = 64;
+    std::vector<INPUT_RECORD> buffer(std::max(initialCapacity, _buffer.size() * 2));
+    for (size_t i = 0; i < _size; ++i)
+    {
+        til::at(buffer, i) = (*this)[i];
+    }
+    _buffer = std::move(buffer);
+    _head = 0;
+}
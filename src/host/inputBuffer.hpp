@@ -14,6 +14,8 @@ Author:
 Revision History:
 - Moved from input.h/input.cpp. (AustDi, 2017)
 - Refactored to class, added stl container usage (AustDi, 2017)
+- Events are stored by value as INPUT_RECORDs in a ring buffer, instead of
+  one heap allocated IInputEvent each.
 --*/
 
 #pragma once
@@ -30,6 +32,69 @@ Revision History:
 
 #include <deque>
 
+// A FIFO queue of INPUT_RECORDs, stored by value in a single ring buffer.
+// Its capacity only grows while it's in use, so once it's large enough for
+// the pending input, queueing events doesn't allocate anymore.
+class InputRecordRing
+{
+public:
+    bool empty() const noexcept
+    {
+        return _size == 0;
+    }
+
+    size_t size() const noexcept
+    {
+        return _size;
+    }
+
+    INPUT_RECORD& operator[](const size_t index) noexcept
+    {
+        return til::at(_buffer, (_head + index) & (_buffer.size() - 1));
+    }
+
+    const INPUT_RECORD& operator[](const size_t index) const noexcept
+    {
+        return til::at(_buffer, (_head + index) & (_buffer.size() - 1));
+    }
+
+    INPUT_RECORD& front() noexcept
+    {
+        return (*this)[0];
+    }
+
+    INPUT_RECORD& back() noexcept
+    {
+        return (*this)[_size - 1];
+    }
+
+    void push_back(const INPUT_RECORD& record);
+    void pop_front(const size_t count = 1) noexcept;
+    void clear() noexcept;
+
+    // Removes the records matching the predicate, keeping the others in order.
+    template<typename T>
+    void remove_if(const T& predicate) noexcept
+    {
+        size_t kept = 0;
+        for (size_t i = 0; i < _size; ++i)
+        {
+            if (!predicate((*this)[i]))
+            {
+                (*this)[kept++] = (*this)[i];
+            }
+        }
+        _size = kept;
+    }
+
+private:
+    void _Grow();
+
+    std::vector<INPUT_RECORD> _buffer; // The size is always zero or a power of two.
+    size_t _head = 0;
+    size_t _size = 0;
+};
+
 class InputBuffer final : public ConsoleObjectHeader
 {
 public:
@@ -57,6 +122,27 @@ public:
     void Flush();
     void FlushAllButKeys();
 
+    [[nodiscard]] NTSTATUS Read(_Inout_ std::vector<INPUT_RECORD>& OutRecords,
+                                const size_t AmountToRead,
+                                const bool Peek,
+                                const bool WaitForData,
+                                const bool Unicode,
+                                const bool Stream);
+
+    [[nodiscard]] NTSTATUS Read(_Out_ INPUT_RECORD& outRecord,
+                                _Out_ bool& recordRead,
+                                const bool Peek,
+                                const bool WaitForData,
+                                const bool Stream) noexcept;
+
+    size_t Prepend(const gsl::span<const INPUT_RECORD> inRecords);
+
+    size_t Write(const INPUT_RECORD& inRecord);
+    size_t Write(const gsl::span<const INPUT_RECORD> inRecords);
+    size_t WriteString(const std::wstring_view text);
+
+    // These are wrappers around the functions above, for callers that still
+    // deal in IInputEvents.
     [[nodiscard]] NTSTATUS Read(_Out_ std::deque<std::unique_ptr<IInputEvent>>& OutEvents,
                                 const size_t AmountToRead,
                                 const bool Peek,
@@ -81,7 +167,7 @@ public:
     void PassThroughWin32MouseRequest(bool enable);
 
 private:
-    std::deque<std::unique_ptr<IInputEvent>> _storage;
+    InputRecordRing _storage;
     std::unique_ptr<IInputEvent> _readPartialByteSequence;
     std::unique_ptr<IInputEvent> _writePartialByteSequence;
     Microsoft::Console::VirtualTerminal::TerminalInput _termInput;
@@ -93,7 +179,7 @@ private:
     // Otherwise, we should be calling them.
     bool _vtInputShouldSuppress{ false };
 
-    void _ReadBuffer(_Out_ std::deque<std::unique_ptr<IInputEvent>>& outEvents,
+    void _ReadBuffer(_Inout_ std::vector<INPUT_RECORD>& outRecords,
                      const size_t readCount,
                      _Out_ size_t& eventsRead,
                      const bool peek,
@@ -101,14 +187,14 @@ private:
                      const bool unicode,
                      const bool streamRead);
 
-    void _WriteBuffer(_Inout_ std::deque<std::unique_ptr<IInputEvent>>& inRecords,
+    void _WriteBuffer(const gsl::span<const INPUT_RECORD> inRecords,
                       _Out_ size_t& eventsWritten,
                       _Out_ bool& setWaitEvent);
 
-    bool _CanCoalesce(const KeyEvent& a, const KeyEvent& b) const noexcept;
-    bool _CoalesceMouseMovedEvents(_Inout_ std::deque<std::unique_ptr<IInputEvent>>& inEvents);
-    bool _CoalesceRepeatedKeyPressEvents(_Inout_ std::deque<std::unique_ptr<IInputEvent>>& inEvents);
-    void _HandleConsoleSuspensionEvents(_Inout_ std::deque<std::unique_ptr<IInputEvent>>& inEvents);
+    bool _CanCoalesce(const KEY_EVENT_RECORD& a, const KEY_EVENT_RECORD& b) const noexcept;
+    bool _CoalesceMouseMovedEvents(const INPUT_RECORD& inRecord) noexcept;
+    bool _CoalesceRepeatedKeyPressEvents(const INPUT_RECORD& inRecord) noexcept;
+    bool _HandleConsoleSuspensionEvent(const INPUT_RECORD& inRecord);
 
     void _HandleTerminalInputCallback(_In_ std::deque<std::unique_ptr<IInputEvent>>& inEvents);
 
@@ -183,47 +183,41 @@ BOOL CheckBisectProcessW(const SCREEN_INFORMATION& ScreenInfo,
 }
 
 // Routine Description:
-// - Converts all key events in the deque to the oem char data and adds
+// - Converts all key events in the vector to the oem char data and adds
 // them back to events.
 // Arguments:
-// - events - on input the IInputEvents to convert. on output, the
-// converted input events
+// - events - on input the input records to convert. on output, the
+// converted input records
 // Note: may throw on error
-void SplitToOem(std::deque<std::unique_ptr<IInputEvent>>& events)
+void SplitToOem(std::vector<INPUT_RECORD>& events)
 {
     const UINT codepage = ServiceLocator::LocateGlobals().getConsoleInformation().CP;
 
     // convert events to oem codepage
-    std::deque<std::unique_ptr<IInputEvent>> convertedEvents;
-    while (!events.empty())
+    std::vector<INPUT_RECORD> convertedEvents;
+    convertedEvents.reserve(events.size());
+    for (const auto& currentEvent : events)
     {
-        std::unique_ptr<IInputEvent> currentEvent = std::move(events.front());
-        events.pop_front();
-        if (currentEvent->EventType() == InputEventType::KeyEvent)
+        if (currentEvent.EventType == KEY_EVENT)
         {
-            const KeyEvent* const pKeyEvent = static_cast<const KeyEvent* const>(currentEvent.get());
             // convert from wchar to char
-            std::wstring wstr{ pKeyEvent->GetCharData() };
+            std::wstring wstr{ currentEvent.Event.KeyEvent.uChar.UnicodeChar };
             const auto str = ConvertToA(codepage, wstr);
 
             for (auto& ch : str)
             {
-                std::unique_ptr<KeyEvent> tempEvent = std::make_unique<KeyEvent>(*pKeyEvent);
-                tempEvent->SetCharData(ch);
-                convertedEvents.push_back(std::move(tempEvent));
+                INPUT_RECORD tempEvent = currentEvent;
+                tempEvent.Event.KeyEvent.uChar.UnicodeChar = ch;
+                convertedEvents.push_back(tempEvent);
             }
         }
         else
         {
-            convertedEvents.push_back(std::move(currentEvent));
+            convertedEvents.push_back(currentEvent);
         }
     }
     // move all events back
-    while (!convertedEvents.empty())
-    {
-        events.push_back(std::move(convertedEvents.front()));
-        convertedEvents.pop_front();
-    }
+    events.swap(convertedEvents);
 }
 
 // Routine Description:
@@ -253,7 +253,7 @@ void ScreenBufferSizeChange(const COORD coordNewSize)
 
     try
     {
-        gci.pInputBuffer->Write(std::make_unique<WindowBufferSizeEvent>(coordNewSize));
+        gci.pInputBuffer->Write(WindowBufferSizeEvent{ coordNewSize }.ToInputRecord());
     }
     catch (...)
     {
@@ -289,6 +289,125 @@ static void _ScrollScreen(SCREEN_INFORMATION& screenInfo, const Viewport& source
     render.TriggerRedraw(fill);
 }
 
+// Routine Description:
+// - Reports the pending run of scrolls of the given buffer, if any, to
+//   accessibility and the renderers as if it had been a single scroll over
+//   the whole distance.
+// Arguments:
+// - screenInfo - The screen buffer whose scrolls are reported.
+// Return Value:
+// - <none>
+static void _FlushPendingScroll(SCREEN_INFORMATION& screenInfo) noexcept
+try
+{
+    auto& pendingScroll = screenInfo.GetPendingScroll();
+    if (!pendingScroll)
+    {
+        return;
+    }
+
+    const auto pending = *pendingScroll;
+    pendingScroll.reset();
+
+    // The buffer may have been resized since the scrolls happened.
+    const auto fill = Viewport::Intersect(pending.fill, screenInfo.GetBufferSize());
+    if (!fill.IsValid())
+    {
+        return;
+    }
+
+    const auto target = Viewport::Intersect(fill, Viewport::Offset(fill, { 0, pending.delta }));
+    if (target.IsValid())
+    {
+        const auto source = Viewport::Offset(target, { 0, gsl::narrow_cast<SHORT>(-pending.delta) });
+        _ScrollScreen(screenInfo, source, fill, target);
+    }
+    else
+    {
+        // Everything in the region was scrolled out of it.
+        screenInfo.GetRenderTarget().TriggerRedraw(fill);
+    }
+}
+CATCH_LOG()
+
+// Routine Description:
+// - Notifies accessibility and the renderers of a scroll, like _ScrollScreen.
+// - While a scroll batch is open, consecutive vertical scrolls of the same region
+//   of the active buffer (e.g. a line feed at the bottom margin, once per line)
+//   are merged and only reported once the run ends.
+// Arguments:
+// - screenInfo - The relevant screen buffer where data was moved
+// - source - The viewport describing the region where data was copied from
+// - fill - The viewport describing the area that was filled in with the fill character (uncovered area)
+// - target - The viewport describing the region where data was copied to
+static void _NotifyScroll(SCREEN_INFORMATION& screenInfo, const Viewport& source, const Viewport& fill, const Viewport& target)
+{
+    const CONSOLE_INFORMATION& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
+    const auto delta = gsl::narrow_cast<SHORT>(target.Top() - source.Top());
+    const bool batchable = gci.ScrollBatchDepth > 0 &&
+                           screenInfo.IsActiveScreenBuffer() &&
+                           delta != 0 &&
+                           target.Left() == source.Left() &&
+                           fill.IsInBounds(target);
+
+    // A scroll of another region, or in the other direction, ends the current run.
+    auto& pendingScroll = screenInfo.GetPendingScroll();
+    if (pendingScroll &&
+        (!batchable ||
+         pendingScroll->fill != fill ||
+         (pendingScroll->delta < 0) != (delta < 0)))
+    {
+        _FlushPendingScroll(screenInfo);
+    }
+
+    if (!batchable)
+    {
+        _ScrollScreen(screenInfo, source, fill, target);
+        return;
+    }
+
+    if (!pendingScroll)
+    {
+        pendingScroll = SCREEN_INFORMATION::PendingScroll{ fill, 0 };
+    }
+
+    // Scrolling further than the height of the region just clears it.
+    const int height = fill.Height();
+    pendingScroll->delta = gsl::narrow_cast<SHORT>(std::clamp(pendingScroll->delta + delta, -height, height));
+}
+
+// Routine Description:
+// - Opens a scroll batch. Until the matching EndScrollBatch, consecutive scrolls
+//   of the same region are reported to accessibility and the renderers once,
+//   instead of once per scroll.
+// - Batches can be nested. Console lock must be held.
+// Arguments:
+// - <none>
+// Return Value:
+// - <none>
+void BeginScrollBatch() noexcept
+{
+    CONSOLE_INFORMATION& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
+    ++gci.ScrollBatchDepth;
+}
+
+// Routine Description:
+// - Closes a scroll batch opened by BeginScrollBatch, reporting any scrolls
+//   that are still pending when the outermost batch is closed.
+// Arguments:
+// - <none>
+// Return Value:
+// - <none>
+void EndScrollBatch() noexcept
+{
+    CONSOLE_INFORMATION& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
+    if (gci.ScrollBatchDepth > 0 && --gci.ScrollBatchDepth == 0 && gci.HasActiveOutputBuffer())
+    {
+        // Only the active buffer can have scrolls pending, see SetActiveScreenBuffer.
+        _FlushPendingScroll(gci.GetActiveOutputBuffer());
+    }
+}
+
 // Routine Description:
 // - This routine is a special-purpose scroll for use by AdjustCursorPosition.
 // Arguments:
@@ -434,7 +553,7 @@ void ScrollRegion(SCREEN_INFORMATION& screenInfo,
         _CopyRectangle(screenInfo, source, target.Origin());
 
         // Notify the renderer and accessibility as to what moved and where.
-        _ScrollScreen(screenInfo, source, fill, target);
+        _NotifyScroll(screenInfo, source, fill, target);
     }
 
     // ------ 6. FILL ------
@@ -464,6 +583,14 @@ void ScrollRegion(SCREEN_INFORMATION& screenInfo,
 void SetActiveScreenBuffer(SCREEN_INFORMATION& screenInfo)
 {
     CONSOLE_INFORMATION& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
+
+    // Scrolls that are still pending belong to the buffer we're switching away
+    // from. They needn't be reported, since the new buffer is drawn in full below.
+    if (gci.HasActiveOutputBuffer())
+    {
+        gci.GetActiveOutputBuffer().GetPendingScroll().reset();
+    }
+
     gci.pCurrentScreenBuffer = &screenInfo;
 
     // initialize cursor GH#4102 - Typically, the cursor is set to on by the
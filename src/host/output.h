@@ -49,5 +49,8 @@ VOID SetConsoleWindowOwner(const HWND hwnd, _Inout_opt_ ConsoleProcessHandle* pP
 
 bool StreamScrollRegion(SCREEN_INFORMATION& screenInfo);
 
+void BeginScrollBatch() noexcept;
+void EndScrollBatch() noexcept;
+
 // For handling process handle state, not the window state itself.
 void CloseConsoleProcessState();
@@ -114,6 +114,25 @@ bool ConhostInternalGetSet::GetConsoleScreenBufferInfoEx(CONSOLE_SCREEN_BUFFER_I
     return true;
 }
 
+// Method Description:
+// - Retrieves the buffer size, cursor position and viewport of the active
+//   screen buffer. This is what most VT sequences need to know, and it's a lot
+//   cheaper than GetConsoleScreenBufferInfoEx, which also copies the color
+//   table and calculates the maximum window size.
+// Arguments:
+// - state - Receives the buffer state. The viewport is exclusive, like the
+//   srWindow returned by GetConsoleScreenBufferInfoEx.
+// Return Value:
+// - true if successful. false otherwise.
+bool ConhostInternalGetSet::PrivateGetBufferState(BufferState& state) const
+{
+    const auto& screenInfo = _io.GetActiveOutputBuffer().GetActiveBuffer();
+    state.size = screenInfo.GetBufferSize().Dimensions();
+    state.cursorPosition = screenInfo.GetTextBuffer().GetCursor().GetPosition();
+    state.viewport = screenInfo.GetViewport().ToExclusive();
+    return true;
+}
+
 // Routine Description:
 // - Connects the SetConsoleScreenBufferInfoEx API call directly into our Driver Message servicing call inside Conhost.exe
 // Arguments:
@@ -224,6 +243,21 @@ bool ConhostInternalGetSet::PrivateWriteConsoleInputW(std::deque<std::unique_ptr
                                                     true)); // append
 }
 
+// Routine Description:
+// - Types the given text into the input buffer, the same way it would be
+//   typed by PrivateWriteConsoleInputW given one key down and up per character.
+// Arguments:
+// - text - the text to be written to the input buffer
+// - eventsWritten - on output, the number of events written
+// Return Value:
+// - true if successful. false otherwise.
+bool ConhostInternalGetSet::PrivateWriteConsoleInputString(const std::wstring_view text,
+                                                           size_t& eventsWritten)
+{
+    eventsWritten = _io.GetActiveInputBuffer()->WriteString(text);
+    return true;
+}
+
 // Routine Description:
 // - Connects the SetConsoleWindowInfo API call directly into our Driver Message servicing call inside Conhost.exe
 // Arguments:
@@ -55,6 +55,7 @@ public:
     ConhostInternalGetSet(_In_ Microsoft::Console::IIoProvider& io);
 
     bool GetConsoleScreenBufferInfoEx(CONSOLE_SCREEN_BUFFER_INFOEX& screenBufferInfo) const override;
+    bool PrivateGetBufferState(BufferState& state) const override;
     bool SetConsoleScreenBufferInfoEx(const CONSOLE_SCREEN_BUFFER_INFOEX& screenBufferInfo) override;
 
     bool SetConsoleCursorPosition(const COORD position) override;
@@ -68,6 +69,8 @@ public:
 
     bool PrivateWriteConsoleInputW(std::deque<std::unique_ptr<IInputEvent>>& events,
                                    size_t& eventsWritten) override;
+    bool PrivateWriteConsoleInputString(const std::wstring_view text,
+                                        size_t& eventsWritten) override;
 
     bool SetConsoleWindowInfo(bool const absolute,
                               const SMALL_RECT& window) override;
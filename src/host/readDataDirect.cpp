@@ -25,7 +25,7 @@
 DirectReadData::DirectReadData(_In_ InputBuffer* const pInputBuffer,
                                _In_ INPUT_READ_HANDLE_DATA* const pInputReadHandleData,
                                const size_t eventReadCount,
-                               _In_ std::deque<std::unique_ptr<IInputEvent>> partialEvents) :
+                               _In_ std::vector<INPUT_RECORD> partialEvents) :
     ReadData(pInputBuffer, pInputReadHandleData),
     _eventReadCount{ eventReadCount },
     _partialEvents{ std::move(partialEvents) },
@@ -58,9 +58,8 @@ DirectReadData::~DirectReadData()
 // - pNumBytes - not used
 // - pControlKeyState - For certain types of reads, this specifies
 // which modifier keys were held.
-// - pOutputData - a pointer to a
-// std::deque<std::unique_ptr<IInputEvent>> that is used to the read
-// input events back to the server
+// - pOutputData - a pointer to a std::vector<INPUT_RECORD> that is
+// used to the read input events back to the server
 // Return Value:
 // - true if the wait is done and result buffer/status code can be sent back to the client.
 // - false if we need to continue to wait until more data is available.
@@ -82,7 +81,7 @@ bool DirectReadData::Notify(const WaitTerminationReason TerminationReason,
     *pControlKeyState = 0;
     *pNumBytes = 0;
     bool retVal = true;
-    std::deque<std::unique_ptr<IInputEvent>> readEvents;
+    std::vector<INPUT_RECORD> readEvents;
 
     // If ctrl-c or ctrl-break was seen, ignore it.
     if (WI_IsAnyFlagSet(TerminationReason, (WaitTerminationReason::CtrlC | WaitTerminationReason::CtrlBreak)))
@@ -95,7 +94,7 @@ bool DirectReadData::Notify(const WaitTerminationReason TerminationReason,
         _pInputBuffer->IsReadPartialByteSequenceAvailable() &&
         _eventReadCount == 1)
     {
-        _partialEvents.push_back(_pInputBuffer->FetchReadPartialByteSequence(false));
+        _partialEvents.push_back(_pInputBuffer->FetchReadPartialByteSequence(false)->ToInputRecord());
     }
 
     // See if called by CsrDestroyProcess or CsrDestroyThread
@@ -158,35 +157,24 @@ bool DirectReadData::Notify(const WaitTerminationReason TerminationReason,
         }
 
         // combine partial and whole events
-        while (!_partialEvents.empty())
-        {
-            readEvents.push_front(std::move(_partialEvents.back()));
-            _partialEvents.pop_back();
-        }
+        readEvents.insert(readEvents.begin(), _partialEvents.begin(), _partialEvents.end());
+        _partialEvents.clear();
 
         // move read events to out storage
-        for (size_t i = 0; i < _eventReadCount; ++i)
-        {
-            if (readEvents.empty())
-            {
-                break;
-            }
-            _outEvents.push_back(std::move(readEvents.front()));
-            readEvents.pop_front();
-        }
+        const auto amountToMove = std::min(_eventReadCount, readEvents.size());
+        _outEvents.insert(_outEvents.end(), readEvents.begin(), readEvents.begin() + amountToMove);
 
         // store partial event if necessary
-        if (!readEvents.empty())
+        if (amountToMove < readEvents.size())
         {
-            _pInputBuffer->StoreReadPartialByteSequence(std::move(readEvents.front()));
-            readEvents.pop_front();
-            FAIL_FAST_IF(!(readEvents.empty()));
+            FAIL_FAST_IF(readEvents.size() - amountToMove != 1);
+            _pInputBuffer->StoreReadPartialByteSequence(IInputEvent::Create(readEvents.back()));
         }
 
         // move events to pOutputData
-        std::deque<std::unique_ptr<IInputEvent>>* const pOutputDeque = reinterpret_cast<std::deque<std::unique_ptr<IInputEvent>>* const>(pOutputData);
+        std::vector<INPUT_RECORD>* const pOutputRecords = reinterpret_cast<std::vector<INPUT_RECORD>* const>(pOutputData);
         *pNumBytes = _outEvents.size() * sizeof(INPUT_RECORD);
-        pOutputDeque->swap(_outEvents);
+        pOutputRecords->swap(_outEvents);
     }
     return retVal;
 }
@@ -25,8 +25,7 @@ Revision History:
 
 #include "readData.hpp"
 #include "../types/inc/IInputEvent.hpp"
-#include <deque>
-#include <memory>
+#include <vector>
 
 class DirectReadData final : public ReadData
 {
@@ -34,7 +33,7 @@ public:
     DirectReadData(_In_ InputBuffer* const pInputBuffer,
                    _In_ INPUT_READ_HANDLE_DATA* const pInputReadHandleData,
                    const size_t eventReadCount,
-                   _In_ std::deque<std::unique_ptr<IInputEvent>> partialEvents);
+                   _In_ std::vector<INPUT_RECORD> partialEvents);
 
     DirectReadData(DirectReadData&&) = default;
 
@@ -50,6 +49,6 @@ public:
 
 private:
     const size_t _eventReadCount;
-    std::deque<std::unique_ptr<IInputEvent>> _partialEvents;
-    std::deque<std::unique_ptr<IInputEvent>> _outEvents;
+    std::vector<INPUT_RECORD> _partialEvents;
+    std::vector<INPUT_RECORD> _outEvents;
 };
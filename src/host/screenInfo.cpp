@@ -51,6 +51,7 @@ SCREEN_INFORMATION::SCREEN_INFORMATION(
     _viewport(Viewport::Empty()),
     _psiAlternateBuffer{ nullptr },
     _psiMainBuffer{ nullptr },
+    _psiSpareAltBuffer{ nullptr },
     _rcAltSavedClientNew{ 0 },
     _rcAltSavedClientOld{ 0 },
     _fAltWindowChanged{ false },
@@ -59,7 +60,8 @@ SCREEN_INFORMATION::SCREEN_INFORMATION(
     _renderTarget{ *this },
     _currentFont{ fontInfo },
     _desiredFont{ fontInfo },
-    _ignoreLegacyEquivalentVTAttributes{ false }
+    _ignoreLegacyEquivalentVTAttributes{ false },
+    _pendingScroll{ std::nullopt }
 {
     // Check if VT mode is enabled. Note that this can be true w/o calling
     // SetConsoleMode, if VirtualTerminalLevel is set to !=0 in the registry.
@@ -199,13 +201,28 @@ void SCREEN_INFORMATION::s_InsertScreenBuffer(_In_ SCREEN_INFORMATION* const pSc
 }
 
 // Routine Description:
-// - This routine removes the screen buffer pointer from the console's list of screen buffers.
+// - This routine removes the screen buffer pointer from the console's list of
+//   screen buffers, and deletes the screen buffer.
 // Arguments:
 // - ScreenInfo - Pointer to screen information structure.
 // Return Value:
 // Note:
 // - The console lock must be held when calling this routine.
 void SCREEN_INFORMATION::s_RemoveScreenBuffer(_In_ SCREEN_INFORMATION* const pScreenInfo)
+{
+    s_UnlinkScreenBuffer(pScreenInfo);
+    delete pScreenInfo;
+}
+
+// Routine Description:
+// - This routine removes the screen buffer pointer from the console's list of
+//   screen buffers, without deleting it.
+// Arguments:
+// - ScreenInfo - Pointer to screen information structure.
+// Return Value:
+// Note:
+// - The console lock must be held when calling this routine.
+void SCREEN_INFORMATION::s_UnlinkScreenBuffer(_In_ SCREEN_INFORMATION* const pScreenInfo)
 {
     CONSOLE_INFORMATION& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
     if (pScreenInfo == gci.ScreenBuffers)
@@ -243,8 +260,6 @@ void SCREEN_INFORMATION::s_RemoveScreenBuffer(_In_ SCREEN_INFORMATION* const pSc
             gci.pCurrentScreenBuffer = nullptr;
         }
     }
-
-    delete pScreenInfo;
 }
 
 #pragma endregion
@@ -285,6 +300,10 @@ void SCREEN_INFORMATION::_FreeOutputStateMachine()
             s_RemoveScreenBuffer(_psiAlternateBuffer);
         }
 
+        // The spare isn't in the list of screen buffers anymore.
+        delete _psiSpareAltBuffer;
+        _psiSpareAltBuffer = nullptr;
+
         _stateMachine.reset();
     }
 }
@@ -1895,13 +1914,39 @@ const SCREEN_INFORMATION& SCREEN_INFORMATION::GetMainBuffer() const
     auto initAttributes = GetAttributes();
     initAttributes.SetStandardErase();
 
-    NTSTATUS Status = SCREEN_INFORMATION::CreateInstance(WindowSize,
-                                                         existingFont,
-                                                         WindowSize,
-                                                         initAttributes,
-                                                         GetPopupAttributes(),
-                                                         Cursor::CURSOR_SMALL_SIZE,
-                                                         ppsiNewScreenBuffer);
+    // Applications like pagers and editors enter and leave the alternate
+    // buffer all the time. If the last one we had is still the right size,
+    // clear it out instead of allocating all of its rows again.
+    SCREEN_INFORMATION* const psiSpare = std::exchange(GetMainBuffer()._psiSpareAltBuffer, nullptr);
+
+    NTSTATUS Status;
+    if (psiSpare != nullptr && psiSpare->GetBufferSize().Dimensions() == WindowSize)
+    {
+        Status = psiSpare->_ResetForReuse(existingFont,
+                                          initAttributes,
+                                          GetPopupAttributes(),
+                                          Cursor::CURSOR_SMALL_SIZE);
+        if (NT_SUCCESS(Status))
+        {
+            *ppsiNewScreenBuffer = psiSpare;
+        }
+        else
+        {
+            delete psiSpare;
+        }
+    }
+    else
+    {
+        delete psiSpare;
+        Status = SCREEN_INFORMATION::CreateInstance(WindowSize,
+                                                    existingFont,
+                                                    WindowSize,
+                                                    initAttributes,
+                                                    GetPopupAttributes(),
+                                                    Cursor::CURSOR_SMALL_SIZE,
+                                                    ppsiNewScreenBuffer);
+    }
+
     if (NT_SUCCESS(Status))
     {
         // Update the alt buffer's cursor style to match our own.
@@ -1921,6 +1966,80 @@ const SCREEN_INFORMATION& SCREEN_INFORMATION::GetMainBuffer() const
     return Status;
 }
 
+// Routine Description:
+// - Puts an alternate buffer that's no longer in use back into the state
+//     CreateInstance leaves a new one in, keeping its text buffer and the
+//     storage of its rows. Alternate buffers are the size of the viewport,
+//     so this only costs as much as clearing the viewport.
+// Arguments:
+// - fontInfo - the font the buffer would be created with.
+// - defaultAttributes - the attributes the text buffer would be created with.
+// - popupAttributes - the popup attributes the buffer would be created with.
+// - uiCursorSize - the cursor size the buffer would be created with.
+// Return value:
+// - STATUS_SUCCESS if handled successfully. Otherwise, an appropriate status code indicating the error.
+[[nodiscard]] NTSTATUS SCREEN_INFORMATION::_ResetForReuse(const FontInfo& fontInfo,
+                                                          const TextAttribute defaultAttributes,
+                                                          const TextAttribute popupAttributes,
+                                                          const UINT uiCursorSize)
+{
+    try
+    {
+        const auto& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
+
+        OutputMode = ENABLE_PROCESSED_OUTPUT | ENABLE_WRAP_AT_EOL_OUTPUT;
+        if (gci.GetVirtTermLevel() != 0)
+        {
+            OutputMode |= ENABLE_VIRTUAL_TERMINAL_PROCESSING;
+        }
+        ResizingWindow = 0;
+        WheelDelta = 0;
+        HWheelDelta = 0;
+        WriteConsoleDbcsLeadByte[0] = 0;
+        WriteConsoleDbcsLeadByte[1] = 0;
+        FillOutDbcsLeadChar = 0;
+        ScrollScale = 1ul;
+        _scrollMargins = Viewport::FromCoord({ 0 });
+        _rcAltSavedClientNew = { 0 };
+        _rcAltSavedClientOld = { 0 };
+        _fAltWindowChanged = false;
+        _PopupAttributes = popupAttributes;
+        _currentFont = fontInfo;
+        _desiredFont = FontInfoDesired{ fontInfo };
+        _ignoreLegacyEquivalentVTAttributes = false;
+
+        _viewport = Viewport::FromDimensions({ 0, 0 }, GetBufferSize().Dimensions());
+        UpdateBottom();
+
+        _textBuffer->ResetToDefaults(defaultAttributes, uiCursorSize);
+        _textBuffer->GetCursor().SetColor(gci.GetCursorColor());
+        _textBuffer->GetCursor().SetType(gci.GetCursorType());
+    }
+    catch (...)
+    {
+        return NTSTATUS_FROM_HRESULT(wil::ResultFromCaughtException());
+    }
+
+    // Like a new buffer, we aren't attached to a main buffer until
+    // _CreateAltBuffer hands us its state machine.
+    _psiMainBuffer = nullptr;
+    return STATUS_SUCCESS;
+}
+
+// Routine Description:
+// - Takes an alternate buffer of this main buffer that's no longer in use out
+//     of the list of screen buffers, and keeps it for the next time we need
+//     an alternate buffer. The one we kept before is deleted.
+// Parameters:
+// - psiAltBuffer - the alternate buffer to retire.
+// Return value:
+// - <none>
+void SCREEN_INFORMATION::_RetireAltBuffer(_In_ SCREEN_INFORMATION* const psiAltBuffer)
+{
+    s_UnlinkScreenBuffer(psiAltBuffer);
+    delete std::exchange(_psiSpareAltBuffer, psiAltBuffer);
+}
+
 // Routine Description:
 // - Creates an "alternate" screen buffer for this buffer. In virtual terminals, there exists both a "main"
 //     screen buffer and an alternate. ASBSET creates a new alternate, and switches to it. If there is an already
@@ -1954,7 +2073,7 @@ const SCREEN_INFORMATION& SCREEN_INFORMATION::GetMainBuffer() const
 
         if (psiOldAltBuffer != nullptr)
         {
-            s_RemoveScreenBuffer(psiOldAltBuffer); // this will also delete the old alt buffer
+            siMain._RetireAltBuffer(psiOldAltBuffer);
         }
 
         ::SetActiveScreenBuffer(*psiNewAltBuffer);
@@ -1995,8 +2114,7 @@ void SCREEN_INFORMATION::UseMainScreenBuffer()
 
         SCREEN_INFORMATION* psiAlt = psiMain->_psiAlternateBuffer;
         psiMain->_psiAlternateBuffer = nullptr;
-        s_RemoveScreenBuffer(psiAlt); // this will also delete the alt buffer
-        // deleting the alt buffer will give the GetSet back to its main
+        psiMain->_RetireAltBuffer(psiAlt); // this keeps the alt buffer for the next UseAlternateScreenBuffer
 
         // Tell the VT MouseInput handler that we're in the main buffer now
         gci.GetActiveInputBuffer()->GetTerminalInput().UseMainScreenBuffer();
@@ -2730,3 +2848,15 @@ void SCREEN_INFORMATION::ResetIgnoreLegacyEquivalentVTAttributes() noexcept
 {
     _ignoreLegacyEquivalentVTAttributes = false;
 }
+
+// Routine Description:
+// - Gets the run of scrolls of this buffer whose notifications are still held
+//   back by an open scroll batch, if any. Only the active buffer has one.
+// Arguments:
+// - <none>
+// Return Value:
+// - The pending run, which output.cpp adds to, reports and clears.
+std::optional<SCREEN_INFORMATION::PendingScroll>& SCREEN_INFORMATION::GetPendingScroll() noexcept
+{
+    return _pendingScroll;
+}
@@ -241,6 +241,16 @@ public:
     void SetIgnoreLegacyEquivalentVTAttributes() noexcept;
     void ResetIgnoreLegacyEquivalentVTAttributes() noexcept;
 
+    // A run of scrolls of the same region whose notifications are being held
+    // back while a scroll batch is open. See BeginScrollBatch.
+    struct PendingScroll
+    {
+        Microsoft::Console::Types::Viewport fill;
+        SHORT delta;
+    };
+
+    std::optional<PendingScroll>& GetPendingScroll() noexcept;
+
 private:
     SCREEN_INFORMATION(_In_ Microsoft::Console::Interactivity::IWindowMetrics* pMetrics,
                        _In_ Microsoft::Console::Interactivity::IAccessibilityNotifier* pNotifier,
@@ -271,6 +281,12 @@ private:
     void _FreeOutputStateMachine();
 
     [[nodiscard]] NTSTATUS _CreateAltBuffer(_Out_ SCREEN_INFORMATION** const ppsiNewScreenBuffer);
+    [[nodiscard]] NTSTATUS _ResetForReuse(const FontInfo& fontInfo,
+                                          const TextAttribute defaultAttributes,
+                                          const TextAttribute popupAttributes,
+                                          const UINT uiCursorSize);
+    void _RetireAltBuffer(_In_ SCREEN_INFORMATION* const psiAltBuffer);
+    static void s_UnlinkScreenBuffer(_In_ SCREEN_INFORMATION* const pScreenInfo);
 
     bool _IsAltBuffer() const;
     bool _IsInPtyMode() const;
@@ -286,6 +302,7 @@ private:
 
     SCREEN_INFORMATION* _psiAlternateBuffer; // The VT "Alternate" screen buffer.
     SCREEN_INFORMATION* _psiMainBuffer; // A pointer to the main buffer, if this is the alternate buffer.
+    SCREEN_INFORMATION* _psiSpareAltBuffer; // The last alternate buffer of this main buffer, kept for reuse. Not in the list of screen buffers.
 
     RECT _rcAltSavedClientNew;
     RECT _rcAltSavedClientOld;
@@ -305,6 +322,8 @@ private:
 
     bool _ignoreLegacyEquivalentVTAttributes;
 
+    std::optional<PendingScroll> _pendingScroll;
+
 #ifdef UNIT_TESTING
     friend class TextBufferIteratorTests;
     friend class ScreenBufferTests;
@@ -23,6 +23,7 @@ Revision History:
 #include "conimeinfo.h"
 #include "VtIo.hpp"
 #include "CursorBlinker.hpp"
+#include "ConsoleLockProfiler.hpp"
 
 #include "../server/ProcessList.h"
 #include "../server/WaitQueue.h"
@@ -99,17 +100,23 @@ public:
     ULONG CtrlFlags; // indicates outstanding ctrl requests
     ULONG LimitingProcessId;
 
+    size_t ScrollBatchDepth; // the number of open scroll batches, see BeginScrollBatch
+
     CPINFO CPInfo;
     CPINFO OutputCPInfo;
 
     ConsoleImeInfo ConsoleIme;
 
     void LockConsole();
+    void LockConsoleFrom(const void* const callSite);
     bool TryLockConsole();
     void UnlockConsole();
     bool IsConsoleLocked() const;
     ULONG GetCSRecursionCount();
 
+    Microsoft::Console::ConsoleLockProfiler* GetLockProfiler() const noexcept;
+    void SetLockProfiler(std::unique_ptr<Microsoft::Console::ConsoleLockProfiler> profiler) noexcept;
+
     Microsoft::Console::VirtualTerminal::VtIo* GetVtIo();
 
     SCREEN_INFORMATION& GetActiveOutputBuffer() override;
@@ -151,6 +158,7 @@ public:
 
 private:
     CRITICAL_SECTION _csConsoleLock; // serialize input and output using this
+    std::unique_ptr<Microsoft::Console::ConsoleLockProfiler> _lockProfiler; // null unless profiling the lock
     std::wstring _Title;
     std::wstring _Prefix; // Eg Select, Mark - things that we manually prepend to the title.
     std::wstring _TitleAndPrefix;
@@ -59,7 +59,10 @@ Settings::Settings() :
     _DefaultForeground(INVALID_COLOR),
     _DefaultBackground(INVALID_COLOR),
     _fUseDx(false),
-    _fCopyColor(false)
+    _fCopyColor(false),
+    _dwFrameRateLimit(0),
+    _dwFloodThreshold(0),
+    _dwFloodFrameRate(0)
 {
     _dwScreenBufferSize.X = 80;
     _dwScreenBufferSize.Y = 25;
@@ -835,3 +838,27 @@ bool Settings::GetCopyColor() const noexcept
 {
     return _fCopyColor;
 }
+
+// Routine Description:
+// - The most frames per second the renderer may paint. 0 leaves it at the
+//   renderer's default.
+DWORD Settings::GetFrameRateLimit() const noexcept
+{
+    return _dwFrameRateLimit;
+}
+
+// Routine Description:
+// - The paint requests per second after which the renderer considers itself
+//   flooded and drops to the flood frame rate. 0 turns flood detection off.
+DWORD Settings::GetFloodThreshold() const noexcept
+{
+    return _dwFloodThreshold;
+}
+
+// Routine Description:
+// - The frames per second the renderer paints while flooded. 0 leaves it at
+//   the renderer's default.
+DWORD Settings::GetFloodFrameRate() const noexcept
+{
+    return _dwFloodFrameRate;
+}
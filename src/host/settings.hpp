@@ -185,6 +185,10 @@ public:
     bool GetUseDx() const noexcept;
     bool GetCopyColor() const noexcept;
 
+    DWORD GetFrameRateLimit() const noexcept;
+    DWORD GetFloodThreshold() const noexcept;
+    DWORD GetFloodFrameRate() const noexcept;
+
 private:
     DWORD _dwHotKey;
     DWORD _dwStartupFlags;
@@ -228,6 +232,9 @@ private:
     bool _fScreenReversed;
     bool _fUseDx;
     bool _fCopyColor;
+    DWORD _dwFrameRateLimit; // 0 = the renderer's default
+    DWORD _dwFloodThreshold; // 0 = flood detection off
+    DWORD _dwFloodFrameRate; // 0 = the renderer's default
 
     std::array<COLORREF, XTERM_COLOR_TABLE_SIZE> _colorTable;
 
@@ -766,6 +766,11 @@ PWSTR TranslateConsoleTitle(_In_ PCWSTR pwszConsoleTitle, const BOOL fUnexpand,
 
         THROW_IF_FAILED(localPointerToThread->Initialize(g.pRender));
 
+        // Frame pacing stays at the renderer's defaults unless the registry
+        // says otherwise. Flood detection is off by default.
+        localPointerToThread->SetFrameRateLimit(gci.GetFrameRateLimit());
+        localPointerToThread->SetFloodMode(gci.GetFloodThreshold(), gci.GetFloodFrameRate());
+
         // Allow the renderer to paint.
         g.pRender->EnablePainting();
 
@@ -924,6 +929,10 @@ DWORD WINAPI ConsoleIoThread(LPVOID lpParameter)
             continue;
         }
 
+        // Each message is serviced on its own, under its own acquisition of
+        // the console lock. Servicing several under one lock would need a
+        // non-blocking read to find out whether more are waiting, and ConDrv
+        // only offers the blocking one above.
         IoSorter::ServiceIoOperation(&ReceiveMsg, &ReplyMsg);
     }
 
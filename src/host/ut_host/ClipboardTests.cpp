@@ -158,8 +158,8 @@ class ClipboardTests
     TEST_METHOD(CanConvertTextToInputEvents)
     {
         std::wstring wstr = L"hello world";
-        std::deque<std::unique_ptr<IInputEvent>> events = Clipboard::Instance().TextToKeyEvents(wstr.c_str(),
-                                                                                                wstr.size());
+        std::deque<std::unique_ptr<IInputEvent>> events = IInputEvent::Create(Clipboard::Instance().TextToKeyEvents(wstr.c_str(),
+                                                                                                                    wstr.size()));
         VERIFY_ARE_EQUAL(wstr.size() * 2, events.size());
         IInputServices* pInputServices = ServiceLocator::LocateInputServices();
         for (wchar_t wch : wstr)
@@ -194,8 +194,8 @@ class ClipboardTests
         {
             std::isupper(wch) ? ++uppercaseCount : 0;
         }
-        std::deque<std::unique_ptr<IInputEvent>> events = Clipboard::Instance().TextToKeyEvents(wstr.c_str(),
-                                                                                                wstr.size());
+        std::deque<std::unique_ptr<IInputEvent>> events = IInputEvent::Create(Clipboard::Instance().TextToKeyEvents(wstr.c_str(),
+                                                                                                                    wstr.size()));
 
         VERIFY_ARE_EQUAL((wstr.size() + uppercaseCount) * 2, events.size());
         IInputServices* pInputServices = ServiceLocator::LocateInputServices();
@@ -276,8 +276,8 @@ class ClipboardTests
             return;
         }
 
-        std::deque<std::unique_ptr<IInputEvent>> events = Clipboard::Instance().TextToKeyEvents(wstr.c_str(),
-                                                                                                wstr.size());
+        std::deque<std::unique_ptr<IInputEvent>> events = IInputEvent::Create(Clipboard::Instance().TextToKeyEvents(wstr.c_str(),
+                                                                                                                    wstr.size()));
 
         std::deque<KeyEvent> expectedEvents;
         // should be converted to:
@@ -304,8 +304,8 @@ class ClipboardTests
         const std::wstring wstr = L"\xbc"; // ¼ char U+00BC
         const UINT outputCodepage = CP_JAPANESE;
         ServiceLocator::LocateGlobals().getConsoleInformation().OutputCP = outputCodepage;
-        std::deque<std::unique_ptr<IInputEvent>> events = Clipboard::Instance().TextToKeyEvents(wstr.c_str(),
-                                                                                                wstr.size());
+        std::deque<std::unique_ptr<IInputEvent>> events = IInputEvent::Create(Clipboard::Instance().TextToKeyEvents(wstr.c_str(),
+                                                                                                                    wstr.size()));
 
         std::deque<KeyEvent> expectedEvents;
         if constexpr (Feature_UseNumpadEventsForClipboardInput::IsEnabled())
@@ -0,0 +1,113 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#include "precomp.h"
+#include "WexTestClass.h"
+#include "../../inc/consoletaeftemplates.hpp"
+
+#include "../../interactivity/inc/ServiceLocator.hpp"
+
+#include <thread>
+
+using namespace WEX::Common;
+using namespace WEX::Logging;
+using namespace WEX::TestExecution;
+using Microsoft::Console::ConsoleLockProfiler;
+using Microsoft::Console::Interactivity::ServiceLocator;
+
+class ConsoleLockProfilerTests
+{
+    TEST_CLASS(ConsoleLockProfilerTests);
+
+    TEST_METHOD_SETUP(MethodSetup)
+    {
+        auto& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
+        gci.SetLockProfiler(std::make_unique<ConsoleLockProfiler>());
+        return true;
+    }
+
+    TEST_METHOD_CLEANUP(MethodCleanup)
+    {
+        auto& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
+        gci.SetLockProfiler(nullptr);
+        return true;
+    }
+
+    // Finds the given thread in the report and returns the value of one of
+    // the fields of its "wait" or "hold" histogram.
+    static uint64_t ThreadStatistic(const std::string& json, const DWORD threadId, const std::string_view histogram, const std::string_view field)
+    {
+        const auto thread = json.find(fmt::format("{{\"id\":{},", threadId));
+        VERIFY_ARE_NOT_EQUAL(std::string::npos, thread, L"The thread should be in the report.");
+
+        const auto start = json.find(fmt::format("\"{}\":{{", histogram), thread);
+        VERIFY_ARE_NOT_EQUAL(std::string::npos, start);
+
+        const auto value = json.find(fmt::format("\"{}\":", field), start) + field.size() + 3;
+        return std::stoull(json.substr(value, json.find_first_not_of("0123456789", value) - value));
+    }
+
+    TEST_METHOD(OnlyOutermostAcquisitionIsMeasured)
+    {
+        auto& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
+
+        gci.LockConsole();
+        gci.LockConsole();
+        gci.UnlockConsole();
+        gci.UnlockConsole();
+
+        const auto json = gci.GetLockProfiler()->ToJson();
+        Log::Comment(NoThrowString().Format(L"%hs", json.c_str()));
+
+        const auto threadId = GetCurrentThreadId();
+        VERIFY_ARE_EQUAL(uint64_t{ 1 }, ThreadStatistic(json, threadId, "wait", "count"));
+        VERIFY_ARE_EQUAL(uint64_t{ 1 }, ThreadStatistic(json, threadId, "hold", "count"));
+        VERIFY_ARE_NOT_EQUAL(std::string::npos, json.find("\"sites\":[{\"site\":\""), L"The acquisition should have a call site.");
+    }
+
+    TEST_METHOD(HoldInProgressWhenInstalledIsIgnored)
+    {
+        auto& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
+
+        gci.SetLockProfiler(nullptr);
+        gci.LockConsole();
+        gci.SetLockProfiler(std::make_unique<ConsoleLockProfiler>());
+        gci.UnlockConsole();
+
+        VERIFY_ARE_EQUAL(std::string{ "{\"threads\":[],\"sites\":[]}" }, gci.GetLockProfiler()->ToJson());
+    }
+
+    TEST_METHOD(ContendedWaitIsAttributedToWaitingThread)
+    {
+        auto& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
+        constexpr DWORD holdMilliseconds = 50;
+
+        gci.LockConsole();
+
+        std::atomic<DWORD> waiterId{ 0 };
+        std::thread waiter{ [&]() {
+            waiterId = GetCurrentThreadId();
+            gci.LockConsole();
+            gci.UnlockConsole();
+        } };
+
+        // Give the other thread time to start waiting.
+        while (!waiterId)
+        {
+            Sleep(1);
+        }
+        Sleep(holdMilliseconds);
+
+        gci.UnlockConsole();
+        waiter.join();
+
+        const auto json = gci.GetLockProfiler()->ToJson();
+        Log::Comment(NoThrowString().Format(L"%hs", json.c_str()));
+
+        // Timer resolution makes sleeps imprecise, so only expect a part of it.
+        const uint64_t minimumNs = holdMilliseconds / 2 * 1'000'000;
+        VERIFY_IS_GREATER_THAN_OR_EQUAL(ThreadStatistic(json, waiterId, "wait", "sum"), minimumNs);
+        VERIFY_IS_GREATER_THAN_OR_EQUAL(ThreadStatistic(json, GetCurrentThreadId(), "hold", "sum"), minimumNs);
+        VERIFY_IS_LESS_THAN(ThreadStatistic(json, GetCurrentThreadId(), "wait", "sum"), minimumNs);
+    }
+};
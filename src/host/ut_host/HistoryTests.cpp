@@ -242,6 +242,79 @@ class HistoryTests
         VERIFY_ARE_EQUAL(2ul, history->GetNumberOfCommands());
     }
 
+    TEST_METHOD(FindMatchingCommandSearchesBackwardsAndWraps)
+    {
+        auto history = CommandHistory::s_Allocate(_manyApps[0], _MakeHandle(0));
+        VERIFY_IS_NOT_NULL(history);
+
+        VERIFY_SUCCEEDED(history->Add(L"dir", false));
+        VERIFY_SUCCEEDED(history->Add(L"cd ..", false));
+        VERIFY_SUCCEEDED(history->Add(L"DIR /w", false));
+        VERIFY_SUCCEEDED(history->Add(L"ping", false));
+        VERIFY_SUCCEEDED(history->Add(L"dir /p", false));
+
+        const auto find = [&](const std::wstring_view command, const SHORT startingIndex, const CommandHistory::MatchOptions options) {
+            SHORT index;
+            const auto found = history->FindMatchingCommand(command, startingIndex, index, options | CommandHistory::MatchOptions::JustLooking);
+            return found ? index : SHORT{ -1 };
+        };
+
+        Log::Comment(L"Prefixes match case-insensitively, starting before the given command.");
+        VERIFY_ARE_EQUAL(2, find(L"di", 3, CommandHistory::MatchOptions::None));
+        VERIFY_ARE_EQUAL(0, find(L"di", 2, CommandHistory::MatchOptions::None));
+
+        Log::Comment(L"Without a match before it, the search wraps around to the newest command.");
+        VERIFY_ARE_EQUAL(4, find(L"di", 0, CommandHistory::MatchOptions::None));
+        VERIFY_ARE_EQUAL(4, find(L"dir /", 1, CommandHistory::MatchOptions::None));
+
+        VERIFY_ARE_EQUAL(-1, find(L"dirt", 4, CommandHistory::MatchOptions::None));
+        VERIFY_ARE_EQUAL(-1, find(L"xyz", 4, CommandHistory::MatchOptions::None));
+
+        Log::Comment(L"Exact matches ignore case, but not length.");
+        VERIFY_ARE_EQUAL(2, find(L"dir /W", 4, CommandHistory::MatchOptions::ExactMatch));
+        VERIFY_ARE_EQUAL(0, find(L"DIR", 4, CommandHistory::MatchOptions::ExactMatch));
+        VERIFY_ARE_EQUAL(-1, find(L"dir /", 4, CommandHistory::MatchOptions::ExactMatch));
+    }
+
+    TEST_METHOD(FindMatchingCommandFollowsMovedCommands)
+    {
+        auto history = CommandHistory::s_Allocate(_manyApps[0], _MakeHandle(0));
+        VERIFY_IS_NOT_NULL(history);
+
+        for (UINT i = 0; i <= s_BufferSize; ++i)
+        {
+            VERIFY_SUCCEEDED(history->Add(fmt::format(L"cmd{}", i), false));
+        }
+
+        const auto find = [&](const std::wstring_view command, const SHORT startingIndex) {
+            SHORT index;
+            const auto found = history->FindMatchingCommand(command, startingIndex, index, CommandHistory::MatchOptions::ExactMatch | CommandHistory::MatchOptions::JustLooking);
+            return found ? index : SHORT{ -1 };
+        };
+
+        Log::Comment(L"The oldest command was dropped to make room for the newest.");
+        VERIFY_ARE_EQUAL(gsl::narrow<size_t>(s_BufferSize), history->GetNumberOfCommands());
+        VERIFY_ARE_EQUAL(-1, find(L"cmd0", 5));
+        VERIFY_ARE_EQUAL(0, find(L"cmd1", 5));
+        VERIFY_ARE_EQUAL(9, find(L"cmd10", 5));
+
+        Log::Comment(L"Swapped commands are found at their new positions.");
+        history->Swap(0, 9);
+        VERIFY_ARE_EQUAL(0, find(L"cmd10", 5));
+        VERIFY_ARE_EQUAL(9, find(L"cmd1", 5));
+
+        Log::Comment(L"Removed commands are gone and those after them move up.");
+        VERIFY_ARE_EQUAL(String(L"cmd10"), String(history->Remove(0).c_str()));
+        VERIFY_ARE_EQUAL(-1, find(L"cmd10", 5));
+        VERIFY_ARE_EQUAL(8, find(L"cmd1", 5));
+        VERIFY_ARE_EQUAL(0, find(L"cmd2", 5));
+
+        Log::Comment(L"Shrinking drops the newest commands.");
+        history->Realloc(3);
+        VERIFY_ARE_EQUAL(-1, find(L"cmd1", 1));
+        VERIFY_ARE_EQUAL(2, find(L"cmd4", 1));
+    }
+
 private:
     const std::array<std::wstring, 5> _manyApps = {
         L"foo.exe",
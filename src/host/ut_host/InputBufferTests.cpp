@@ -78,7 +78,7 @@ class InputBufferTests
             INPUT_RECORD record;
             record.EventType = MENU_EVENT;
             VERIFY_IS_GREATER_THAN(inputBuffer.Write(IInputEvent::Create(record)), 0u);
-            VERIFY_ARE_EQUAL(record, inputBuffer._storage.back()->ToInputRecord());
+            VERIFY_ARE_EQUAL(record, inputBuffer._storage.back());
         }
         VERIFY_ARE_EQUAL(inputBuffer.GetNumberOfReadyEvents(), RECORD_INSERT_COUNT);
     }
@@ -98,10 +98,80 @@ class InputBufferTests
         // verify that the events are the same in storage
         for (size_t i = 0; i < RECORD_INSERT_COUNT; ++i)
         {
-            VERIFY_ARE_EQUAL(inputBuffer._storage[i]->ToInputRecord(), record);
+            VERIFY_ARE_EQUAL(inputBuffer._storage[i], record);
         }
     }
 
+    TEST_METHOD(CanBulkWriteAndReadRecords)
+    {
+        Log::Comment(L"Records written and read in bulk must keep their order, also when the storage wraps around and grows");
+
+        InputBuffer inputBuffer;
+        std::vector<INPUT_RECORD> records;
+        for (unsigned int i = 0; i < 200; ++i)
+        {
+            records.push_back(MakeKeyEvent(TRUE, 1, static_cast<WCHAR>(L'A' + i % 26), 0, static_cast<WCHAR>(L'A' + i % 26), 0));
+        }
+
+        // Write and read in uneven amounts, so that the first write
+        // leaves a gap at the start of the storage to wrap into.
+        const gsl::span<const INPUT_RECORD> all{ records };
+        VERIFY_ARE_EQUAL(inputBuffer.Write(all.subspan(0, 50)), 50u);
+
+        std::vector<INPUT_RECORD> outRecords;
+        VERIFY_SUCCESS_NTSTATUS(inputBuffer.Read(outRecords, 30, false, false, true, false));
+        VERIFY_ARE_EQUAL(outRecords.size(), 30u);
+
+        VERIFY_ARE_EQUAL(inputBuffer.Write(all.subspan(50)), 150u);
+        VERIFY_ARE_EQUAL(inputBuffer.GetNumberOfReadyEvents(), 170u);
+
+        VERIFY_SUCCESS_NTSTATUS(inputBuffer.Read(outRecords, 500, false, false, true, false));
+        VERIFY_ARE_EQUAL(inputBuffer.GetNumberOfReadyEvents(), 0u);
+        VERIFY_ARE_EQUAL(outRecords.size(), records.size());
+        for (size_t i = 0; i < records.size(); ++i)
+        {
+            VERIFY_ARE_EQUAL(records[i], outRecords[i]);
+        }
+    }
+
+    TEST_METHOD(CanWriteString)
+    {
+        InputBuffer inputBuffer;
+
+        Log::Comment(L"Each character is typed with a key down and up");
+        VERIFY_ARE_EQUAL(inputBuffer.WriteString(L"ab"), 4u);
+        VERIFY_ARE_EQUAL(inputBuffer.GetNumberOfReadyEvents(), 4u);
+        VERIFY_IS_TRUE(inputBuffer._storage[0].Event.KeyEvent.bKeyDown);
+        VERIFY_ARE_EQUAL(inputBuffer._storage[0].Event.KeyEvent.uChar.UnicodeChar, L'a');
+        VERIFY_IS_FALSE(inputBuffer._storage[1].Event.KeyEvent.bKeyDown);
+        VERIFY_ARE_EQUAL(inputBuffer._storage[2].Event.KeyEvent.uChar.UnicodeChar, L'b');
+        inputBuffer.Flush();
+
+        Log::Comment(L"In VT input mode TerminalInput turns the key downs back into their characters");
+        WI_SetFlag(inputBuffer.InputMode, ENABLE_VIRTUAL_TERMINAL_INPUT);
+        VERIFY_ARE_EQUAL(inputBuffer.WriteString(L"ab"), 4u);
+        VERIFY_ARE_EQUAL(inputBuffer.GetNumberOfReadyEvents(), 4u);
+        VERIFY_ARE_EQUAL(inputBuffer._storage[0], MakeKeyEvent(TRUE, 1, 0, 0, L'a', 0));
+
+        Log::Comment(L"The key ups aren't handled by TerminalInput and are stored as they are");
+        VERIFY_IS_FALSE(inputBuffer._storage[1].Event.KeyEvent.bKeyDown);
+        VERIFY_ARE_EQUAL(inputBuffer._storage[1].Event.KeyEvent.uChar.UnicodeChar, L'a');
+        VERIFY_ARE_NOT_EQUAL(inputBuffer._storage[1].Event.KeyEvent.wVirtualKeyCode, 0);
+        VERIFY_ARE_EQUAL(inputBuffer._storage[2], MakeKeyEvent(TRUE, 1, 0, 0, L'b', 0));
+        VERIFY_IS_FALSE(inputBuffer._storage[3].Event.KeyEvent.bKeyDown);
+        inputBuffer.Flush();
+
+        Log::Comment(L"Modifier keys aren't handled by TerminalInput either");
+        VERIFY_ARE_EQUAL(inputBuffer.WriteString(L"A"), 4u);
+        VERIFY_ARE_EQUAL(inputBuffer.GetNumberOfReadyEvents(), 4u);
+        VERIFY_ARE_EQUAL(inputBuffer._storage[0].Event.KeyEvent.wVirtualKeyCode, VK_SHIFT);
+        VERIFY_IS_TRUE(inputBuffer._storage[0].Event.KeyEvent.bKeyDown);
+        VERIFY_ARE_EQUAL(inputBuffer._storage[1], MakeKeyEvent(TRUE, 1, 0, 0, L'A', 0));
+        VERIFY_IS_FALSE(inputBuffer._storage[2].Event.KeyEvent.bKeyDown);
+        VERIFY_ARE_EQUAL(inputBuffer._storage[3].Event.KeyEvent.wVirtualKeyCode, VK_SHIFT);
+        VERIFY_IS_FALSE(inputBuffer._storage[3].Event.KeyEvent.bKeyDown);
+    }
+
     TEST_METHOD(InputBufferCoalescesMouseEvents)
     {
         InputBuffer inputBuffer;
@@ -121,10 +191,9 @@ class InputBufferTests
         // check that they coalesced
         VERIFY_ARE_EQUAL(inputBuffer.GetNumberOfReadyEvents(), 1u);
         // check that the mouse position is being updated correctly
-        const IInputEvent* const pOutEvent = inputBuffer._storage.front().get();
-        const MouseEvent* const pMouseEvent = static_cast<const MouseEvent* const>(pOutEvent);
-        VERIFY_ARE_EQUAL(pMouseEvent->GetPosition().X, static_cast<SHORT>(RECORD_INSERT_COUNT));
-        VERIFY_ARE_EQUAL(pMouseEvent->GetPosition().Y, static_cast<SHORT>(RECORD_INSERT_COUNT * 2));
+        const auto& mouseEvent = inputBuffer._storage.front().Event.MouseEvent;
+        VERIFY_ARE_EQUAL(mouseEvent.dwMousePosition.X, static_cast<SHORT>(RECORD_INSERT_COUNT));
+        VERIFY_ARE_EQUAL(mouseEvent.dwMousePosition.Y, static_cast<SHORT>(RECORD_INSERT_COUNT * 2));
 
         // add a key event and another mouse event to make sure that
         // an event between two mouse events stopped the coalescing.
@@ -162,10 +231,10 @@ class InputBufferTests
         // no events should have been coalesced
         VERIFY_ARE_EQUAL(inputBuffer.GetNumberOfReadyEvents(), RECORD_INSERT_COUNT + 1);
         // check that the events stored match those inserted
-        VERIFY_ARE_EQUAL(inputBuffer._storage.front()->ToInputRecord(), mouseRecords[0]);
+        VERIFY_ARE_EQUAL(inputBuffer._storage.front(), mouseRecords[0]);
         for (size_t i = 0; i < RECORD_INSERT_COUNT; ++i)
         {
-            VERIFY_ARE_EQUAL(inputBuffer._storage[i + 1]->ToInputRecord(), mouseRecords[i]);
+            VERIFY_ARE_EQUAL(inputBuffer._storage[i + 1], mouseRecords[i]);
         }
     }
 
@@ -221,10 +290,10 @@ class InputBufferTests
         // no events should have been coalesced
         VERIFY_ARE_EQUAL(inputBuffer.GetNumberOfReadyEvents(), RECORD_INSERT_COUNT + 1);
         // check that the events stored match those inserted
-        VERIFY_ARE_EQUAL(inputBuffer._storage.front()->ToInputRecord(), keyRecords[0]);
+        VERIFY_ARE_EQUAL(inputBuffer._storage.front(), keyRecords[0]);
         for (size_t i = 0; i < RECORD_INSERT_COUNT; ++i)
         {
-            VERIFY_ARE_EQUAL(inputBuffer._storage[i + 1]->ToInputRecord(), keyRecords[i]);
+            VERIFY_ARE_EQUAL(inputBuffer._storage[i + 1], keyRecords[i]);
         }
     }
 
@@ -239,7 +308,7 @@ class InputBufferTests
         for (size_t i = 0; i < RECORD_INSERT_COUNT; ++i)
         {
             VERIFY_IS_GREATER_THAN(inputBuffer.Write(IInputEvent::Create(record)), 0u);
-            VERIFY_ARE_EQUAL(inputBuffer._storage.back()->ToInputRecord(), record);
+            VERIFY_ARE_EQUAL(inputBuffer._storage.back(), record);
         }
 
         // The events shouldn't be coalesced
@@ -382,10 +451,10 @@ class InputBufferTests
         VERIFY_IS_GREATER_THAN(inputBuffer.Write(inEvents), 0u);
 
         // read one record, make sure ResetWaitEvent isn't set
-        std::deque<std::unique_ptr<IInputEvent>> outEvents;
+        std::vector<INPUT_RECORD> outRecords;
         size_t eventsRead = 0;
         bool resetWaitEvent = false;
-        inputBuffer._ReadBuffer(outEvents,
+        inputBuffer._ReadBuffer(outRecords,
                                 1,
                                 eventsRead,
                                 false,
@@ -396,8 +465,8 @@ class InputBufferTests
         VERIFY_IS_FALSE(!!resetWaitEvent);
 
         // read the rest, resetWaitEvent should be set to true
-        outEvents.clear();
-        inputBuffer._ReadBuffer(outEvents,
+        outRecords.clear();
+        inputBuffer._ReadBuffer(outRecords,
                                 RECORD_INSERT_COUNT - 1,
                                 eventsRead,
                                 false,
@@ -431,10 +500,10 @@ class InputBufferTests
         VERIFY_IS_GREATER_THAN(inputBuffer.Write(inEvents), 0u);
 
         // read them out non-unicode style and compare
-        std::deque<std::unique_ptr<IInputEvent>> outEvents;
+        std::vector<INPUT_RECORD> outRecords;
         size_t eventsRead = 0;
         bool resetWaitEvent = false;
-        inputBuffer._ReadBuffer(outEvents,
+        inputBuffer._ReadBuffer(outRecords,
                                 recordInsertCount,
                                 eventsRead,
                                 false,
@@ -444,10 +513,10 @@ class InputBufferTests
         // the dbcs record should have counted for two elements in
         // the array, making it so that we get less events read
         VERIFY_ARE_EQUAL(eventsRead, recordInsertCount - 1);
-        VERIFY_ARE_EQUAL(eventsRead, outEvents.size());
+        VERIFY_ARE_EQUAL(eventsRead, outRecords.size());
         for (size_t i = 0; i < eventsRead; ++i)
         {
-            VERIFY_ARE_EQUAL(outEvents[i]->ToInputRecord(), inRecords[i]);
+            VERIFY_ARE_EQUAL(outRecords[i], inRecords[i]);
         }
     }
 
@@ -589,22 +658,17 @@ class InputBufferTests
     {
         InputBuffer inputBuffer;
         INPUT_RECORD record = MakeKeyEvent(true, 1, L'a', 0, L'a', 0);
-        std::unique_ptr<IInputEvent> inputEvent = IInputEvent::Create(record);
         size_t eventsWritten;
         bool waitEvent = false;
         inputBuffer.Flush();
         // write one event to an empty buffer
-        std::deque<std::unique_ptr<IInputEvent>> storage;
-        storage.push_back(std::move(inputEvent));
-        inputBuffer._WriteBuffer(storage, eventsWritten, waitEvent);
+        inputBuffer._WriteBuffer({ &record, 1 }, eventsWritten, waitEvent);
         VERIFY_IS_TRUE(waitEvent);
         // write another, it shouldn't signal this time
         INPUT_RECORD record2 = MakeKeyEvent(true, 1, L'b', 0, L'b', 0);
-        std::unique_ptr<IInputEvent> inputEvent2 = IInputEvent::Create(record2);
         // write another event to a non-empty buffer
         waitEvent = false;
-        storage.push_back(std::move(inputEvent2));
-        inputBuffer._WriteBuffer(storage, eventsWritten, waitEvent);
+        inputBuffer._WriteBuffer({ &record2, 1 }, eventsWritten, waitEvent);
 
         VERIFY_IS_FALSE(waitEvent);
     }
@@ -625,7 +689,7 @@ class InputBufferTests
                                                  true));
         VERIFY_ARE_EQUAL(outEvents.size(), 1u);
         VERIFY_ARE_EQUAL(inputBuffer._storage.size(), 1u);
-        VERIFY_ARE_EQUAL(static_cast<const KeyEvent&>(*inputBuffer._storage.front()).GetRepeatCount(), repeatCount - 1);
+        VERIFY_ARE_EQUAL(inputBuffer._storage.front().Event.KeyEvent.wRepeatCount, repeatCount - 1);
         VERIFY_ARE_EQUAL(static_cast<const KeyEvent&>(*outEvents.front()).GetRepeatCount(), 1u);
     }
 
@@ -645,7 +709,34 @@ class InputBufferTests
                                                  true));
         VERIFY_ARE_EQUAL(outEvents.size(), 1u);
         VERIFY_ARE_EQUAL(inputBuffer._storage.size(), 1u);
-        VERIFY_ARE_EQUAL(static_cast<const KeyEvent&>(*inputBuffer._storage.front()).GetRepeatCount(), repeatCount);
+        VERIFY_ARE_EQUAL(inputBuffer._storage.front().Event.KeyEvent.wRepeatCount, repeatCount);
         VERIFY_ARE_EQUAL(static_cast<const KeyEvent&>(*outEvents.front()).GetRepeatCount(), 1u);
     }
+
+    TEST_METHOD(SingleRecordStreamReadingDeCoalesces)
+    {
+        InputBuffer inputBuffer;
+        const WORD repeatCount = 2;
+        INPUT_RECORD record = MakeKeyEvent(true, repeatCount, L'a', 0, L'a', 0);
+        INPUT_RECORD outRecord;
+        bool recordRead;
+
+        VERIFY_ARE_EQUAL(inputBuffer.Write(record), 1u);
+        for (WORD i = 1; i <= repeatCount; ++i)
+        {
+            VERIFY_SUCCESS_NTSTATUS(inputBuffer.Read(outRecord, recordRead, false, false, true));
+            VERIFY_IS_TRUE(recordRead);
+            VERIFY_ARE_EQUAL(outRecord.Event.KeyEvent.wRepeatCount, 1u);
+            VERIFY_ARE_EQUAL(outRecord.Event.KeyEvent.uChar.UnicodeChar, L'a');
+            VERIFY_ARE_EQUAL(inputBuffer._storage.size(), static_cast<size_t>(repeatCount - i));
+        }
+
+        Log::Comment(L"Nothing is left to read, and we didn't ask to wait");
+        VERIFY_SUCCESS_NTSTATUS(inputBuffer.Read(outRecord, recordRead, false, false, true));
+        VERIFY_IS_FALSE(recordRead);
+
+        Log::Comment(L"Asking to wait on an empty buffer returns a wait status");
+        VERIFY_ARE_EQUAL(inputBuffer.Read(outRecord, recordRead, false, true, true), CONSOLE_STATUS_WAIT);
+        VERIFY_IS_FALSE(recordRead);
+    }
 };
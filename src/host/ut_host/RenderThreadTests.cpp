@@ -0,0 +1,145 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#include "precomp.h"
+#include "WexTestClass.h"
+#include "../../inc/consoletaeftemplates.hpp"
+
+#include "../../renderer/base/thread.hpp"
+
+using namespace WEX::Common;
+using namespace WEX::Logging;
+using namespace WEX::TestExecution;
+using namespace std::chrono_literals;
+
+namespace Microsoft::Console::Render
+{
+    class RenderThreadTests;
+};
+using namespace Microsoft::Console::Render;
+
+// These drive the frame pacing of a RenderThread that was never initialized,
+// so that no thread is running and every point in time is the test's choice.
+class Microsoft::Console::Render::RenderThreadTests
+{
+    TEST_CLASS(RenderThreadTests);
+
+    TEST_METHOD(FrameRateLimitSetsInterval)
+    {
+        RenderThread thread;
+        VERIFY_ARE_EQUAL(DWORD{ RenderThread::s_FrameLimitMilliseconds }, thread._GetFrameIntervalMilliseconds());
+
+        thread.SetFrameRateLimit(50);
+        VERIFY_ARE_EQUAL(20ul, thread._GetFrameIntervalMilliseconds());
+
+        Log::Comment(L"Rates above 1000 fps are capped at one frame per millisecond.");
+        thread.SetFrameRateLimit(5000);
+        VERIFY_ARE_EQUAL(1ul, thread._GetFrameIntervalMilliseconds());
+
+        thread.SetFrameRateLimit(0);
+        VERIFY_ARE_EQUAL(DWORD{ RenderThread::s_FrameLimitMilliseconds }, thread._GetFrameIntervalMilliseconds());
+    }
+
+    TEST_METHOD(FloodModeEntersAndLeaves)
+    {
+        RenderThread thread;
+        thread.SetFloodMode(1000, 20);
+
+        const auto start = std::chrono::steady_clock::now();
+        thread._sampleStart = start;
+
+        Log::Comment(L"Nothing is decided before a whole sample period passed.");
+        _NotifyPaint(thread, 500);
+        thread._UpdateFloodState(start + 50ms);
+        VERIFY_IS_FALSE(thread.GetFrameCounters().floodMode);
+
+        Log::Comment(L"500 requests in 100ms are 5000 per second, which is a flood.");
+        thread._UpdateFloodState(start + 100ms);
+        VERIFY_IS_TRUE(thread.GetFrameCounters().floodMode);
+        VERIFY_ARE_EQUAL(50ul, thread._GetFrameIntervalMilliseconds());
+
+        Log::Comment(L"500 per second is below the threshold, but not far enough below it to leave.");
+        _NotifyPaint(thread, 50);
+        thread._UpdateFloodState(start + 200ms);
+        VERIFY_IS_TRUE(thread.GetFrameCounters().floodMode);
+
+        Log::Comment(L"100 per second is less than a quarter of the threshold.");
+        _NotifyPaint(thread, 10);
+        thread._UpdateFloodState(start + 300ms);
+        VERIFY_IS_FALSE(thread.GetFrameCounters().floodMode);
+        VERIFY_ARE_EQUAL(DWORD{ RenderThread::s_FrameLimitMilliseconds }, thread._GetFrameIntervalMilliseconds());
+    }
+
+    TEST_METHOD(FloodDetectionCanBeTurnedOff)
+    {
+        RenderThread thread;
+        thread.SetFloodMode(1000, 0);
+
+        const auto start = std::chrono::steady_clock::now();
+        thread._sampleStart = start;
+
+        _NotifyPaint(thread, 500);
+        thread._UpdateFloodState(start + 100ms);
+        VERIFY_IS_TRUE(thread.GetFrameCounters().floodMode);
+        VERIFY_ARE_EQUAL(DWORD{ RenderThread::s_FloodFrameLimitMilliseconds }, thread._GetFrameIntervalMilliseconds());
+
+        thread.SetFloodMode(0, 0);
+        VERIFY_IS_FALSE(thread.GetFrameCounters().floodMode);
+
+        _NotifyPaint(thread, 500);
+        thread._UpdateFloodState(start + 200ms);
+        VERIFY_IS_FALSE(thread.GetFrameCounters().floodMode);
+    }
+
+    TEST_METHOD(CoalescedRequestsArentSkippedFrames)
+    {
+        RenderThread thread;
+
+        Log::Comment(L"Many requests painted by one frame at the normal cadence skip nothing.");
+        _NotifyPaint(thread, 100);
+        thread._CountFrame(std::chrono::steady_clock::now() + 8ms, RenderThread::s_FrameLimitMilliseconds);
+
+        const auto counters = thread.GetFrameCounters();
+        VERIFY_ARE_EQUAL(1ull, counters.framesPainted);
+        VERIFY_ARE_EQUAL(0ull, counters.framesSkipped);
+    }
+
+    TEST_METHOD(ThrottledFramesAreSkippedFrames)
+    {
+        RenderThread thread;
+        const auto start = std::chrono::steady_clock::now();
+
+        Log::Comment(L"A request that waited 100ms at the flood cadence could have been painted 12 times at the normal one.");
+        _NotifyPaint(thread, 1);
+        thread._pendingSince = start.time_since_epoch().count();
+        thread._CountFrame(start + 100ms, RenderThread::s_FloodFrameLimitMilliseconds);
+
+        auto counters = thread.GetFrameCounters();
+        VERIFY_ARE_EQUAL(1ull, counters.framesPainted);
+        VERIFY_ARE_EQUAL(12ull, counters.framesSkipped);
+
+        Log::Comment(L"Without a waiting request, the long sleep skipped nothing.");
+        thread._CountFrame(start + 200ms, RenderThread::s_FloodFrameLimitMilliseconds);
+
+        counters = thread.GetFrameCounters();
+        VERIFY_ARE_EQUAL(2ull, counters.framesPainted);
+        VERIFY_ARE_EQUAL(12ull, counters.framesSkipped);
+
+        Log::Comment(L"Only the time since the request counts, not the whole sleep.");
+        _NotifyPaint(thread, 1);
+        thread._pendingSince = (start + 280ms).time_since_epoch().count();
+        thread._CountFrame(start + 300ms, RenderThread::s_FloodFrameLimitMilliseconds);
+
+        counters = thread.GetFrameCounters();
+        VERIFY_ARE_EQUAL(3ull, counters.framesPainted);
+        VERIFY_ARE_EQUAL(14ull, counters.framesSkipped);
+    }
+
+    void _NotifyPaint(RenderThread& thread, const size_t count)
+    {
+        for (size_t i = 0; i < count; ++i)
+        {
+            thread.NotifyPaint();
+        }
+    }
+};
@@ -12,6 +12,7 @@
 #include "input.h"
 #include "getset.h"
 #include "_stream.h" // For WriteCharsLegacy
+#include "output.h" // For BeginScrollBatch
 
 #include "../interactivity/inc/ServiceLocator.hpp"
 #include "../../inc/conattrs.hpp"
@@ -89,6 +90,8 @@ class ScreenBufferTests
 
     TEST_METHOD(MultipleAlternateBuffersFromMainCreationTest);
 
+    TEST_METHOD(AlternateBufferIsReused);
+
     TEST_METHOD(TestReverseLineFeed);
 
     TEST_METHOD(TestResetClearTabStops);
@@ -174,6 +177,8 @@ class ScreenBufferTests
 
     TEST_METHOD(ScrollUpInMargins);
     TEST_METHOD(ScrollDownInMargins);
+    TEST_METHOD(BatchedLineFeedsInMargins);
+    TEST_METHOD(BatchedScrollOfInactiveBufferIsDropped);
     TEST_METHOD(InsertLinesInMargins);
     TEST_METHOD(DeleteLinesInMargins);
     TEST_METHOD(ReverseLineFeedInMargins);
@@ -344,6 +349,59 @@ void ScreenBufferTests::MultipleAlternateBuffersFromMainCreationTest()
     }
 }
 
+void ScreenBufferTests::AlternateBufferIsReused()
+{
+    CONSOLE_INFORMATION& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
+    gci.LockConsole(); // Lock must be taken to manipulate buffer.
+    auto unlock = wil::scope_exit([&] { gci.UnlockConsole(); });
+
+    Log::Comment(
+        L"Testing that leaving the alternate buffer keeps it around, and that"
+        L" entering it again reuses it, cleared out as if it was new.");
+    SCREEN_INFORMATION* const psiOriginal = &gci.GetActiveOutputBuffer();
+    auto& stateMachine = psiOriginal->GetStateMachine();
+
+    stateMachine.ProcessString(L"\x1b[?1049h");
+    SCREEN_INFORMATION* const psiFirstAlternate = &gci.GetActiveOutputBuffer();
+    VERIFY_ARE_NOT_EQUAL(psiOriginal, psiFirstAlternate);
+
+    Log::Comment(L"Dirty the alternate buffer, then leave it.");
+    stateMachine.ProcessString(L"\x1b[31;1m\x1b[3;5HABC\x1b]8;;https://example.com\x1b\\link\x1b]8;;\x1b\\\x1b[1;3r");
+    VERIFY_ARE_NOT_EQUAL(TextAttribute{}, psiFirstAlternate->GetAttributes());
+    VERIFY_IS_TRUE(psiFirstAlternate->AreMarginsSet());
+
+    stateMachine.ProcessString(L"\x1b[?1049l");
+    VERIFY_ARE_EQUAL(psiOriginal, &gci.GetActiveOutputBuffer());
+    VERIFY_IS_NULL(psiOriginal->_psiAlternateBuffer);
+    VERIFY_ARE_EQUAL(psiFirstAlternate, psiOriginal->_psiSpareAltBuffer);
+
+    Log::Comment(L"Entering the alternate buffer again should reuse it.");
+    stateMachine.ProcessString(L"\x1b[?1049h");
+    SCREEN_INFORMATION* const psiSecondAlternate = &gci.GetActiveOutputBuffer();
+    auto useMain = wil::scope_exit([&] { psiSecondAlternate->UseMainScreenBuffer(); });
+
+    VERIFY_ARE_EQUAL(psiFirstAlternate, psiSecondAlternate);
+    VERIFY_ARE_EQUAL(psiSecondAlternate, psiOriginal->_psiAlternateBuffer);
+    VERIFY_ARE_EQUAL(psiOriginal, psiSecondAlternate->_psiMainBuffer);
+    VERIFY_IS_NULL(psiOriginal->_psiSpareAltBuffer);
+
+    auto& tbi = psiSecondAlternate->GetTextBuffer();
+    VERIFY_ARE_EQUAL(COORD({ 0, 0 }), tbi.GetCursor().GetPosition());
+    VERIFY_ARE_EQUAL(TextAttribute{}, psiSecondAlternate->GetAttributes());
+    VERIFY_IS_FALSE(psiSecondAlternate->AreMarginsSet());
+    VERIFY_ARE_EQUAL(psiOriginal->GetViewport().Dimensions(), psiSecondAlternate->GetBufferSize().Dimensions());
+
+    Log::Comment(L"The text and the hyperlink should be gone.");
+    auto iter = tbi.GetCellDataAt({ 0, 0 });
+    const auto viewportSize = psiSecondAlternate->GetViewport().Width() * psiSecondAlternate->GetViewport().Height();
+    auto cleared = true;
+    for (auto i = 0; i < viewportSize; i++, iter++)
+    {
+        cleared = cleared && iter->Chars() == L" " && !iter->TextAttr().IsHyperlink();
+    }
+    VERIFY_IS_TRUE(cleared);
+}
+
 void ScreenBufferTests::TestReverseLineFeed()
 {
     CONSOLE_INFORMATION& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
@@ -4119,6 +4177,115 @@ void ScreenBufferTests::ScrollDownInMargins()
     }
 }
 
+// Stands in for the renderer and records every region it was asked to
+// redraw, so that tests can count the scroll notifications that got through.
+class RedrawCountingRenderer final : public Microsoft::Console::Render::IRenderer
+{
+public:
+    size_t CountRedraws(const SHORT top, const SHORT height) const noexcept
+    {
+        return gsl::narrow_cast<size_t>(std::count_if(redraws.begin(), redraws.end(), [&](const auto& region) {
+            return region.Top() == top && region.Height() == height;
+        }));
+    }
+
+    [[nodiscard]] HRESULT PaintFrame() override { return S_OK; }
+    void TriggerSystemRedraw(const RECT* const) override {}
+    void TriggerRedraw(const Viewport& region) override { redraws.push_back(region); }
+    void TriggerRedraw(const COORD* const) override {}
+    void TriggerRedrawCursor(const COORD* const) override {}
+    void TriggerRedrawAll() override {}
+    void TriggerTeardown() noexcept override {}
+    void TriggerSelection() override {}
+    void TriggerScroll() override {}
+    void TriggerScroll(const COORD* const) override {}
+    void TriggerCircling() override {}
+    void TriggerTitleChange() override {}
+    void TriggerFontChange(const int, const FontInfoDesired&, _Out_ FontInfo&) override {}
+    [[nodiscard]] HRESULT GetProposedFont(const int, const FontInfoDesired&, _Out_ FontInfo&) override { return E_NOTIMPL; }
+    bool IsGlyphWideByFont(const std::wstring_view) override { return false; }
+    void EnablePainting() override {}
+    void WaitForPaintCompletionAndDisable(const DWORD) override {}
+    void WaitUntilCanRender() override {}
+    void AddRenderEngine(_In_ Microsoft::Console::Render::IRenderEngine* const) override {}
+
+    std::vector<Viewport> redraws;
+};
+
+void ScreenBufferTests::BatchedLineFeedsInMargins()
+{
+    // Do the common scrolling setup, then write several more lines inside a
+    // scroll batch, and verify the rows have what we'd expect. The scrolls are
+    // only reported late, the buffer contents must be the same as without.
+
+    _CommonScrollingSetup();
+    auto& g = ServiceLocator::LocateGlobals();
+    auto& gci = g.getConsoleInformation();
+    auto& si = gci.GetActiveOutputBuffer();
+    auto& tbi = si.GetTextBuffer();
+    auto& stateMachine = si.GetStateMachine();
+    auto& cursor = si.GetTextBuffer().GetCursor();
+
+    RedrawCountingRenderer renderer;
+    const auto previousRenderer = g.pRender;
+    g.pRender = &renderer;
+    auto restoreRenderer = wil::scope_exit([&] { g.pRender = previousRenderer; });
+
+    BeginScrollBatch();
+    stateMachine.ProcessString(L"8\n9\n\n");
+    EndScrollBatch();
+
+    Log::Comment(L"Each scroll notification redraws the whole margin region. "
+                 L"The three line feeds must have been reported as one scroll.");
+    VERIFY_ARE_EQUAL(1u, renderer.CountRedraws(1, 4));
+
+    Log::Comment(NoThrowString().Format(
+        L"cursor=%s", VerifyOutputTraits<COORD>::ToString(cursor.GetPosition()).GetBuffer()));
+    Log::Comment(NoThrowString().Format(
+        L"viewport=%s", VerifyOutputTraits<SMALL_RECT>::ToString(si.GetViewport().ToInclusive()).GetBuffer()));
+
+    VERIFY_ARE_EQUAL(0, cursor.GetPosition().X);
+    VERIFY_ARE_EQUAL(4, cursor.GetPosition().Y);
+    {
+        auto iter0 = tbi.GetCellDataAt({ 0, 0 });
+        auto iter1 = tbi.GetCellDataAt({ 0, 1 });
+        auto iter2 = tbi.GetCellDataAt({ 0, 2 });
+        auto iter3 = tbi.GetCellDataAt({ 0, 3 });
+        auto iter4 = tbi.GetCellDataAt({ 0, 4 });
+        auto iter5 = tbi.GetCellDataAt({ 0, 5 });
+        VERIFY_ARE_EQUAL(L"A", iter0->Chars());
+        VERIFY_ARE_EQUAL(L"8", iter1->Chars());
+        VERIFY_ARE_EQUAL(L"9", iter2->Chars());
+        VERIFY_ARE_EQUAL(L"\x20", iter3->Chars());
+        VERIFY_ARE_EQUAL(L"\x20", iter4->Chars());
+        VERIFY_ARE_EQUAL(L"B", iter5->Chars());
+    }
+}
+
+void ScreenBufferTests::BatchedScrollOfInactiveBufferIsDropped()
+{
+    auto& g = ServiceLocator::LocateGlobals();
+    auto& gci = g.getConsoleInformation();
+    gci.LockConsole(); // Lock must be taken to manipulate buffer.
+    auto unlock = wil::scope_exit([&] { gci.UnlockConsole(); });
+
+    auto& stateMachine = gci.GetActiveOutputBuffer().GetStateMachine();
+
+    RedrawCountingRenderer renderer;
+    const auto previousRenderer = g.pRender;
+    g.pRender = &renderer;
+    auto restoreRenderer = wil::scope_exit([&] { g.pRender = previousRenderer; });
+
+    Log::Comment(L"Scroll the margins of the alternate buffer, then leave it, all in one batch.");
+    BeginScrollBatch();
+    stateMachine.ProcessString(L"\x1b[?1049h\x1b[2;5r\x1b[5;1H\n\n");
+    stateMachine.ProcessString(L"\x1b[?1049l");
+    EndScrollBatch();
+
+    Log::Comment(L"The alternate buffer isn't shown anymore, so its scrolls mustn't be reported.");
+    VERIFY_ARE_EQUAL(0u, renderer.CountRedraws(1, 4));
+}
+
 void ScreenBufferTests::InsertLinesInMargins()
 {
     Log::Comment(
@@ -134,12 +134,15 @@ class TextBufferTests
     TEST_METHOD(TestBackspaceStrings);
     TEST_METHOD(TestBackspaceStringsAPI);
 
+    TEST_METHOD(TestWriteCharsLegacyPrintableRuns);
+
     TEST_METHOD(TestRepeatCharacter);
 
     TEST_METHOD(ResizeTraditional);
 
     TEST_METHOD(ResizeTraditionalRotationPreservesHighUnicode);
     TEST_METHOD(ScrollBufferRotationPreservesHighUnicode);
+    TEST_METHOD(ScrollRowsRotatesOnlyAffectedRows);
 
     TEST_METHOD(ResizeTraditionalHighUnicodeRowRemoval);
     TEST_METHOD(ResizeTraditionalHighUnicodeColumnRemoval);
@@ -1610,6 +1613,58 @@ void TextBufferTests::TestBackspaceStringsAPI()
     VERIFY_ARE_EQUAL(cursor.GetPosition().Y, y0);
 }
 
+void TextBufferTests::TestWriteCharsLegacyPrintableRuns()
+{
+    CONSOLE_INFORMATION& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
+    SCREEN_INFORMATION& si = gci.GetActiveOutputBuffer().GetActiveBuffer();
+    const TextBuffer& tbi = si.GetTextBuffer();
+    const Cursor& cursor = tbi.GetCursor();
+
+    gci.SetVirtTermLevel(0);
+    WI_ClearFlag(si.OutputMode, ENABLE_VIRTUAL_TERMINAL_PROCESSING);
+
+    const TextAttribute attr{ 0x1e };
+    si.SetAttributes(attr);
+
+    const auto width = si.GetBufferSize().Width();
+    VERIFY_IS_GREATER_THAN(width, 11);
+
+    Log::Comment(L"Write runs of printable ASCII around a tab, filling the first row and wrapping onto the next.");
+    {
+        std::wstring str = L"abc\tdef" + std::wstring(width - 11, L'x') + std::wstring(11, L'y');
+        size_t cb = str.size() * sizeof(wchar_t);
+        size_t cSpaces = 0;
+        VERIFY_SUCCESS_NTSTATUS(WriteCharsLegacy(si, str.data(), str.data(), str.data(), &cb, &cSpaces, cursor.GetPosition().X, 0, nullptr));
+
+        VERIFY_ARE_EQUAL(str.size() * sizeof(wchar_t), cb);
+        VERIFY_ARE_EQUAL(gsl::narrow_cast<size_t>(width) + 11, cSpaces);
+        VERIFY_ARE_EQUAL(11, cursor.GetPosition().X);
+        VERIFY_ARE_EQUAL(1, cursor.GetPosition().Y);
+    }
+
+    Log::Comment(L"Start a new line, and write a short run there.");
+    {
+        std::wstring str = L"\r\nz";
+        size_t cb = str.size() * sizeof(wchar_t);
+        VERIFY_SUCCESS_NTSTATUS(WriteCharsLegacy(si, str.data(), str.data(), str.data(), &cb, nullptr, cursor.GetPosition().X, 0, nullptr));
+
+        VERIFY_ARE_EQUAL(1, cursor.GetPosition().X);
+        VERIFY_ARE_EQUAL(2, cursor.GetPosition().Y);
+    }
+
+    const auto row0Text = tbi.GetRowByOffset(0).GetText();
+    const auto row1Text = tbi.GetRowByOffset(1).GetText();
+    const auto row2Text = tbi.GetRowByOffset(2).GetText();
+    VERIFY_ARE_EQUAL(L"abc     def" + std::wstring(width - 11, L'x'), row0Text);
+    VERIFY_ARE_EQUAL(std::wstring(11, L'y') + std::wstring(width - 11, L' '), row1Text);
+    VERIFY_ARE_EQUAL(L"z" + std::wstring(width - 1, L' '), row2Text);
+
+    VERIFY_ARE_EQUAL(attr, tbi.GetRowByOffset(0).GetAttrRow().GetAttrByColumn(0));
+    VERIFY_ARE_EQUAL(attr, tbi.GetRowByOffset(0).GetAttrRow().GetAttrByColumn(gsl::narrow_cast<uint16_t>(width - 1)));
+    VERIFY_ARE_EQUAL(attr, tbi.GetRowByOffset(1).GetAttrRow().GetAttrByColumn(10));
+    VERIFY_ARE_EQUAL(attr, tbi.GetRowByOffset(2).GetAttrRow().GetAttrByColumn(0));
+}
+
 void TextBufferTests::TestRepeatCharacter()
 {
     CONSOLE_INFORMATION& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
@@ -1910,6 +1965,78 @@ void TextBufferTests::ScrollBufferRotationPreservesHighUnicode()
     VERIFY_ARE_EQUAL(String(fire), String(shouldBeFireText.data(), gsl::narrow<int>(shouldBeFireText.size())));
 }
 
+// This tests that scrolling a range of rows within a circular buffer that doesn't start at the top of
+// the storage moves only the rows in that range, along with their high unicode items.
+void TextBufferTests::ScrollRowsRotatesOnlyAffectedRows()
+{
+    // Set up a text buffer for us
+    const COORD bufferSize{ 80, 10 };
+    const UINT cursorSize = 12;
+    const TextAttribute attr{ 0x7f };
+    auto _buffer = std::make_unique<TextBuffer>(bufferSize, attr, cursorSize, _renderTarget);
+
+    // Move the first row away from the top of the storage, like a buffer that has circled would.
+    const SHORT firstRow = 3;
+    _buffer->_SetFirstRowIndex(firstRow);
+
+    // Put one emoji in the rows we're going to scroll and one in a row outside of the scrolled range.
+    // These are the fire emoji: 🔥 and the burrito emoji: 🌯
+    const auto fire = L"\xD83D\xDD25";
+    const auto burrito = L"\xD83C\xDF2F";
+    const COORD firePos{ 2, 1 };
+    const COORD burritoPos{ 4, 8 };
+    auto firePosition = _buffer->GetRowByOffset(firePos.Y).GetCharRow().GlyphAt(firePos.X);
+    firePosition = fire;
+    auto burritoPosition = _buffer->GetRowByOffset(burritoPos.Y).GetCharRow().GlyphAt(burritoPos.X);
+    burritoPosition = burrito;
+
+    // Scroll the two rows starting at the fire emoji down by 3. This touches rows 1 through 5.
+    const SHORT delta = 3;
+    const COORD newFirePos{ firePos.X, firePos.Y + delta };
+    _buffer->ScrollRows(firePos.Y, 2, delta);
+
+    // The range didn't wrap around the end of the storage, so the buffer shouldn't have been normalized.
+    VERIFY_ARE_EQUAL(firstRow, _buffer->_firstRow);
+
+    // Every row should still be identified by where it sits in the storage.
+    for (SHORT i = 0; i < bufferSize.Y; ++i)
+    {
+        VERIFY_ARE_EQUAL(i, _buffer->_storage.at(i).GetId());
+    }
+
+    const auto shouldBeEmptyText = *_buffer->GetTextDataAt(firePos);
+    const auto shouldBeFireText = *_buffer->GetTextDataAt(newFirePos);
+    const auto shouldBeBurritoText = *_buffer->GetTextDataAt(burritoPos);
+
+    VERIFY_ARE_EQUAL(String(L" "), String(shouldBeEmptyText.data(), gsl::narrow<int>(shouldBeEmptyText.size())));
+    VERIFY_ARE_EQUAL(String(fire), String(shouldBeFireText.data(), gsl::narrow<int>(shouldBeFireText.size())));
+    VERIFY_ARE_EQUAL(String(burrito), String(shouldBeBurritoText.data(), gsl::narrow<int>(shouldBeBurritoText.size())));
+    VERIFY_ARE_EQUAL(2u, _buffer->GetUnicodeStorage()._map.size(), L"Both items should still be in the map.");
+
+    // Scrolling a range that wraps around the end of the storage takes the slow path, but must give the same result.
+    // With the first row at 3, rows 5 through 8 sit in storage rows 8, 9, 0 and 1.
+    const SHORT upDelta = -3;
+    const COORD newBurritoPos{ burritoPos.X, burritoPos.Y + upDelta };
+    VERIFY_IS_TRUE((firstRow + newBurritoPos.Y) % bufferSize.Y + (1 - upDelta) > bufferSize.Y);
+    _buffer->ScrollRows(burritoPos.Y, 1, upDelta);
+
+    // The buffer was normalized before the rows were rotated.
+    VERIFY_ARE_EQUAL(0, _buffer->_firstRow);
+    for (SHORT i = 0; i < bufferSize.Y; ++i)
+    {
+        VERIFY_ARE_EQUAL(i, _buffer->_storage.at(i).GetId());
+    }
+
+    const auto shouldBeEmptyAgainText = *_buffer->GetTextDataAt(burritoPos);
+    const auto shouldBeFireAgainText = *_buffer->GetTextDataAt(newFirePos);
+    const auto shouldBeBurritoAgainText = *_buffer->GetTextDataAt(newBurritoPos);
+
+    VERIFY_ARE_EQUAL(String(L" "), String(shouldBeEmptyAgainText.data(), gsl::narrow<int>(shouldBeEmptyAgainText.size())));
+    VERIFY_ARE_EQUAL(String(fire), String(shouldBeFireAgainText.data(), gsl::narrow<int>(shouldBeFireAgainText.size())));
+    VERIFY_ARE_EQUAL(String(burrito), String(shouldBeBurritoAgainText.data(), gsl::narrow<int>(shouldBeBurritoAgainText.size())));
+    VERIFY_ARE_EQUAL(2u, _buffer->GetUnicodeStorage()._map.size(), L"Both items should still be in the map.");
+}
+
 // This tests that rows removed from the buffer while resizing traditionally will also drop the high unicode
 // characters from the Unicode Storage buffer
 void TextBufferTests::ResizeTraditionalHighUnicodeRowRemoval()
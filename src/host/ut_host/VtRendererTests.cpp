@@ -79,10 +79,19 @@ class Microsoft::Console::Render::VtRendererTest
 
     TEST_METHOD(TestWrapping);
 
+    TEST_METHOD(TestDeferredScroll);
+
+    TEST_METHOD(TestRepaintChangedCells);
+
+    TEST_METHOD(TestShortestCursorMoves);
+    TEST_METHOD(TestRepeatedCharacterRuns);
+
     TEST_METHOD(TestResize);
 
     TEST_METHOD(TestCursorVisibility);
 
+    TEST_METHOD(TestPipeWriter);
+
     void Test16Colors(VtEngine* engine);
 
     std::deque<std::string> qExpectedInput;
@@ -293,7 +302,7 @@ void VtRendererTest::Xterm256TestInvalidate()
         VERIFY_ARE_EQUAL(1u, runs.size());
         VERIFY_ARE_EQUAL(til::rectangle{ Viewport::FromExclusive(invalid).ToInclusive() }, runs.front());
 
-        qExpectedInput.push_back("\x1b[32;1H"); // Bottom of buffer
+        qExpectedInput.push_back("\x1b[31B"); // Down to the bottom of the buffer
         qExpectedInput.push_back("\n"); // Scroll down once
         VERIFY_SUCCEEDED(engine->ScrollFrame());
     });
@@ -318,7 +327,9 @@ void VtRendererTest::Xterm256TestInvalidate()
         // verify the rect matches the invalid one.
         VERIFY_ARE_EQUAL(til::rectangle{ Viewport::FromExclusive(invalid).ToInclusive() }, invalidRect);
 
-        // We would expect a CUP here, but we're already at the bottom from the last call.
+        // We're already at the bottom from the last call, so the scrolling is
+        // left to painting the new rows. Nothing paints them here, so the
+        // newlines are all written at the end of the frame.
         qExpectedInput.push_back("\n\n\n"); // Scroll down three times
         VERIFY_SUCCEEDED(engine->ScrollFrame());
     });
@@ -571,7 +582,7 @@ void VtRendererTest::Xterm256TestCursor()
 
         Log::Comment(NoThrowString().Format(
             L"----Only move Y coord----"));
-        qExpectedInput.push_back("\x1b[31;2H");
+        qExpectedInput.push_back("\x1b[29B");
         VERIFY_SUCCEEDED(engine->_MoveCursor({ 1, 30 }));
 
         Log::Comment(NoThrowString().Format(
@@ -955,7 +966,7 @@ void VtRendererTest::XtermTestInvalidate()
         VERIFY_ARE_EQUAL(1u, runs.size());
         VERIFY_ARE_EQUAL(til::rectangle{ Viewport::FromExclusive(invalid).ToInclusive() }, runs.front());
 
-        qExpectedInput.push_back("\x1b[32;1H"); // Bottom of buffer
+        qExpectedInput.push_back("\x1b[31B"); // Down to the bottom of the buffer
         qExpectedInput.push_back("\n"); // Scroll down once
         VERIFY_SUCCEEDED(engine->ScrollFrame());
     });
@@ -980,7 +991,9 @@ void VtRendererTest::XtermTestInvalidate()
         // verify the rect matches the invalid one.
         VERIFY_ARE_EQUAL(til::rectangle{ Viewport::FromExclusive(invalid).ToInclusive() }, invalidRect);
 
-        // We would expect a CUP here, but we're already at the bottom from the last call.
+        // We're already at the bottom from the last call, so the scrolling is
+        // left to painting the new rows. Nothing paints them here, so the
+        // newlines are all written at the end of the frame.
         qExpectedInput.push_back("\n\n\n"); // Scroll down three times
         VERIFY_SUCCEEDED(engine->ScrollFrame());
     });
@@ -1196,7 +1209,7 @@ void VtRendererTest::XtermTestCursor()
 
         Log::Comment(NoThrowString().Format(
             L"----Only move Y coord----"));
-        qExpectedInput.push_back("\x1b[31;2H");
+        qExpectedInput.push_back("\x1b[29B");
         VERIFY_SUCCEEDED(engine->_MoveCursor({ 1, 30 }));
 
         Log::Comment(NoThrowString().Format(
@@ -1401,6 +1414,268 @@ void VtRendererTest::TestWrapping()
     });
 }
 
+void VtRendererTest::TestDeferredScroll()
+{
+    wil::unique_hfile hFile = wil::unique_hfile(INVALID_HANDLE_VALUE);
+    std::unique_ptr<Xterm256Engine> engine = std::make_unique<Xterm256Engine>(std::move(hFile), SetUpViewport());
+    auto pfn = std::bind(&VtRendererTest::WriteCallback, this, std::placeholders::_1, std::placeholders::_2);
+    engine->SetTestCallback(pfn);
+
+    qExpectedInput.push_back("\x1b[2J");
+    TestPaint(*engine, [&]() {
+        VERIFY_IS_FALSE(engine->_firstPaint);
+    });
+
+    const Viewport view = SetUpViewport();
+    const auto bottom = view.BottomInclusive();
+
+    TestPaint(*engine, [&]() {
+        Log::Comment(L"Put the cursor on the bottom row, where a newline scrolls.");
+        qExpectedInput.push_back("\x1b[32;1H");
+        VERIFY_SUCCEEDED(engine->_MoveCursor({ 0, bottom }));
+    });
+
+    const auto paintLine = [&](const std::wstring_view line, const short row) {
+        std::vector<Cluster> clusters;
+        for (size_t i = 0; i < line.size(); i++)
+        {
+            clusters.emplace_back(line.substr(i, 1), 1u);
+        }
+        VERIFY_SUCCEEDED(engine->PaintBufferLine({ clusters.data(), clusters.size() }, { 0, row }, false, false));
+    };
+
+    COORD scrollDelta = { 0, -3 };
+    VERIFY_SUCCEEDED(engine->InvalidateScroll(&scrollDelta));
+    TestPaint(*engine, [&]() {
+        Log::Comment(L"Only the three new rows are invalid, so ScrollFrame leaves the scrolling to them.");
+        VERIFY_IS_TRUE(engine->_CanDeferScroll(3));
+        qExpectedInput.push_back(EMPTY_CALLBACK_SENTINEL);
+        VERIFY_SUCCEEDED(engine->ScrollFrame());
+        WriteCallback(EMPTY_CALLBACK_SENTINEL, 1);
+        VERIFY_ARE_EQUAL(static_cast<short>(3), engine->_deferredNewlines);
+
+        Log::Comment(L"Each row starts with the newline that scrolls it in: no CUP, and no EL.");
+        qExpectedInput.push_back("\n");
+        qExpectedInput.push_back("AAA");
+        paintLine(L"AAA", gsl::narrow_cast<short>(bottom - 2));
+
+        qExpectedInput.push_back("\r\n");
+        qExpectedInput.push_back("BBB");
+        paintLine(L"BBB", gsl::narrow_cast<short>(bottom - 1));
+
+        qExpectedInput.push_back("\r\n");
+        qExpectedInput.push_back("CCC");
+        paintLine(L"CCC", bottom);
+
+        VERIFY_ARE_EQUAL(static_cast<short>(0), engine->_deferredNewlines);
+    });
+
+    VerifyExpectedInputsDrained();
+}
+
+void VtRendererTest::TestRepaintChangedCells()
+{
+    wil::unique_hfile hFile = wil::unique_hfile(INVALID_HANDLE_VALUE);
+    std::unique_ptr<Xterm256Engine> engine = std::make_unique<Xterm256Engine>(std::move(hFile), SetUpViewport());
+    auto pfn = std::bind(&VtRendererTest::WriteCallback, this, std::placeholders::_1, std::placeholders::_2);
+    engine->SetTestCallback(pfn);
+
+    qExpectedInput.push_back("\x1b[2J");
+    TestPaint(*engine, [&]() {
+        VERIFY_IS_FALSE(engine->_firstPaint);
+    });
+
+    const auto paintLine = [&](const std::wstring_view line) {
+        std::vector<Cluster> clusters;
+        for (size_t i = 0; i < line.size(); i++)
+        {
+            clusters.emplace_back(line.substr(i, 1), 1u);
+        }
+        VERIFY_SUCCEEDED(engine->PaintBufferLine({ clusters.data(), clusters.size() }, { 0, 0 }, false, false));
+    };
+
+    TestPaint(*engine, [&]() {
+        Log::Comment(L"The first time a line is painted, all of it is written.");
+        qExpectedInput.push_back("\x1b[H");
+        qExpectedInput.push_back("hello world");
+        paintLine(L"hello world");
+    });
+
+    TestPaint(*engine, [&]() {
+        Log::Comment(L"Only the changed word should be written.");
+        qExpectedInput.push_back("\x1b[5D");
+        qExpectedInput.push_back("there");
+        paintLine(L"hello there");
+    });
+
+    TestPaint(*engine, [&]() {
+        Log::Comment(L"Painting the same line again shouldn't write anything.");
+        paintLine(L"hello there");
+    });
+
+    TestPaint(*engine, [&]() {
+        Log::Comment(L"Long unchanged spans are skipped, short ones are written again.");
+        qExpectedInput.push_back("\x1b[H");
+        qExpectedInput.push_back("j");
+        qExpectedInput.push_back("\x1b[7C");
+        qExpectedInput.push_back("orn");
+        paintLine(L"jello thorn");
+    });
+
+    VerifyExpectedInputsDrained();
+}
+
+void VtRendererTest::TestShortestCursorMoves()
+{
+    wil::unique_hfile hFile = wil::unique_hfile(INVALID_HANDLE_VALUE);
+    std::unique_ptr<Xterm256Engine> engine = std::make_unique<Xterm256Engine>(std::move(hFile), SetUpViewport());
+    auto pfn = std::bind(&VtRendererTest::WriteCallback, this, std::placeholders::_1, std::placeholders::_2);
+    engine->SetTestCallback(pfn);
+
+    qExpectedInput.push_back("\x1b[2J");
+    TestPaint(*engine, [&]() {
+        VERIFY_IS_FALSE(engine->_firstPaint);
+    });
+
+    TestPaint(*engine, [&]() {
+        qExpectedInput.push_back("\x1b[H");
+        VERIFY_SUCCEEDED(engine->_MoveCursor({ 0, 0 }));
+
+        Log::Comment(L"----Three line feeds are shorter than a CUD----");
+        qExpectedInput.push_back("\n\n\n");
+        VERIFY_SUCCEEDED(engine->_MoveCursor({ 0, 3 }));
+
+        Log::Comment(L"----A CUF is shorter than a CHA or a CUP----");
+        qExpectedInput.push_back("\x1b[5C");
+        VERIFY_SUCCEEDED(engine->_MoveCursor({ 5, 3 }));
+
+        Log::Comment(L"----Line feeds and a carriage return are shorter than a CUP----");
+        qExpectedInput.push_back("\n\n");
+        qExpectedInput.push_back("\r");
+        VERIFY_SUCCEEDED(engine->_MoveCursor({ 0, 5 }));
+
+        Log::Comment(L"----A CUU ties with a VPA, and the CUU is used----");
+        qExpectedInput.push_back("\x1b[2A");
+        VERIFY_SUCCEEDED(engine->_MoveCursor({ 0, 3 }));
+
+        Log::Comment(L"----A CUD is shorter than 20 line feeds----");
+        qExpectedInput.push_back("\x1b[20B");
+        VERIFY_SUCCEEDED(engine->_MoveCursor({ 0, 23 }));
+
+        qExpectedInput.push_back("\x1b[70C");
+        VERIFY_SUCCEEDED(engine->_MoveCursor({ 70, 23 }));
+
+        Log::Comment(L"----A CHA is shorter than a CUB----");
+        qExpectedInput.push_back("\x1b[3G");
+        VERIFY_SUCCEEDED(engine->_MoveCursor({ 2, 23 }));
+
+        Log::Comment(L"----A VPA is shorter than a CUU----");
+        qExpectedInput.push_back("\x1b[2d");
+        VERIFY_SUCCEEDED(engine->_MoveCursor({ 2, 1 }));
+
+        Log::Comment(L"----A CUP is shorter than a CUD and a CUF----");
+        qExpectedInput.push_back("\x1b[21;61H");
+        VERIFY_SUCCEEDED(engine->_MoveCursor({ 60, 20 }));
+    });
+
+    VerifyExpectedInputsDrained();
+
+    Log::Comment(L"In VT100 mode, CHA and VPA aren't used.");
+    hFile = wil::unique_hfile(INVALID_HANDLE_VALUE);
+    std::unique_ptr<XtermEngine> asciiEngine = std::make_unique<XtermEngine>(std::move(hFile), SetUpViewport(), true);
+    asciiEngine->SetTestCallback(pfn);
+
+    qExpectedInput.push_back("\x1b[2J");
+    TestPaint(*asciiEngine, [&]() {
+        VERIFY_IS_FALSE(asciiEngine->_firstPaint);
+    });
+
+    TestPaint(*asciiEngine, [&]() {
+        qExpectedInput.push_back("\x1b[H");
+        VERIFY_SUCCEEDED(asciiEngine->_MoveCursor({ 0, 0 }));
+
+        qExpectedInput.push_back("\x1b[70C");
+        VERIFY_SUCCEEDED(asciiEngine->_MoveCursor({ 70, 0 }));
+
+        Log::Comment(L"----A CUB instead of a CHA----");
+        qExpectedInput.push_back("\x1b[68D");
+        VERIFY_SUCCEEDED(asciiEngine->_MoveCursor({ 2, 0 }));
+
+        qExpectedInput.push_back("\x1b[30B");
+        VERIFY_SUCCEEDED(asciiEngine->_MoveCursor({ 2, 30 }));
+
+        Log::Comment(L"----A CUU instead of a VPA----");
+        qExpectedInput.push_back("\x1b[29A");
+        VERIFY_SUCCEEDED(asciiEngine->_MoveCursor({ 2, 1 }));
+    });
+
+    VerifyExpectedInputsDrained();
+}
+
+void VtRendererTest::TestRepeatedCharacterRuns()
+{
+    std::unique_ptr<VtEngine> engine;
+    auto pfn = std::bind(&VtRendererTest::WriteCallback, this, std::placeholders::_1, std::placeholders::_2);
+
+    const auto paintLine = [&](const std::wstring_view line, const short row) {
+        std::vector<Cluster> clusters;
+        for (size_t i = 0; i < line.size(); i++)
+        {
+            clusters.emplace_back(line.substr(i, 1), 1u);
+        }
+        VERIFY_SUCCEEDED(engine->PaintBufferLine({ clusters.data(), clusters.size() }, { 0, row }, false, false));
+    };
+
+    Log::Comment(L"xterm-256color repeats printable ASCII with REP, where that's shorter.");
+    engine = std::make_unique<Xterm256Engine>(wil::unique_hfile(INVALID_HANDLE_VALUE), SetUpViewport());
+    engine->SetTestCallback(pfn);
+
+    qExpectedInput.push_back("\x1b[2J");
+    TestPaint(*engine, [&]() {});
+
+    TestPaint(*engine, [&]() {
+        qExpectedInput.push_back("\x1b[H");
+        qExpectedInput.push_back("a\x1b[11bb");
+        paintLine(L"aaaaaaaaaaaab", 0);
+
+        Log::Comment(L"Spaces are repeated too, since a REP is shorter than an ECH and a CUF.");
+        qExpectedInput.push_back("\r\n");
+        qExpectedInput.push_back("x \x1b[10by");
+        paintLine(L"x           y", 1);
+
+        Log::Comment(L"Short runs and runs of non-ASCII characters are written as they are.");
+        qExpectedInput.push_back("\r\n");
+        qExpectedInput.push_back("aaa\xc3\xa9\xc3\xa9\xc3\xa9\xc3\xa9\xc3\xa9");
+        paintLine(L"aaa\x00e9\x00e9\x00e9\x00e9\x00e9", 2);
+    });
+
+    VerifyExpectedInputsDrained();
+
+    Log::Comment(L"xterm doesn't get REP, but spaces are erased and skipped, where that's shorter.");
+    engine = std::make_unique<XtermEngine>(wil::unique_hfile(INVALID_HANDLE_VALUE), SetUpViewport(), false);
+    engine->SetTestCallback(pfn);
+
+    qExpectedInput.push_back("\x1b[2J");
+    TestPaint(*engine, [&]() {});
+
+    TestPaint(*engine, [&]() {
+        qExpectedInput.push_back("\x1b[H");
+        qExpectedInput.push_back("aaaaaaaaaaaab");
+        paintLine(L"aaaaaaaaaaaab", 0);
+
+        qExpectedInput.push_back("\r\n");
+        qExpectedInput.push_back("x\x1b[11X\x1b[11Cy");
+        paintLine(L"x           y", 1);
+
+        Log::Comment(L"An ECH and a CUF over 10 spaces are as long as the spaces, so they're written.");
+        qExpectedInput.push_back("\r\n");
+        qExpectedInput.push_back("x          y");
+        paintLine(L"x          y", 2);
+    });
+
+    VerifyExpectedInputsDrained();
+}
+
 void VtRendererTest::TestResize()
 {
     Viewport view = SetUpViewport();
@@ -1585,3 +1860,45 @@ void VtRendererTest::FormattedString()
     qExpectedInput.push_back("\x1b[28;3;500;500;500m");
     VERIFY_SUCCEEDED(engine->_WriteFormatted(bigFormat, bigValue, bigValue, bigValue));
 }
+
+void VtRendererTest::TestPipeWriter()
+{
+    Log::Comment(L"Output handed to the writer must reach the pipe in order, "
+                 L"without waiting for the terminal to read it.");
+
+    wil::unique_hfile readPipe;
+    wil::unique_hfile writePipe;
+    VERIFY_WIN32_BOOL_SUCCEEDED(CreatePipe(readPipe.addressof(), writePipe.addressof(), nullptr, 0));
+
+    PipeWriter writer{ writePipe.get() };
+
+    // Nobody reads the pipe yet, so this is more than it can hold.
+    std::string expected;
+    std::string buffer;
+    for (auto i = 0; i < 64; ++i)
+    {
+        buffer = fmt::format("{:-<1024}", i);
+        expected += buffer;
+        VERIFY_SUCCEEDED(writer.Write(buffer));
+        VERIFY_IS_TRUE(buffer.empty());
+    }
+
+    std::string actual(expected.size(), '\0');
+    size_t read = 0;
+    while (read < actual.size())
+    {
+        DWORD dwRead = 0;
+        VERIFY_WIN32_BOOL_SUCCEEDED(ReadFile(readPipe.get(), actual.data() + read, gsl::narrow_cast<DWORD>(actual.size() - read), &dwRead, nullptr));
+        read += dwRead;
+    }
+    VERIFY_SUCCEEDED(writer.Drain());
+    VERIFY_ARE_EQUAL(expected, actual);
+
+    Log::Comment(L"Once the terminal is gone, the failure must be reported.");
+    readPipe.reset();
+    buffer = "lost";
+    VERIFY_SUCCEEDED(writer.Write(buffer));
+    VERIFY_FAILED(writer.Drain());
+    buffer = "lost";
+    VERIFY_FAILED(writer.Write(buffer));
+}
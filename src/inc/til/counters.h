@@ -0,0 +1,325 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// til::counters are cheap, portable performance counters for hot paths.
+// Unlike our TraceLogging events they don't need ETW to be consumed:
+// dump_json() returns the current totals, on any platform.
+//
+// Instrument code with the TIL_COUNTER_* and TIL_HISTOGRAM_* macros. They
+// compile to nothing unless TIL_COUNTERS_ENABLED is defined to 1, so the
+// instrumentation can stay in the code at no cost for regular builds.
+#ifndef TIL_COUNTERS_ENABLED
+#define TIL_COUNTERS_ENABLED 0
+#endif
+
+namespace til::counters
+{
+    enum class counter : size_t
+    {
+        chars_parsed,
+        sequences_execute,
+        sequences_esc,
+        sequences_csi,
+        sequences_osc,
+        sequences_dcs,
+        sequences_vt52,
+        rows_written,
+        reflows,
+        glyph_allocations,
+        count_
+    };
+
+    enum class histogram : size_t
+    {
+        lock_wait_ns,
+        count_
+    };
+
+    static constexpr std::array<std::string_view, static_cast<size_t>(counter::count_)> counter_names{
+        "charsParsed",
+        "sequencesExecute",
+        "sequencesEsc",
+        "sequencesCsi",
+        "sequencesOsc",
+        "sequencesDcs",
+        "sequencesVt52",
+        "rowsWritten",
+        "reflows",
+        "glyphAllocations",
+    };
+
+    static constexpr std::array<std::string_view, static_cast<size_t>(histogram::count_)> histogram_names{
+        "lockWaitNs",
+    };
+
+    // Histograms have one bucket per power of two: bucket i counts the
+    // values that need exactly i bits, so bucket 0 holds the zeros.
+    static constexpr size_t bucket_count = 65;
+
+    struct histogram_data
+    {
+        uint64_t sum = 0;
+        std::array<uint64_t, bucket_count> buckets{};
+    };
+
+    struct snapshot
+    {
+        std::array<uint64_t, static_cast<size_t>(counter::count_)> counters{};
+        std::array<histogram_data, static_cast<size_t>(histogram::count_)> histograms{};
+    };
+
+    namespace details
+    {
+        // Each thread only ever writes to its own block, so the counters
+        // don't need atomic read-modify-write operations. They're atomics
+        // anyway, so that collect() can read them from another thread.
+        struct block
+        {
+            std::array<std::atomic<uint64_t>, static_cast<size_t>(counter::count_)> counters{};
+            std::array<std::atomic<uint64_t>, static_cast<size_t>(histogram::count_)> sums{};
+            std::array<std::array<std::atomic<uint64_t>, bucket_count>, static_cast<size_t>(histogram::count_)> buckets{};
+
+            void add_to(snapshot& total) const noexcept
+            {
+                for (size_t i = 0; i < counters.size(); ++i)
+                {
+                    total.counters[i] += counters[i].load(std::memory_order_relaxed);
+                }
+                for (size_t i = 0; i < sums.size(); ++i)
+                {
+                    total.histograms[i].sum += sums[i].load(std::memory_order_relaxed);
+                    for (size_t j = 0; j < bucket_count; ++j)
+                    {
+                        total.histograms[i].buckets[j] += buckets[i][j].load(std::memory_order_relaxed);
+                    }
+                }
+            }
+
+            void clear() noexcept
+            {
+                for (auto& value : counters)
+                {
+                    value.store(0, std::memory_order_relaxed);
+                }
+                for (size_t i = 0; i < sums.size(); ++i)
+                {
+                    sums[i].store(0, std::memory_order_relaxed);
+                    for (auto& value : buckets[i])
+                    {
+                        value.store(0, std::memory_order_relaxed);
+                    }
+                }
+            }
+        };
+
+        // Keeps track of the blocks of all live threads. The totals of
+        // threads that have exited are kept in a single snapshot.
+        struct registry
+        {
+            std::mutex lock;
+            std::vector<block*> live;
+            snapshot retired;
+
+            static registry& instance()
+            {
+                static registry r;
+                return r;
+            }
+        };
+
+        struct thread_block : block
+        {
+            thread_block() noexcept
+            {
+                auto& r = registry::instance();
+                const std::lock_guard guard{ r.lock };
+                try
+                {
+                    r.live.emplace_back(this);
+                }
+                catch (...)
+                {
+                    // This thread's counts won't be reported, but counting
+                    // must never fail the code being measured.
+                }
+            }
+
+            ~thread_block()
+            {
+                auto& r = registry::instance();
+                const std::lock_guard guard{ r.lock };
+                add_to(r.retired);
+                r.live.erase(std::remove(r.live.begin(), r.live.end(), this), r.live.end());
+            }
+
+            thread_block(const thread_block&) = delete;
+            thread_block& operator=(const thread_block&) = delete;
+        };
+
+        inline block& local() noexcept
+        {
+            thread_local thread_block b;
+            return b;
+        }
+
+        inline void bump(std::atomic<uint64_t>& value, const uint64_t amount) noexcept
+        {
+            value.store(value.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+        }
+
+        constexpr size_t bit_width(uint64_t value) noexcept
+        {
+            size_t width = 0;
+            for (; value; value >>= 1)
+            {
+                ++width;
+            }
+            return width;
+        }
+    }
+
+    inline void add(const counter c, const uint64_t amount = 1) noexcept
+    {
+        details::bump(details::local().counters[static_cast<size_t>(c)], amount);
+    }
+
+    inline void record(const histogram h, const uint64_t value) noexcept
+    {
+        auto& b = details::local();
+        const auto index = static_cast<size_t>(h);
+        details::bump(b.sums[index], value);
+        details::bump(b.buckets[index][details::bit_width(value)], 1);
+    }
+
+    // Adds a value to a histogram that's kept outside of the per-thread
+    // blocks. The caller is responsible for synchronizing access to it.
+    inline void record(histogram_data& h, const uint64_t value) noexcept
+    {
+        h.sum += value;
+        ++h.buckets[details::bit_width(value)];
+    }
+
+    // Returns the totals over all threads, including those that have exited.
+    inline snapshot collect()
+    {
+        auto& r = details::registry::instance();
+        const std::lock_guard guard{ r.lock };
+
+        auto total = r.retired;
+        for (const auto b : r.live)
+        {
+            b->add_to(total);
+        }
+        return total;
+    }
+
+    // Sets all counters back to zero. Counts made concurrently on other
+    // threads may or may not survive this.
+    inline void reset()
+    {
+        auto& r = details::registry::instance();
+        const std::lock_guard guard{ r.lock };
+
+        r.retired = {};
+        for (const auto b : r.live)
+        {
+            b->clear();
+        }
+    }
+
+    // Appends a histogram as a JSON object, for example:
+    //   {"count":2,"sum":300,"buckets":{"7":1,"8":1}}
+    // Histogram buckets are keyed by bit width and empty ones are left out.
+    inline void append_json(std::string& json, const histogram_data& h)
+    {
+        uint64_t count = 0;
+        std::string buckets;
+        for (size_t j = 0; j < bucket_count; ++j)
+        {
+            if (h.buckets[j])
+            {
+                count += h.buckets[j];
+                buckets.append(buckets.empty() ? "\"" : ",\"").append(std::to_string(j)).append("\":").append(std::to_string(h.buckets[j]));
+            }
+        }
+
+        json.append("{\"count\":").append(std::to_string(count));
+        json.append(",\"sum\":").append(std::to_string(h.sum));
+        json.append(",\"buckets\":{").append(buckets).append("}}");
+    }
+
+    // Formats a snapshot as a JSON object, for example:
+    //   {"counters":{"charsParsed":123,...},"histograms":{"lockWaitNs":{"count":2,"sum":300,"buckets":{"7":1,"8":1}}}}
+    inline std::string to_json(const snapshot& s)
+    {
+        std::string json{ "{\"counters\":{" };
+        for (size_t i = 0; i < s.counters.size(); ++i)
+        {
+            json.append(i ? ",\"" : "\"").append(counter_names[i]).append("\":").append(std::to_string(s.counters[i]));
+        }
+
+        json.append("},\"histograms\":{");
+        for (size_t i = 0; i < s.histograms.size(); ++i)
+        {
+            json.append(i ? ",\"" : "\"").append(histogram_names[i]).append("\":");
+            append_json(json, s.histograms[i]);
+        }
+
+        json.append("}}");
+        return json;
+    }
+
+    inline std::string dump_json()
+    {
+        return to_json(collect());
+    }
+
+    // Records the time between its construction and destruction in a
+    // histogram, in nanoseconds.
+    class scoped_timer
+    {
+    public:
+        explicit scoped_timer(const histogram h) noexcept :
+            _histogram{ h },
+            _start{ std::chrono::steady_clock::now() }
+        {
+        }
+
+        ~scoped_timer()
+        {
+            const auto elapsed = std::chrono::steady_clock::now() - _start;
+            record(_histogram, static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()));
+        }
+
+        scoped_timer(const scoped_timer&) = delete;
+        scoped_timer& operator=(const scoped_timer&) = delete;
+
+    private:
+        histogram _histogram;
+        std::chrono::steady_clock::time_point _start;
+    };
+}
+
+#define _TIL_COUNTERS_CONCAT_INNER(a, b) a##b
+#define _TIL_COUNTERS_CONCAT(a, b) _TIL_COUNTERS_CONCAT_INNER(a, b)
+
+#if TIL_COUNTERS_ENABLED
+#define TIL_COUNTER_ADD(name, amount) ::til::counters::add(::til::counters::counter::name, (amount))
+#define TIL_COUNTER_INCREMENT(name) ::til::counters::add(::til::counters::counter::name)
+#define TIL_HISTOGRAM_TIME_SCOPE(name) const ::til::counters::scoped_timer _TIL_COUNTERS_CONCAT(_tilScopedTimer, __LINE__){ ::til::counters::histogram::name }
+#else
+#define TIL_COUNTER_ADD(name, amount) ((void)0)
+#define TIL_COUNTER_INCREMENT(name) ((void)0)
+#define TIL_HISTOGRAM_TIME_SCOPE(name) ((void)0)
+#endif
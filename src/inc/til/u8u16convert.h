@@ -13,7 +13,10 @@ Tests have been made in order to investigate whether or not own algorithms
 could overcome disadvantages of syscalls. Test results can be read up
 in PR #4093 and the test algorithms are available in src\tools\U8U16Test.
 Based on the results the decision was made to keep using the platform
-functions MultiByteToWideChar and WideCharToMultiByte.
+functions MultiByteToWideChar and WideCharToMultiByte for non-ASCII text.
+Leading ASCII, which is the bulk of what a terminal sees, is converted
+in blocks of 16 code units with SSE2 instead (scalar on other architectures)
+and only the remainder is passed to the platform functions.
 
 Author(s):
 - Steffen Illhardt (german-one) 2020
@@ -21,8 +24,99 @@ Author(s):
 
 #pragma once
 
+#if defined(_M_AMD64) || defined(_M_IX86)
+#include <emmintrin.h>
+#endif
+
 namespace til // Terminal Implementation Library. Also: "Today I Learned"
 {
+    namespace details
+    {
+        // Routine Description:
+        // - Widens the leading ASCII characters of a UTF-8 string to UTF-16.
+        // Arguments:
+        // - in - the UTF-8 string
+        // - out - the destination, which must have room for at least in.length() code units
+        // Return Value:
+        // - the number of leading ASCII characters that were converted
+        inline size_t u8u16_ascii(const std::string_view in, wchar_t* const out) noexcept
+        {
+            const auto src = in.data();
+            const auto len = in.length();
+            size_t i = 0;
+
+#if defined(_M_AMD64) || defined(_M_IX86)
+            const auto zero = _mm_setzero_si128();
+            for (; i + 16 <= len; i += 16)
+            {
+                const auto block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+                // Any byte with its MSB set is the start of non-ASCII.
+                if (_mm_movemask_epi8(block) != 0)
+                {
+                    break;
+                }
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), _mm_unpacklo_epi8(block, zero));
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i + 8), _mm_unpackhi_epi8(block, zero));
+            }
+#endif
+
+            for (; i < len; ++i)
+            {
+                const auto ch = gsl::narrow_cast<unsigned char>(src[i]);
+                if (ch > 0x7f)
+                {
+                    break;
+                }
+                out[i] = ch;
+            }
+
+            return i;
+        }
+
+        // Routine Description:
+        // - Narrows the leading ASCII characters of a UTF-16 string to UTF-8.
+        // Arguments:
+        // - in - the UTF-16 string
+        // - out - the destination, which must have room for at least in.length() code units
+        // Return Value:
+        // - the number of leading ASCII characters that were converted
+        inline size_t u16u8_ascii(const std::wstring_view in, char* const out) noexcept
+        {
+            const auto src = in.data();
+            const auto len = in.length();
+            size_t i = 0;
+
+#if defined(_M_AMD64) || defined(_M_IX86)
+            const auto nonAscii = _mm_set1_epi16(static_cast<short>(0xff80));
+            const auto zero = _mm_setzero_si128();
+            for (; i + 16 <= len; i += 16)
+            {
+                const auto lo = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+                const auto hi = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i + 8));
+                // Any code unit with one of the bits above 0x7f set is non-ASCII.
+                const auto test = _mm_and_si128(_mm_or_si128(lo, hi), nonAscii);
+                if (_mm_movemask_epi8(_mm_cmpeq_epi16(test, zero)) != 0xffff)
+                {
+                    break;
+                }
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), _mm_packus_epi16(lo, hi));
+            }
+#endif
+
+            for (; i < len; ++i)
+            {
+                const auto ch = src[i];
+                if (ch > 0x7f)
+                {
+                    break;
+                }
+                out[i] = gsl::narrow_cast<char>(ch);
+            }
+
+            return i;
+        }
+    } // namespace details
+
     template<class charT>
     class u8u16state final
     {
@@ -51,6 +145,17 @@ namespace til // Terminal Implementation Library. Also: "Today I Learned"
         {
             try
             {
+                // Nothing cached from a previous call: hand out the input itself,
+                // minus a partial code point at its end, instead of copying it.
+                if (_partialsLen == 0u)
+                {
+                    const auto partialLen = _u8PartialLength(in);
+                    std::copy(in.end() - partialLen, in.end(), _utfPartials.begin());
+                    _partialsLen = partialLen;
+                    out = in.substr(0, in.length() - partialLen);
+                    return S_OK;
+                }
+
                 size_t capacity{};
                 RETURN_HR_IF(E_ABORT, !base::CheckAdd(in.length(), _partialsLen).AssignIfValid(&capacity));
 
@@ -84,35 +189,11 @@ namespace til // Terminal Implementation Library. Also: "Today I Learned"
                 }
 
                 _buffer.append(in);
-                size_t remainingLength{ _buffer.length() };
 
-                auto backIter = _buffer.end();
-                // If the last byte in the string was a byte belonging to a UTF-8 multi-byte character
-                if ((*(backIter - 1) & _Utf8BitMasks::MaskAsciiByte) > _Utf8BitMasks::IsAsciiByte)
-                {
-                    // Check only up to 3 last bytes, if no Lead Byte was found then the byte before must be the Lead Byte and no partials are in the string
-                    const size_t stopLen{ std::min(_buffer.length(), gsl::narrow_cast<size_t>(3u)) };
-                    for (size_t sequenceLen{ 1u }; sequenceLen <= stopLen; ++sequenceLen)
-                    {
-                        --backIter;
-                        // If Lead Byte found
-                        if ((*backIter & _Utf8BitMasks::MaskContinuationByte) > _Utf8BitMasks::IsContinuationByte)
-                        {
-                            // If the Lead Byte indicates that the last bytes in the string is a partial UTF-8 code point then cache them:
-                            //  Use the bitmask at index `sequenceLen`. Compare the result with the operand having the same index. If they
-                            //  are not equal then the sequence has to be cached because it is a partial code point. Otherwise the
-                            //  sequence is a complete UTF-8 code point and the whole string is ready for the conversion into a UTF-16 string.
-                            if ((*backIter & _cmpMasks.at(sequenceLen)) != _cmpOperands.at(sequenceLen))
-                            {
-                                std::move(backIter, _buffer.end(), _utfPartials.begin());
-                                remainingLength -= sequenceLen;
-                                _partialsLen = sequenceLen;
-                            }
-
-                            break;
-                        }
-                    }
-                }
+                const auto partialLen = _u8PartialLength(_buffer);
+                const auto remainingLength = _buffer.length() - partialLen;
+                std::move(_buffer.begin() + remainingLength, _buffer.end(), _utfPartials.begin());
+                _partialsLen = partialLen;
 
                 // populate the part of the string that contains complete code points only
                 out = { _buffer.data(), remainingLength };
@@ -151,6 +232,23 @@ namespace til // Terminal Implementation Library. Also: "Today I Learned"
         {
             try
             {
+                // Nothing cached from a previous call: hand out the input itself,
+                // minus a trailing high surrogate, instead of copying it.
+                if (_partialsLen == 0u)
+                {
+                    if (!in.empty() && in.back() >= 0xD800u && in.back() <= 0xDBFFu)
+                    {
+                        _utfPartials.front() = in.back();
+                        _partialsLen = 1u;
+                        out = in.substr(0, in.length() - 1);
+                    }
+                    else
+                    {
+                        out = in;
+                    }
+                    return S_OK;
+                }
+
                 size_t remainingLength{ in.length() };
                 size_t capacity{};
 
@@ -221,6 +319,39 @@ namespace til // Terminal Implementation Library. Also: "Today I Learned"
         }
 
     private:
+        // Routine Description:
+        // - Returns the length of an incomplete UTF-8 code point at the end of the string.
+        // Arguments:
+        // - str - the UTF-8 string to check
+        // Return Value:
+        // - the number of code units of the trailing partial code point, or 0 if there's none
+        static size_t _u8PartialLength(const std::basic_string_view<charT> str) noexcept
+        {
+            // If the last byte in the string isn't a byte belonging to a UTF-8 multi-byte character
+            if (str.empty() || (str.back() & _Utf8BitMasks::MaskAsciiByte) == _Utf8BitMasks::IsAsciiByte)
+            {
+                return 0u;
+            }
+
+            // Check only up to 3 last bytes, if no Lead Byte was found then the byte before must be the Lead Byte and no partials are in the string
+            const size_t stopLen{ std::min(str.length(), gsl::narrow_cast<size_t>(3u)) };
+            for (size_t sequenceLen{ 1u }; sequenceLen <= stopLen; ++sequenceLen)
+            {
+                const auto ch = str[str.length() - sequenceLen];
+                // If Lead Byte found
+                if ((ch & _Utf8BitMasks::MaskContinuationByte) > _Utf8BitMasks::IsContinuationByte)
+                {
+                    // If the Lead Byte indicates that the last bytes in the string is a partial UTF-8 code point then cache them:
+                    //  Use the bitmask at index `sequenceLen`. Compare the result with the operand having the same index. If they
+                    //  are not equal then the sequence has to be cached because it is a partial code point. Otherwise the
+                    //  sequence is a complete UTF-8 code point and the whole string is ready for the conversion into a UTF-16 string.
+                    return (ch & _cmpMasks.at(sequenceLen)) != _cmpOperands.at(sequenceLen) ? sequenceLen : 0u;
+                }
+            }
+
+            return 0u;
+        }
+
         enum _Utf8BitMasks : BYTE
         {
             IsAsciiByte = 0b0'0000000, // Any byte representing an ASCII character has the MSB set to 0
@@ -283,12 +414,21 @@ namespace til // Terminal Implementation Library. Also: "Today I Learned"
                 return S_OK;
             }
 
-            int lengthRequired{};
             // The worst ratio of UTF-8 code units to UTF-16 code units is 1 to 1 if UTF-8 consists of ASCII only.
-            RETURN_HR_IF(E_ABORT, !base::MakeCheckedNum(in.length()).AssignIfValid(&lengthRequired));
             out.resize(in.length()); // avoid to call MultiByteToWideChar twice only to get the required size
-            const int lengthOut = MultiByteToWideChar(gsl::narrow_cast<UINT>(CP_UTF8), 0ul, in.data(), lengthRequired, out.data(), lengthRequired);
-            out.resize(gsl::narrow_cast<size_t>(lengthOut));
+
+            const auto asciiLength = details::u8u16_ascii(in, out.data());
+            if (asciiLength == in.length())
+            {
+                return S_OK;
+            }
+
+            // ASCII never occurs inside of a multi-byte sequence, so the remainder starts at a code point boundary.
+            const auto remaining = in.substr(asciiLength);
+            int lengthRequired{};
+            RETURN_HR_IF(E_ABORT, !base::MakeCheckedNum(remaining.length()).AssignIfValid(&lengthRequired));
+            const int lengthOut = MultiByteToWideChar(gsl::narrow_cast<UINT>(CP_UTF8), 0ul, remaining.data(), lengthRequired, out.data() + asciiLength, lengthRequired);
+            out.resize(asciiLength + gsl::narrow_cast<size_t>(lengthOut));
 
             return lengthOut == 0 ? E_UNEXPECTED : S_OK;
         }
@@ -356,8 +496,20 @@ namespace til // Terminal Implementation Library. Also: "Today I Learned"
             // Thus, the worst ratio of UTF-16 code units to UTF-8 code units is 1 to 3.
             RETURN_HR_IF(E_ABORT, !base::MakeCheckedNum(in.length()).AssignIfValid(&lengthIn) || !base::CheckMul(lengthIn, 3).AssignIfValid(&lengthRequired));
             out.resize(gsl::narrow_cast<size_t>(lengthRequired)); // avoid to call WideCharToMultiByte twice only to get the required size
-            const int lengthOut = WideCharToMultiByte(gsl::narrow_cast<UINT>(CP_UTF8), 0ul, in.data(), lengthIn, out.data(), lengthRequired, nullptr, nullptr);
-            out.resize(gsl::narrow_cast<size_t>(lengthOut));
+
+            const auto asciiLength = details::u16u8_ascii(in, out.data());
+            if (asciiLength == in.length())
+            {
+                out.resize(asciiLength);
+                return S_OK;
+            }
+
+            // The remainder starts at a non-ASCII code unit and thus, at a code point boundary.
+            const auto remaining = in.substr(asciiLength);
+            lengthIn = gsl::narrow_cast<int>(remaining.length());
+            lengthRequired = lengthIn * 3;
+            const int lengthOut = WideCharToMultiByte(gsl::narrow_cast<UINT>(CP_UTF8), 0ul, remaining.data(), lengthIn, out.data() + asciiLength, lengthRequired, nullptr, nullptr);
+            out.resize(asciiLength + gsl::narrow_cast<size_t>(lengthOut));
 
             return lengthOut == 0 ? E_UNEXPECTED : S_OK;
         }
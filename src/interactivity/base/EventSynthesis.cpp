@@ -44,8 +44,56 @@ static CodepointWidth GetQuickCharWidthLegacyForNumpadEventSynthesis(const wchar
     return CodepointWidth::Invalid;
 }
 
+// Routine Description:
+// - Wraps key records into KeyEvents.
+// Arguments:
+// - records - the key records to wrap
+// Return Value:
+// - deque of KeyEvents, one for each record
+// Note:
+// - will throw exception on error
+static std::deque<std::unique_ptr<KeyEvent>> _ToKeyEvents(const std::vector<INPUT_RECORD>& records)
+{
+    std::deque<std::unique_ptr<KeyEvent>> keyEvents;
+    for (const auto& record : records)
+    {
+        keyEvents.push_back(std::make_unique<KeyEvent>(record.Event.KeyEvent));
+    }
+    return keyEvents;
+}
+
+static void _AppendKeyRecord(std::vector<INPUT_RECORD>& records,
+                             const bool keyDown,
+                             const WORD virtualKeyCode,
+                             const WORD virtualScanCode,
+                             const wchar_t charData,
+                             const DWORD activeModifierKeys)
+{
+    records.push_back(KeyEvent{ keyDown, 1, virtualKeyCode, virtualScanCode, charData, activeModifierKeys }.ToInputRecord());
+}
+
 std::deque<std::unique_ptr<KeyEvent>> Microsoft::Console::Interactivity::CharToKeyEvents(const wchar_t wch,
                                                                                          const unsigned int codepage)
+{
+    std::vector<INPUT_RECORD> records;
+    CharToKeyRecords(wch, codepage, records);
+    return _ToKeyEvents(records);
+}
+
+// Routine Description:
+// - converts a wchar_t into a series of key records as if it was typed
+// using the keyboard, or using alt + numpad if it isn't on the keyboard.
+// Arguments:
+// - wch - the wchar_t to convert
+// - codepage - the codepage to use for alt + numpad input
+// - records - the key records are appended to this
+// Return Value:
+// - <none>
+// Note:
+// - will throw exception on error
+void Microsoft::Console::Interactivity::CharToKeyRecords(const wchar_t wch,
+                                                         const unsigned int codepage,
+                                                         std::vector<INPUT_RECORD>& records)
 {
     const short invalidKey = -1;
     short keyState = VkKeyScanW(wch);
@@ -65,13 +113,14 @@ std::deque<std::unique_ptr<KeyEvent>> Microsoft::Console::Interactivity::CharToK
                 // It wasn't alphanumeric or determined to be wide by the old algorithm
                 // if VkKeyScanW fails (char is not in kbd layout), we must
                 // emulate the key being input through the numpad
-                return SynthesizeNumpadEvents(wch, codepage);
+                SynthesizeNumpadRecords(wch, codepage, records);
+                return;
             }
         }
-        keyState = 0; // SynthesizeKeyboardEvents would rather get 0 than -1
+        keyState = 0; // SynthesizeKeyboardRecords would rather get 0 than -1
     }
 
-    return SynthesizeKeyboardEvents(wch, keyState);
+    SynthesizeKeyboardRecords(wch, keyState, records);
 }
 
 // Routine Description:
@@ -84,33 +133,50 @@ std::deque<std::unique_ptr<KeyEvent>> Microsoft::Console::Interactivity::CharToK
 // Note:
 // - will throw exception on error
 std::deque<std::unique_ptr<KeyEvent>> Microsoft::Console::Interactivity::SynthesizeKeyboardEvents(const wchar_t wch, const short keyState)
+{
+    std::vector<INPUT_RECORD> records;
+    SynthesizeKeyboardRecords(wch, keyState, records);
+    return _ToKeyEvents(records);
+}
+
+// Routine Description:
+// - converts a wchar_t into a series of key records as if it was typed
+// using the keyboard
+// Arguments:
+// - wch - the wchar_t to convert
+// - keyState - the virtual key and modifiers, as returned by VkKeyScanW
+// - records - the key records are appended to this
+// Return Value:
+// - <none>
+// Note:
+// - will throw exception on error
+void Microsoft::Console::Interactivity::SynthesizeKeyboardRecords(const wchar_t wch, const short keyState, std::vector<INPUT_RECORD>& records)
 {
     const byte modifierState = HIBYTE(keyState);
 
     bool altGrSet = false;
     bool shiftSet = false;
-    std::deque<std::unique_ptr<KeyEvent>> keyEvents;
 
     // add modifier key event if necessary
     if (WI_AreAllFlagsSet(modifierState, VkKeyScanModState::CtrlAndAltPressed))
     {
         altGrSet = true;
-        keyEvents.push_back(std::make_unique<KeyEvent>(true,
-                                                       1ui16,
-                                                       static_cast<WORD>(VK_MENU),
-                                                       altScanCode,
-                                                       UNICODE_NULL,
-                                                       (ENHANCED_KEY | LEFT_CTRL_PRESSED | RIGHT_ALT_PRESSED)));
+        _AppendKeyRecord(records,
+                         true,
+                         static_cast<WORD>(VK_MENU),
+                         altScanCode,
+                         UNICODE_NULL,
+                         (ENHANCED_KEY | LEFT_CTRL_PRESSED | RIGHT_ALT_PRESSED));
     }
     else if (WI_IsFlagSet(modifierState, VkKeyScanModState::ShiftPressed))
     {
         shiftSet = true;
-        keyEvents.push_back(std::make_unique<KeyEvent>(true,
-                                                       1ui16,
-                                                       static_cast<WORD>(VK_SHIFT),
-                                                       leftShiftScanCode,
-                                                       UNICODE_NULL,
-                                                       SHIFT_PRESSED));
+        _AppendKeyRecord(records,
+                         true,
+                         static_cast<WORD>(VK_SHIFT),
+                         leftShiftScanCode,
+                         UNICODE_NULL,
+                         SHIFT_PRESSED);
     }
 
     const auto vk = LOBYTE(keyState);
@@ -132,31 +198,29 @@ std::deque<std::unique_ptr<KeyEvent>> Microsoft::Console::Interactivity::Synthes
     }
 
     // add key event down and up
-    keyEvents.push_back(std::make_unique<KeyEvent>(keyEvent));
+    records.push_back(keyEvent.ToInputRecord());
     keyEvent.SetKeyDown(false);
-    keyEvents.push_back(std::make_unique<KeyEvent>(keyEvent));
+    records.push_back(keyEvent.ToInputRecord());
 
     // add modifier key up event
     if (altGrSet)
     {
-        keyEvents.push_back(std::make_unique<KeyEvent>(false,
-                                                       1ui16,
-                                                       static_cast<WORD>(VK_MENU),
-                                                       altScanCode,
-                                                       UNICODE_NULL,
-                                                       ENHANCED_KEY));
+        _AppendKeyRecord(records,
+                         false,
+                         static_cast<WORD>(VK_MENU),
+                         altScanCode,
+                         UNICODE_NULL,
+                         ENHANCED_KEY);
     }
     else if (shiftSet)
     {
-        keyEvents.push_back(std::make_unique<KeyEvent>(false,
-                                                       1ui16,
-                                                       static_cast<WORD>(VK_SHIFT),
-                                                       leftShiftScanCode,
-                                                       UNICODE_NULL,
-                                                       0));
+        _AppendKeyRecord(records,
+                         false,
+                         static_cast<WORD>(VK_SHIFT),
+                         leftShiftScanCode,
+                         UNICODE_NULL,
+                         0);
     }
-
-    return keyEvents;
 }
 
 // Routine Description:
@@ -171,15 +235,31 @@ std::deque<std::unique_ptr<KeyEvent>> Microsoft::Console::Interactivity::Synthes
 // - will throw exception on error
 std::deque<std::unique_ptr<KeyEvent>> Microsoft::Console::Interactivity::SynthesizeNumpadEvents(const wchar_t wch, const unsigned int codepage)
 {
-    std::deque<std::unique_ptr<KeyEvent>> keyEvents;
+    std::vector<INPUT_RECORD> records;
+    SynthesizeNumpadRecords(wch, codepage, records);
+    return _ToKeyEvents(records);
+}
 
+// Routine Description:
+// - converts a wchar_t into a series of key records as if it was typed
+// using Alt + numpad
+// Arguments:
+// - wch - the wchar_t to convert
+// - codepage - the codepage to look the character up in
+// - records - the key records are appended to this
+// Return Value:
+// - <none>
+// Note:
+// - will throw exception on error
+void Microsoft::Console::Interactivity::SynthesizeNumpadRecords(const wchar_t wch, const unsigned int codepage, std::vector<INPUT_RECORD>& records)
+{
     //alt keydown
-    keyEvents.push_back(std::make_unique<KeyEvent>(true,
-                                                   1ui16,
-                                                   static_cast<WORD>(VK_MENU),
-                                                   altScanCode,
-                                                   UNICODE_NULL,
-                                                   LEFT_ALT_PRESSED));
+    _AppendKeyRecord(records,
+                     true,
+                     static_cast<WORD>(VK_MENU),
+                     altScanCode,
+                     UNICODE_NULL,
+                     LEFT_ALT_PRESSED);
 
     std::wstring wstr{ wch };
     const auto convertedChars = ConvertToA(codepage, wstr);
@@ -206,27 +286,26 @@ std::deque<std::unique_ptr<KeyEvent>> Microsoft::Console::Interactivity::Synthes
             const WORD virtualKey = ch - '0' + VK_NUMPAD0;
             const WORD virtualScanCode = gsl::narrow<WORD>(MapVirtualKeyW(virtualKey, MAPVK_VK_TO_VSC));
 
-            keyEvents.push_back(std::make_unique<KeyEvent>(true,
-                                                           1ui16,
-                                                           virtualKey,
-                                                           virtualScanCode,
-                                                           UNICODE_NULL,
-                                                           LEFT_ALT_PRESSED));
-            keyEvents.push_back(std::make_unique<KeyEvent>(false,
-                                                           1ui16,
-                                                           virtualKey,
-                                                           virtualScanCode,
-                                                           UNICODE_NULL,
-                                                           LEFT_ALT_PRESSED));
+            _AppendKeyRecord(records,
+                             true,
+                             virtualKey,
+                             virtualScanCode,
+                             UNICODE_NULL,
+                             LEFT_ALT_PRESSED);
+            _AppendKeyRecord(records,
+                             false,
+                             virtualKey,
+                             virtualScanCode,
+                             UNICODE_NULL,
+                             LEFT_ALT_PRESSED);
         }
     }
 
     // alt keyup
-    keyEvents.push_back(std::make_unique<KeyEvent>(false,
-                                                   1ui16,
-                                                   static_cast<WORD>(VK_MENU),
-                                                   altScanCode,
-                                                   wch,
-                                                   0));
-    return keyEvents;
+    _AppendKeyRecord(records,
+                     false,
+                     static_cast<WORD>(VK_MENU),
+                     altScanCode,
+                     wch,
+                     0);
 }
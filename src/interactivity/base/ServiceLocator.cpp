@@ -67,6 +67,13 @@ void ServiceLocator::RundownAndExit(const HRESULT hr)
         s_inputServices.reset(nullptr);
     }
 
+    // If the console lock is being profiled, this is the last chance to say
+    // what was measured.
+    if (const auto profiler = s_globals.getConsoleInformation().GetLockProfiler())
+    {
+        LOG_IF_FAILED(profiler->WriteReport());
+    }
+
     TerminateProcess(GetCurrentProcess(), hr);
 }
 
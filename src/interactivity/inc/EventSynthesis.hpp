@@ -16,6 +16,7 @@ Author:
 #pragma once
 #include <deque>
 #include <memory>
+#include <vector>
 #include "../../types/inc/IInputEvent.hpp"
 
 namespace Microsoft::Console::Interactivity
@@ -26,4 +27,12 @@ namespace Microsoft::Console::Interactivity
                                                                    const short keyState);
 
     std::deque<std::unique_ptr<KeyEvent>> SynthesizeNumpadEvents(const wchar_t wch, const unsigned int codepage);
+
+    // These append INPUT_RECORDs instead, which avoids allocating an event
+    // per key when converting a lot of text.
+    void CharToKeyRecords(const wchar_t wch, const unsigned int codepage, std::vector<INPUT_RECORD>& records);
+
+    void SynthesizeKeyboardRecords(const wchar_t wch, const short keyState, std::vector<INPUT_RECORD>& records);
+
+    void SynthesizeNumpadRecords(const wchar_t wch, const unsigned int codepage, std::vector<INPUT_RECORD>& records);
 }
@@ -108,8 +108,10 @@ void Clipboard::StringPaste(_In_reads_(cchData) const wchar_t* const pData,
 
     try
     {
-        std::deque<std::unique_ptr<IInputEvent>> inEvents = TextToKeyEvents(pData, cchData);
-        gci.pInputBuffer->Write(inEvents);
+        // The whole paste is written at once, instead of as one event
+        // (and allocation) per key stroke.
+        const auto inRecords = TextToKeyEvents(pData, cchData);
+        gci.pInputBuffer->Write(inRecords);
     }
     catch (...)
     {
@@ -122,21 +124,25 @@ void Clipboard::StringPaste(_In_reads_(cchData) const wchar_t* const pData,
 #pragma region Private Methods
 
 // Routine Description:
-// - converts a wchar_t* into a series of KeyEvents as if it was typed
+// - converts a wchar_t* into a series of key records as if it was typed
 // from the keyboard
 // Arguments:
 // - pData - the text to convert
 // - cchData - the size of pData, in wchars
 // Return Value:
-// - deque of KeyEvents that represent the string passed in
+// - the key records that represent the string passed in
 // Note:
 // - will throw exception on error
-std::deque<std::unique_ptr<IInputEvent>> Clipboard::TextToKeyEvents(_In_reads_(cchData) const wchar_t* const pData,
-                                                                    const size_t cchData)
+std::vector<INPUT_RECORD> Clipboard::TextToKeyEvents(_In_reads_(cchData) const wchar_t* const pData,
+                                                     const size_t cchData)
 {
     THROW_HR_IF_NULL(E_INVALIDARG, pData);
 
-    std::deque<std::unique_ptr<IInputEvent>> keyEvents;
+    const UINT codepage = ServiceLocator::LocateGlobals().getConsoleInformation().OutputCP;
+
+    // Most characters are typed with a key down and up.
+    std::vector<INPUT_RECORD> keyRecords;
+    keyRecords.reserve(cchData * 2);
 
     for (size_t i = 0; i < cchData; ++i)
     {
@@ -174,15 +180,9 @@ std::deque<std::unique_ptr<IInputEvent>> Clipboard::TextToKeyEvents(_In_reads_(c
             currentChar = UNICODE_CARRIAGERETURN;
         }
 
-        const UINT codepage = ServiceLocator::LocateGlobals().getConsoleInformation().OutputCP;
-        std::deque<std::unique_ptr<KeyEvent>> convertedEvents = CharToKeyEvents(currentChar, codepage);
-        while (!convertedEvents.empty())
-        {
-            keyEvents.push_back(std::move(convertedEvents.front()));
-            convertedEvents.pop_front();
-        }
+        CharToKeyRecords(currentChar, codepage, keyRecords);
     }
-    return keyEvents;
+    return keyRecords;
 }
 
 // Routine Description:
@@ -64,7 +64,10 @@ const RegistrySerialization::_RegPropertyMap RegistrySerialization::s_PropertyMa
     { _RegPropertyType::Dword,          CONSOLE_REGISTRY_DEFAULTBACKGROUND,             SET_FIELD_AND_SIZE(_DefaultBackground)           },
     { _RegPropertyType::Boolean,        CONSOLE_REGISTRY_TERMINALSCROLLING,             SET_FIELD_AND_SIZE(_TerminalScrolling)           },
     { _RegPropertyType::Boolean,        CONSOLE_REGISTRY_USEDX,                         SET_FIELD_AND_SIZE(_fUseDx)                      },
-    { _RegPropertyType::Boolean,        CONSOLE_REGISTRY_COPYCOLOR,                     SET_FIELD_AND_SIZE(_fCopyColor)                  }
+    { _RegPropertyType::Boolean,        CONSOLE_REGISTRY_COPYCOLOR,                     SET_FIELD_AND_SIZE(_fCopyColor)                  },
+    { _RegPropertyType::Dword,          CONSOLE_REGISTRY_FRAMERATELIMIT,                SET_FIELD_AND_SIZE(_dwFrameRateLimit)            },
+    { _RegPropertyType::Dword,          CONSOLE_REGISTRY_FLOODTHRESHOLD,                SET_FIELD_AND_SIZE(_dwFloodThreshold)            },
+    { _RegPropertyType::Dword,          CONSOLE_REGISTRY_FLOODFRAMERATE,                SET_FIELD_AND_SIZE(_dwFloodFrameRate)            }
 
 };
 const size_t RegistrySerialization::s_PropertyMappingsSize = ARRAYSIZE(s_PropertyMappings);
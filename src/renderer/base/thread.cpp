@@ -166,6 +166,8 @@ DWORD WINAPI RenderThread::s_ThreadProc(_In_ LPVOID lpParameter)
 
 DWORD WINAPI RenderThread::_ThreadProc()
 {
+    DWORD sleptMilliseconds = 0;
+
     while (_fKeepRunning)
     {
         WaitForSingleObject(_hPaintEnabledEvent, INFINITE);
@@ -182,8 +184,15 @@ DWORD WINAPI RenderThread::_ThreadProc()
             // check again now (see comment above)
             if (!_fNextFrameRequested.exchange(false, std::memory_order_acq_rel))
             {
-                // Wait until a next frame is requested.
-                WaitForSingleObject(_hEvent, INFINITE);
+                // Wait until a next frame is requested. While flooded we only
+                // wait for so long: if nothing shows up in that time, the output
+                // went idle and we go back to painting immediately.
+                const auto timeout = _fFloodMode.load(std::memory_order_relaxed) ? s_FloodIdleMilliseconds : INFINITE;
+                if (WaitForSingleObject(_hEvent, timeout) == WAIT_TIMEOUT)
+                {
+                    _fFloodMode.store(false, std::memory_order_relaxed);
+                    WaitForSingleObject(_hEvent, INFINITE);
+                }
             }
 
             // <--
@@ -209,6 +218,10 @@ DWORD WINAPI RenderThread::_ThreadProc()
 
         ResetEvent(_hPaintCompletedEvent);
 
+        const auto now = std::chrono::steady_clock::now();
+        _CountFrame(now, sleptMilliseconds);
+        _UpdateFloodState(now);
+
         _pRenderer->WaitUntilCanRender();
         LOG_IF_FAILED(_pRenderer->PaintFrame());
 
@@ -217,7 +230,8 @@ DWORD WINAPI RenderThread::_ThreadProc()
         // extra check before we sleep since it's a "long" activity, relatively speaking.
         if (_fKeepRunning)
         {
-            Sleep(s_FrameLimitMilliseconds);
+            sleptMilliseconds = _GetFrameIntervalMilliseconds();
+            Sleep(sleptMilliseconds);
         }
     }
 
@@ -226,6 +240,16 @@ DWORD WINAPI RenderThread::_ThreadProc()
 
 void RenderThread::NotifyPaint()
 {
+    _notifyCount.fetch_add(1, std::memory_order_relaxed);
+
+    // Only the first request after a frame needs the time, so that we don't
+    // read the clock on every call while flooded.
+    if (!_pendingSince.load(std::memory_order_relaxed))
+    {
+        std::chrono::steady_clock::rep expected = 0;
+        _pendingSince.compare_exchange_strong(expected, std::chrono::steady_clock::now().time_since_epoch().count(), std::memory_order_relaxed);
+    }
+
     if (_fWaiting.load(std::memory_order_acquire))
     {
         SetEvent(_hEvent);
@@ -236,6 +260,134 @@ void RenderThread::NotifyPaint()
     }
 }
 
+// Method Description:
+// - Caps the rate at which we'll paint frames while we're not flooded.
+// Arguments:
+// - fps: the maximum number of frames per second. 0 restores the default.
+// Return Value:
+// - <none>
+void RenderThread::SetFrameRateLimit(const UINT fps) noexcept
+{
+    _frameIntervalMs.store(fps ? std::max<DWORD>(1000 / fps, 1) : s_FrameLimitMilliseconds, std::memory_order_relaxed);
+}
+
+// Method Description:
+// - Configures flood detection. When paint requests come in faster than
+//   the given threshold, we drop to a low fixed cadence and let the requests
+//   in between coalesce into the next frame. We leave flood mode again once
+//   the output goes idle or the request rate falls well below the threshold.
+// Arguments:
+// - notifyThresholdPerSecond: paint requests per second after which we
+//   consider ourselves flooded. 0 disables flood detection.
+// - floodFps: the frame rate to paint at while flooded. 0 restores the default.
+// Return Value:
+// - <none>
+void RenderThread::SetFloodMode(const UINT notifyThresholdPerSecond, const UINT floodFps) noexcept
+{
+    _floodFrameIntervalMs.store(floodFps ? std::max<DWORD>(1000 / floodFps, 1) : s_FloodFrameLimitMilliseconds, std::memory_order_relaxed);
+    _floodThreshold.store(notifyThresholdPerSecond, std::memory_order_relaxed);
+    if (!notifyThresholdPerSecond)
+    {
+        _fFloodMode.store(false, std::memory_order_relaxed);
+    }
+}
+
+// Method Description:
+// - Returns the number of frames painted and skipped so far and whether
+//   we're currently painting at the reduced flood cadence.
+// Arguments:
+// - <none>
+// Return Value:
+// - A snapshot of the frame counters.
+RenderThread::FrameCounters RenderThread::GetFrameCounters() const noexcept
+{
+    return {
+        _framesPainted.load(std::memory_order_relaxed),
+        _framesSkipped.load(std::memory_order_relaxed),
+        _fFloodMode.load(std::memory_order_relaxed),
+    };
+}
+
+// Method Description:
+// - Returns how long to sleep after a frame before we may paint the next one.
+DWORD RenderThread::_GetFrameIntervalMilliseconds() const noexcept
+{
+    return _fFloodMode.load(std::memory_order_relaxed) ?
+               _floodFrameIntervalMs.load(std::memory_order_relaxed) :
+               _frameIntervalMs.load(std::memory_order_relaxed);
+}
+
+// Method Description:
+// - Called on the render thread before each frame. Counts the frame and,
+//   if we just slept longer than the normal frame interval, the frames we
+//   would have painted at the normal cadence while a request waited for
+//   this one. Waiting for a request to show up at all skips nothing.
+// Arguments:
+// - now: the time this frame starts.
+// - sleptMilliseconds: how long we slept after the previous frame.
+// Return Value:
+// - <none>
+void RenderThread::_CountFrame(const std::chrono::steady_clock::time_point now, const DWORD sleptMilliseconds) noexcept
+{
+    _framesPainted.fetch_add(1, std::memory_order_relaxed);
+
+    const auto pendingSince = _pendingSince.exchange(0, std::memory_order_relaxed);
+    const auto frameInterval = _frameIntervalMs.load(std::memory_order_relaxed);
+    if (!pendingSince || sleptMilliseconds <= frameInterval)
+    {
+        return;
+    }
+
+    const auto waited = now - std::chrono::steady_clock::time_point{ std::chrono::steady_clock::duration{ pendingSince } };
+    const auto waitedMilliseconds = std::chrono::duration_cast<std::chrono::milliseconds>(waited).count();
+    if (waitedMilliseconds > 0)
+    {
+        _framesSkipped.fetch_add(gsl::narrow_cast<uint64_t>(waitedMilliseconds) / frameInterval, std::memory_order_relaxed);
+    }
+}
+
+// Method Description:
+// - Called on the render thread before each frame. Accounts the paint
+//   requests that are folded into this frame and, once per sample period,
+//   compares the request rate against the flood threshold.
+// Arguments:
+// - now: the time this frame starts.
+// Return Value:
+// - <none>
+void RenderThread::_UpdateFloodState(const std::chrono::steady_clock::time_point now) noexcept
+{
+    const auto requests = _notifyCount.exchange(0, std::memory_order_relaxed);
+
+    const auto threshold = _floodThreshold.load(std::memory_order_relaxed);
+    if (!threshold)
+    {
+        return;
+    }
+
+    _sampleNotifyCount += requests;
+
+    const auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(now - _sampleStart).count();
+    if (elapsed < s_FloodSampleMilliseconds)
+    {
+        return;
+    }
+
+    const auto rate = _sampleNotifyCount * 1000 / gsl::narrow_cast<uint64_t>(elapsed);
+    if (rate >= threshold)
+    {
+        _fFloodMode.store(true, std::memory_order_relaxed);
+    }
+    else if (rate < threshold / 4)
+    {
+        // Some hysteresis, so that we don't flip back and forth right
+        // around the threshold.
+        _fFloodMode.store(false, std::memory_order_relaxed);
+    }
+
+    _sampleNotifyCount = 0;
+    _sampleStart = now;
+}
+
 void RenderThread::EnablePainting()
 {
     SetEvent(_hPaintEnabledEvent);
@@ -33,11 +33,29 @@ namespace Microsoft::Console::Render
         void DisablePainting() override;
         void WaitForPaintCompletionAndDisable(const DWORD dwTimeoutMs) override;
 
+        struct FrameCounters
+        {
+            uint64_t framesPainted;
+            uint64_t framesSkipped;
+            bool floodMode;
+        };
+
+        void SetFrameRateLimit(const UINT fps) noexcept;
+        void SetFloodMode(const UINT notifyThresholdPerSecond, const UINT floodFps) noexcept;
+        FrameCounters GetFrameCounters() const noexcept;
+
     private:
         static DWORD WINAPI s_ThreadProc(_In_ LPVOID lpParameter);
         DWORD WINAPI _ThreadProc();
 
+        DWORD _GetFrameIntervalMilliseconds() const noexcept;
+        void _CountFrame(const std::chrono::steady_clock::time_point now, const DWORD sleptMilliseconds) noexcept;
+        void _UpdateFloodState(const std::chrono::steady_clock::time_point now) noexcept;
+
         static DWORD const s_FrameLimitMilliseconds = 8;
+        static DWORD const s_FloodFrameLimitMilliseconds = 100;
+        static DWORD const s_FloodIdleMilliseconds = 250;
+        static DWORD const s_FloodSampleMilliseconds = 100;
 
         HANDLE _hThread;
         HANDLE _hEvent;
@@ -50,5 +68,29 @@ namespace Microsoft::Console::Render
         bool _fKeepRunning;
         std::atomic<bool> _fNextFrameRequested;
         std::atomic<bool> _fWaiting;
+
+        // Frame pacing. All of these may be changed from other threads while
+        // the render thread is running, so they're atomics.
+        std::atomic<DWORD> _frameIntervalMs{ s_FrameLimitMilliseconds };
+        std::atomic<DWORD> _floodFrameIntervalMs{ s_FloodFrameLimitMilliseconds };
+        std::atomic<UINT> _floodThreshold{ 0 }; // 0 disables flood detection
+        std::atomic<bool> _fFloodMode{ false };
+
+        // Every call to NotifyPaint bumps this. The render thread drains it
+        // once per frame to measure the request rate.
+        std::atomic<uint64_t> _notifyCount{ 0 };
+        // When the oldest paint request the next frame will satisfy was made,
+        // as a steady_clock tick count. 0 if there is none.
+        std::atomic<std::chrono::steady_clock::rep> _pendingSince{ 0 };
+        std::atomic<uint64_t> _framesPainted{ 0 };
+        std::atomic<uint64_t> _framesSkipped{ 0 };
+
+        // Only touched by the render thread.
+        uint64_t _sampleNotifyCount{ 0 };
+        std::chrono::steady_clock::time_point _sampleStart{ std::chrono::steady_clock::now() };
+
+#ifdef UNIT_TESTING
+        friend class RenderThreadTests;
+#endif
     };
 }
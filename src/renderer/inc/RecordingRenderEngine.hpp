@@ -0,0 +1,264 @@
+/*++
+Copyright (c) Microsoft Corporation
+Licensed under the MIT license.
+
+Module Name:
+- RecordingRenderEngine.hpp
+
+Abstract:
+- A headless implementation of IRenderEngine. It doesn't draw anything, but
+  counts every call the Renderer makes into it and can optionally record the
+  clusters and brushes it was asked to paint.
+- This lets us measure the parse -> buffer -> render pipeline without a
+  window, and lets tests inspect what a frame would have looked like.
+--*/
+
+#pragma once
+
+#include "RenderEngineBase.hpp"
+
+namespace Microsoft::Console::Render
+{
+    class RecordingRenderEngine final : public RenderEngineBase
+    {
+    public:
+        struct Counters
+        {
+            size_t frames;
+            size_t skippedFrames;
+            size_t invalidates;
+            size_t scrolls;
+            size_t paintedLines;
+            size_t paintedClusters;
+            size_t brushChanges;
+            size_t cursorPaints;
+            size_t selectionPaints;
+            size_t gridLinePaints;
+        };
+
+        struct RecordedLine
+        {
+            COORD coord;
+            TextAttribute attributes;
+            std::wstring text;
+        };
+
+        RecordingRenderEngine(const bool record = false) noexcept :
+            _record{ record }
+        {
+        }
+
+        const Counters& GetCounters() const noexcept
+        {
+            return _counters;
+        }
+
+        // The lines painted during the last frame. Only populated when
+        // recording was requested at construction.
+        const std::vector<RecordedLine>& GetLastFrame() const noexcept
+        {
+            return _lastFrame;
+        }
+
+        void ResetCounters() noexcept
+        {
+            _counters = {};
+        }
+
+        [[nodiscard]] HRESULT StartPaint() noexcept override
+        {
+            if (_invalidArea.empty() && !_titleChanged)
+            {
+                ++_counters.skippedFrames;
+                return S_FALSE;
+            }
+
+            ++_counters.frames;
+            _lastFrame.clear();
+            return S_OK;
+        }
+
+        [[nodiscard]] HRESULT EndPaint() noexcept override
+        {
+            _invalidArea = {};
+            return S_OK;
+        }
+
+        [[nodiscard]] HRESULT Present() noexcept override
+        {
+            return S_FALSE;
+        }
+
+        [[nodiscard]] HRESULT PrepareForTeardown(_Out_ bool* const pForcePaint) noexcept override
+        {
+            *pForcePaint = false;
+            return S_FALSE;
+        }
+
+        [[nodiscard]] HRESULT ScrollFrame() noexcept override
+        {
+            return S_OK;
+        }
+
+        [[nodiscard]] HRESULT Invalidate(const SMALL_RECT* const psrRegion) noexcept override
+        try
+        {
+            ++_counters.invalidates;
+            _invalidArea |= til::rectangle{ *psrRegion };
+            return S_OK;
+        }
+        CATCH_RETURN();
+
+        [[nodiscard]] HRESULT InvalidateCursor(const SMALL_RECT* const psrRegion) noexcept override
+        {
+            return Invalidate(psrRegion);
+        }
+
+        [[nodiscard]] HRESULT InvalidateSystem(const RECT* const /*prcDirtyClient*/) noexcept override
+        {
+            return InvalidateAll();
+        }
+
+        [[nodiscard]] HRESULT InvalidateSelection(const std::vector<SMALL_RECT>& rectangles) noexcept override
+        {
+            for (const auto& rect : rectangles)
+            {
+                RETURN_IF_FAILED(Invalidate(&rect));
+            }
+            return S_OK;
+        }
+
+        [[nodiscard]] HRESULT InvalidateScroll(const COORD* const /*pcoordDelta*/) noexcept override
+        {
+            ++_counters.scrolls;
+            return InvalidateAll();
+        }
+
+        [[nodiscard]] HRESULT InvalidateAll() noexcept override
+        {
+            ++_counters.invalidates;
+            _invalidArea = til::rectangle{ til::size{ _viewport.Width(), _viewport.Height() } };
+            return S_OK;
+        }
+
+        [[nodiscard]] HRESULT InvalidateCircling(_Out_ bool* const pForcePaint) noexcept override
+        {
+            *pForcePaint = false;
+            return S_FALSE;
+        }
+
+        [[nodiscard]] HRESULT PaintBackground() noexcept override
+        {
+            return S_OK;
+        }
+
+        [[nodiscard]] HRESULT PaintBufferLine(gsl::span<const Cluster> const clusters,
+                                              const COORD coord,
+                                              const bool /*fTrimLeft*/,
+                                              const bool /*lineWrapped*/) noexcept override
+        try
+        {
+            ++_counters.paintedLines;
+            _counters.paintedClusters += clusters.size();
+
+            if (_record)
+            {
+                auto& line = _lastFrame.emplace_back(RecordedLine{ coord, _lastAttributes, {} });
+                for (const auto& cluster : clusters)
+                {
+                    line.text.append(cluster.GetText());
+                }
+            }
+            return S_OK;
+        }
+        CATCH_RETURN();
+
+        [[nodiscard]] HRESULT PaintBufferGridLines(const GridLines /*lines*/,
+                                                   const COLORREF /*color*/,
+                                                   const size_t /*cchLine*/,
+                                                   const COORD /*coordTarget*/) noexcept override
+        {
+            ++_counters.gridLinePaints;
+            return S_OK;
+        }
+
+        [[nodiscard]] HRESULT PaintSelection(const SMALL_RECT /*rect*/) noexcept override
+        {
+            ++_counters.selectionPaints;
+            return S_OK;
+        }
+
+        [[nodiscard]] HRESULT PaintCursor(const CursorOptions& /*options*/) noexcept override
+        {
+            ++_counters.cursorPaints;
+            return S_OK;
+        }
+
+        [[nodiscard]] HRESULT UpdateDrawingBrushes(const TextAttribute& textAttributes,
+                                                   const gsl::not_null<IRenderData*> /*pData*/,
+                                                   const bool /*isSettingDefaultBrushes*/) noexcept override
+        {
+            ++_counters.brushChanges;
+            _lastAttributes = textAttributes;
+            return S_OK;
+        }
+
+        [[nodiscard]] HRESULT UpdateFont(const FontInfoDesired& /*FontInfoDesired*/,
+                                         _Out_ FontInfo& /*FontInfo*/) noexcept override
+        {
+            return S_OK;
+        }
+
+        [[nodiscard]] HRESULT UpdateDpi(const int /*iDpi*/) noexcept override
+        {
+            return S_OK;
+        }
+
+        [[nodiscard]] HRESULT UpdateViewport(const SMALL_RECT srNewViewport) noexcept override
+        {
+            const auto newViewport = Microsoft::Console::Types::Viewport::FromInclusive(srNewViewport);
+            const auto resized = newViewport.Dimensions() != _viewport.Dimensions();
+            _viewport = newViewport;
+            return resized ? InvalidateAll() : S_OK;
+        }
+
+        [[nodiscard]] HRESULT GetProposedFont(const FontInfoDesired& /*FontInfoDesired*/,
+                                              _Out_ FontInfo& /*FontInfo*/,
+                                              const int /*iDpi*/) noexcept override
+        {
+            return S_OK;
+        }
+
+        [[nodiscard]] HRESULT GetDirtyArea(gsl::span<const til::rectangle>& area) noexcept override
+        {
+            area = { &_invalidArea, 1 };
+            return S_OK;
+        }
+
+        [[nodiscard]] HRESULT GetFontSize(_Out_ COORD* const pFontSize) noexcept override
+        {
+            *pFontSize = { 1, 1 };
+            return S_OK;
+        }
+
+        [[nodiscard]] HRESULT IsGlyphWideByFont(const std::wstring_view /*glyph*/, _Out_ bool* const pResult) noexcept override
+        {
+            *pResult = false;
+            return S_OK;
+        }
+
+    protected:
+        [[nodiscard]] HRESULT _DoUpdateTitle(const std::wstring_view /*newTitle*/) noexcept override
+        {
+            return S_OK;
+        }
+
+    private:
+        const bool _record;
+        Counters _counters{};
+        Microsoft::Console::Types::Viewport _viewport{ Microsoft::Console::Types::Viewport::Empty() };
+        til::rectangle _invalidArea;
+        TextAttribute _lastAttributes;
+        std::vector<RecordedLine> _lastFrame;
+    };
+}
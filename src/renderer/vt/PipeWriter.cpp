@@ -0,0 +1,171 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#include "precomp.h"
+
+#include "PipeWriter.hpp"
+
+#pragma hdrstop
+
+using namespace Microsoft::Console::Render;
+
+// Routine Description:
+// - Starts the thread that writes to the given pipe.
+// - NOTE: Will throw if the thread can't be created. Caller must catch.
+// Arguments:
+// - pipe: the pipe to write to. It must outlive this object.
+PipeWriter::PipeWriter(const HANDLE pipe) :
+    _pipe{ pipe }
+{
+    _thread.reset(CreateThread(nullptr, // non-inheritable security attributes
+                               0, // use default stack size
+                               s_ThreadProc,
+                               this,
+                               0, // create immediately
+                               nullptr // we don't need the thread ID
+                               ));
+    THROW_LAST_ERROR_IF(!_thread);
+
+    // SetThreadDescription only works on 1607 and higher. If we cannot find it,
+    // then it's no big deal. Just skip setting the description.
+    auto func = GetProcAddressByFunctionDeclaration(GetModuleHandleW(L"kernel32.dll"), SetThreadDescription);
+    if (func)
+    {
+        LOG_IF_FAILED(func(_thread.get(), L"VT Renderer Pipe Writer Thread"));
+    }
+}
+
+// Routine Description:
+// - Stops the writer thread. Anything that's still pending is dropped - call
+//      Drain first to make sure it was written.
+PipeWriter::~PipeWriter()
+{
+    {
+        std::lock_guard<std::mutex> lock{ _mutex };
+        _shutdown = true;
+    }
+    _pendingAvailable.notify_one();
+
+    // If the terminal stopped reading, the thread is stuck in WriteFile. Keep
+    // cancelling that write until the thread is gone, since it might only get
+    // to the WriteFile after our first attempt.
+    do
+    {
+        CancelSynchronousIo(_thread.get());
+    } while (WaitForSingleObject(_thread.get(), s_CancelRetryMilliseconds) == WAIT_TIMEOUT);
+}
+
+// Routine Description:
+// - Hands the contents of the buffer to the writer thread, without waiting for
+//      them to be written. If the previous buffer is still pending, the new
+//      contents are appended to it.
+// Arguments:
+// - buffer: the text to write. It's empty when this returns, but may have
+//      taken over the capacity of a buffer that was already written.
+// Return Value:
+// - S_OK, or the error of a previous write that failed.
+[[nodiscard]] HRESULT PipeWriter::Write(std::string& buffer) noexcept
+try
+{
+    {
+        std::lock_guard<std::mutex> lock{ _mutex };
+        if (FAILED(_result))
+        {
+            buffer.clear();
+            return _result;
+        }
+
+        if (_pending.empty())
+        {
+            _pending.swap(buffer);
+        }
+        else
+        {
+            _pending.append(buffer);
+        }
+        buffer.clear();
+    }
+    _pendingAvailable.notify_one();
+
+    return S_OK;
+}
+CATCH_RETURN();
+
+// Routine Description:
+// - Waits until the writer thread has picked up enough of the pending text to
+//      leave at most the given number of bytes waiting behind the current write.
+//   Waiting for 0 bytes is what makes this a double buffer: the caller can
+//      fill the next buffer while the last one is being written, but no more.
+// Arguments:
+// - maxPendingBytes: how much may be left waiting.
+// Return Value:
+// - S_OK, or the error of a write that failed.
+[[nodiscard]] HRESULT PipeWriter::WaitForPending(const size_t maxPendingBytes) noexcept
+try
+{
+    std::unique_lock<std::mutex> lock{ _mutex };
+    _written.wait(lock, [&]() { return FAILED(_result) || _pending.size() <= maxPendingBytes; });
+    return _result;
+}
+CATCH_RETURN();
+
+// Routine Description:
+// - Waits until everything that was handed to Write has been written.
+// Arguments:
+// - <none>
+// Return Value:
+// - S_OK, or the error of a write that failed.
+[[nodiscard]] HRESULT PipeWriter::Drain() noexcept
+try
+{
+    std::unique_lock<std::mutex> lock{ _mutex };
+    _written.wait(lock, [&]() { return FAILED(_result) || (_pending.empty() && !_busy); });
+    return _result;
+}
+CATCH_RETURN();
+
+DWORD WINAPI PipeWriter::s_ThreadProc(_In_ LPVOID lpParameter)
+{
+    const auto pContext = static_cast<PipeWriter*>(lpParameter);
+    return pContext->_ThreadProc();
+}
+
+DWORD PipeWriter::_ThreadProc()
+{
+    while (true)
+    {
+        {
+            std::unique_lock<std::mutex> lock{ _mutex };
+            _pendingAvailable.wait(lock, [&]() { return _shutdown || !_pending.empty(); });
+            if (_shutdown)
+            {
+                return S_OK;
+            }
+
+            _writing.swap(_pending);
+            _busy = true;
+        }
+        // The pending buffer is free again.
+        _written.notify_all();
+
+        const auto fSuccess = !!WriteFile(_pipe, _writing.data(), gsl::narrow_cast<DWORD>(_writing.size()), nullptr, nullptr);
+        const auto hr = fSuccess ? S_OK : HRESULT_FROM_WIN32(GetLastError());
+        _writing.clear();
+
+        {
+            std::lock_guard<std::mutex> lock{ _mutex };
+            _busy = false;
+            if (FAILED(hr))
+            {
+                _result = hr;
+                _pending.clear();
+            }
+        }
+        _written.notify_all();
+
+        if (FAILED(hr))
+        {
+            return hr;
+        }
+    }
+}
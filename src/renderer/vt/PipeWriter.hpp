@@ -0,0 +1,60 @@
+/*++
+Copyright (c) Microsoft Corporation
+Licensed under the MIT license.
+
+Module Name:
+- PipeWriter.hpp
+
+Abstract:
+- Writes the output of the VT renderer to its pipe on a thread of its own, so
+  that a terminal that's slow to read doesn't block painting, and through the
+  console lock, the client application.
+- The renderer hands over its whole buffer at once. While one write is in
+  progress, everything handed over in the meantime is joined into a single
+  pending buffer, which goes out with the next write. The buffers are swapped
+  rather than copied, so they keep their capacity between frames.
+--*/
+
+#pragma once
+
+#include <condition_variable>
+
+namespace Microsoft::Console::Render
+{
+    class PipeWriter final
+    {
+    public:
+        PipeWriter(const HANDLE pipe);
+        ~PipeWriter();
+
+        PipeWriter(const PipeWriter&) = delete;
+        PipeWriter& operator=(const PipeWriter&) = delete;
+
+        [[nodiscard]] HRESULT Write(std::string& buffer) noexcept;
+        [[nodiscard]] HRESULT WaitForPending(const size_t maxPendingBytes) noexcept;
+        [[nodiscard]] HRESULT Drain() noexcept;
+
+    private:
+        static DWORD WINAPI s_ThreadProc(_In_ LPVOID lpParameter);
+        DWORD _ThreadProc();
+
+        static constexpr DWORD s_CancelRetryMilliseconds = 100;
+
+        HANDLE _pipe; // Non-ownership handle
+        wil::unique_handle _thread;
+
+        std::mutex _mutex;
+        std::condition_variable _pendingAvailable;
+        std::condition_variable _written;
+
+        // Both of these are guarded by _mutex, but only the writer thread
+        // touches _writing while _busy is set.
+        std::string _pending;
+        std::string _writing;
+        bool _busy{ false };
+        bool _shutdown{ false };
+
+        // Once a write failed, nothing else gets written.
+        HRESULT _result{ S_OK };
+    };
+}
@@ -95,6 +95,61 @@ using namespace Microsoft::Console::Render;
     return _WriteFormatted(FMT_COMPILE("\x1b[{}C"), chars);
 }
 
+// Method Description:
+// - Moves the cursor backward (left) a number of characters.
+// Arguments:
+// - chars: a number of characters to move cursor left by.
+// Return Value:
+// - S_OK if we succeeded, else an appropriate HRESULT for failing to allocate or write.
+[[nodiscard]] HRESULT VtEngine::_CursorBackward(const short chars) noexcept
+{
+    return _WriteFormatted(FMT_COMPILE("\x1b[{}D"), chars);
+}
+
+// Method Description:
+// - Moves the cursor up a number of lines.
+// Arguments:
+// - lines: a number of lines to move cursor up by.
+// Return Value:
+// - S_OK if we succeeded, else an appropriate HRESULT for failing to allocate or write.
+[[nodiscard]] HRESULT VtEngine::_CursorUp(const short lines) noexcept
+{
+    return _WriteFormatted(FMT_COMPILE("\x1b[{}A"), lines);
+}
+
+// Method Description:
+// - Moves the cursor down a number of lines.
+// Arguments:
+// - lines: a number of lines to move cursor down by.
+// Return Value:
+// - S_OK if we succeeded, else an appropriate HRESULT for failing to allocate or write.
+[[nodiscard]] HRESULT VtEngine::_CursorDown(const short lines) noexcept
+{
+    return _WriteFormatted(FMT_COMPILE("\x1b[{}B"), lines);
+}
+
+// Method Description:
+// - Moves the cursor to the given column of the current line (CHA).
+// Arguments:
+// - column: the column to move to, where the leftmost column is 0.
+// Return Value:
+// - S_OK if we succeeded, else an appropriate HRESULT for failing to allocate or write.
+[[nodiscard]] HRESULT VtEngine::_CursorHorizontalAbsolute(const short column) noexcept
+{
+    return _WriteFormatted(FMT_COMPILE("\x1b[{}G"), column + 1);
+}
+
+// Method Description:
+// - Moves the cursor to the given line, staying in the same column (VPA).
+// Arguments:
+// - line: the line to move to, where the top line is 0.
+// Return Value:
+// - S_OK if we succeeded, else an appropriate HRESULT for failing to allocate or write.
+[[nodiscard]] HRESULT VtEngine::_VerticalPositionAbsolute(const short line) noexcept
+{
+    return _WriteFormatted(FMT_COMPILE("\x1b[{}d"), line + 1);
+}
+
 // Method Description:
 // - Formats and writes a sequence to erase the remainder of the line starting
 //      from the cursor position.
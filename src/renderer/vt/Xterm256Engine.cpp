@@ -12,6 +12,7 @@ Xterm256Engine::Xterm256Engine(_In_ wil::unique_hfile hPipe,
                                const Viewport initialViewport) :
     XtermEngine(std::move(hPipe), initialViewport, false)
 {
+    _repeatCharacters = true;
 }
 
 // Routine Description:
@@ -170,5 +171,8 @@ HRESULT Microsoft::Console::Render::Xterm256Engine::_UpdateHyperlinkAttr(const T
 // - S_OK if we wrote the sequences successfully, otherwise an appropriate HRESULT
 [[nodiscard]] HRESULT Xterm256Engine::ManuallyClearScrollback() noexcept
 {
+    // Some terminals clear more than the scrollback for this, so don't assume
+    // that the viewport's contents survived it.
+    _ResetShadow();
     return _ClearScrollback();
 }
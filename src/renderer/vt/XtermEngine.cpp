@@ -52,6 +52,7 @@ XtermEngine::XtermEngine(_In_ wil::unique_hfile hPipe,
         //      the screen on the first paint, just to make sure that the
         //      terminal's state is consistent with what we'll be rendering.
         RETURN_IF_FAILED(_ClearScreen());
+        _ResetShadow();
         _clearedAllThisFrame = true;
         _firstPaint = false;
     }
@@ -233,6 +234,15 @@ XtermEngine::XtermEngine(_In_ wil::unique_hfile hPipe,
 // - S_OK if we succeeded, else an appropriate HRESULT for failing to allocate or write.
 [[nodiscard]] HRESULT XtermEngine::_MoveCursor(COORD const coord) noexcept
 {
+    // While ScrollFrame leaves the scrolling to us, the only move we can make
+    // across rows is to the start of the next one that scrolls in.
+    if (_deferredNewlines > 0 &&
+        coord.Y != _lastText.Y &&
+        !(coord.X == 0 && coord.Y == _lastText.Y + 1))
+    {
+        RETURN_IF_FAILED(_FinishDeferredScroll());
+    }
+
     HRESULT hr = S_OK;
     const auto originalPos = _lastText;
     _trace.TraceMoveCursor(_lastText, coord);
@@ -268,9 +278,19 @@ XtermEngine::XtermEngine(_In_ wil::unique_hfile hPipe,
             }
             else
             {
-                std::string seq = "\r\n";
+                // At the bottom of the terminal, a cursor that's still in the
+                // first column only needs the line feed to scroll.
+                std::string seq = (_deferredNewlines > 0 && _lastText.X == 0) ? "\n" : "\r\n";
                 hr = _Write(seq);
             }
+
+            // Either way, that scrolled in the row we're moving to, filled
+            // with the background we're about to paint it with.
+            if (SUCCEEDED(hr) && _deferredNewlines > 0)
+            {
+                _deferredNewlines--;
+                _newBottomLineBG = _lastTextAttributes.GetBackground();
+            }
         }
         else if (_delayedEolWrap)
         {
@@ -304,16 +324,15 @@ XtermEngine::XtermEngine(_In_ wil::unique_hfile hPipe,
             std::string seq = "\b";
             hr = _Write(seq);
         }
-        else if (coord.Y == _lastText.Y && coord.X > _lastText.X)
-        {
-            // Same line, forward some distance
-            short distance = coord.X - _lastText.X;
-            hr = _CursorForward(distance);
-        }
         else
         {
-            _needToDisableCursor = true;
-            hr = _CursorPosition(coord);
+            // Moving forward on the same line doesn't need the cursor hidden,
+            // but anything else is a jump across the screen.
+            if (coord.Y != _lastText.Y || coord.X < _lastText.X)
+            {
+                _needToDisableCursor = true;
+            }
+            hr = _MoveCursorShortest(coord);
         }
 
         if (SUCCEEDED(hr))
@@ -330,6 +349,148 @@ XtermEngine::XtermEngine(_In_ wil::unique_hfile hPipe,
     return hr;
 }
 
+// Routine Description:
+// - Moves the cursor from where we last left it to the given position, using
+//      whichever sequence takes the fewest bytes: either a CUP, or a vertical
+//      move (CUU, CUD, line feeds or VPA) followed by a horizontal one (CUF,
+//      CUB, backspaces, CR or CHA). Ties go to the CUP, since it doesn't
+//      depend on our idea of where the cursor is.
+//   This mustn't be used in the delayed EOL wrap state, where any relative
+//      move is ambiguous.
+// Arguments:
+// - coord: Console coordinates to move the cursor to.
+// Return Value:
+// - S_OK if we succeeded, else an appropriate HRESULT for failing to allocate or write.
+[[nodiscard]] HRESULT XtermEngine::_MoveCursorShortest(const COORD coord) noexcept
+try
+{
+    // We can only move relative to a position we're sure about.
+    if (_lastText.X < 0 || _lastText.X >= _lastViewport.Width() ||
+        _lastText.Y < 0 || _lastText.Y >= _lastViewport.Height())
+    {
+        return _CursorPosition(coord);
+    }
+
+    enum class Vertical
+    {
+        None,
+        Up,
+        Down,
+        LineFeeds,
+        Absolute
+    };
+    enum class Horizontal
+    {
+        None,
+        Forward,
+        Backward,
+        Backspaces,
+        CarriageReturn,
+        Absolute
+    };
+
+    // The length of ESC [ n <final>
+    const auto csiLength = [](const int n) noexcept -> int {
+        return 3 + (n >= 10000 ? 5 : n >= 1000 ? 4 : n >= 100 ? 3 : n >= 10 ? 2 : 1);
+    };
+
+    // CHA and VPA aren't VT100 sequences, so don't use them with the inbox
+    // telnet client.
+    const bool allowAbsolute = !_fUseAsciiOnly;
+    const int dx = coord.X - _lastText.X;
+    const int dy = coord.Y - _lastText.Y;
+
+    auto vertical = Vertical::None;
+    int verticalLength = 0;
+    if (dy > 0)
+    {
+        vertical = dy < csiLength(dy) ? Vertical::LineFeeds : Vertical::Down;
+        verticalLength = std::min(dy, csiLength(dy));
+    }
+    else if (dy < 0)
+    {
+        vertical = Vertical::Up;
+        verticalLength = csiLength(-dy);
+    }
+    if (dy != 0 && allowAbsolute && csiLength(coord.Y + 1) < verticalLength)
+    {
+        vertical = Vertical::Absolute;
+        verticalLength = csiLength(coord.Y + 1);
+    }
+
+    auto horizontal = Horizontal::None;
+    int horizontalLength = 0;
+    if (dx != 0 && coord.X == 0)
+    {
+        horizontal = Horizontal::CarriageReturn;
+        horizontalLength = 1;
+    }
+    else if (dx > 0)
+    {
+        horizontal = Horizontal::Forward;
+        horizontalLength = csiLength(dx);
+    }
+    else if (dx < 0)
+    {
+        horizontal = -dx < csiLength(-dx) ? Horizontal::Backspaces : Horizontal::Backward;
+        horizontalLength = std::min(-dx, csiLength(-dx));
+    }
+    if (dx != 0 && allowAbsolute && csiLength(coord.X + 1) < horizontalLength)
+    {
+        horizontal = Horizontal::Absolute;
+        horizontalLength = csiLength(coord.X + 1);
+    }
+
+    // ESC [ y ; x H
+    const auto cupLength = csiLength(coord.Y + 1) + csiLength(coord.X + 1) - 2;
+    if (cupLength <= verticalLength + horizontalLength)
+    {
+        return _CursorPosition(coord);
+    }
+
+    switch (vertical)
+    {
+    case Vertical::Up:
+        RETURN_IF_FAILED(_CursorUp(gsl::narrow_cast<short>(-dy)));
+        break;
+    case Vertical::Down:
+        RETURN_IF_FAILED(_CursorDown(gsl::narrow_cast<short>(dy)));
+        break;
+    case Vertical::LineFeeds:
+        RETURN_IF_FAILED(_Write(std::string(dy, '\n')));
+        break;
+    case Vertical::Absolute:
+        RETURN_IF_FAILED(_VerticalPositionAbsolute(coord.Y));
+        break;
+    default:
+        break;
+    }
+
+    switch (horizontal)
+    {
+    case Horizontal::Forward:
+        RETURN_IF_FAILED(_CursorForward(gsl::narrow_cast<short>(dx)));
+        break;
+    case Horizontal::Backward:
+        RETURN_IF_FAILED(_CursorBackward(gsl::narrow_cast<short>(-dx)));
+        break;
+    case Horizontal::Backspaces:
+        RETURN_IF_FAILED(_Write(std::string(-dx, '\b')));
+        break;
+    case Horizontal::CarriageReturn:
+        RETURN_IF_FAILED(_Write("\r"));
+        break;
+    case Horizontal::Absolute:
+        RETURN_IF_FAILED(_CursorHorizontalAbsolute(coord.X));
+        break;
+    default:
+        break;
+    }
+
+    return S_OK;
+}
+CATCH_RETURN();
+
 // Routine Description:
 // - Scrolls the existing data on the in-memory frame by the scroll region
 //      deltas we have collectively received through the Invalidate methods
@@ -359,6 +520,7 @@ try
 
     const short dy = _scrollDelta.y<short>();
     const short absDy = static_cast<short>(abs(dy));
+    const bool deferScroll = dy < 0 && _CanDeferScroll(absDy);
 
     // Save the old wrap state here. We're going to clear it so that
     // _MoveCursor will definitely move us to the right position. We'll
@@ -368,17 +530,20 @@ try
     _delayedEolWrap = false;
     _wrappedRow = std::nullopt;
 
-    if (dy < 0)
+    if (deferScroll)
+    {
+        // GH#5228 - Only the rows that scrolled in at the bottom are invalid,
+        // and the cursor is already on the bottom row. The next thing the
+        // Renderer is going to tell us to do is print those rows from top to
+        // bottom, and _MoveCursor will start each of them with the newline
+        // that scrolls it in. Until then, the rest of the frame moved up
+        // under the cursor.
+        _lastText.Y += dy;
+        _deferredNewlines = absDy;
+        _newRowsTop = gsl::narrow_cast<short>(_lastViewport.BottomInclusive() - absDy + 1);
+    }
+    else if (dy < 0)
     {
-        // TODO GH#5228 - We could optimize this by only doing this newline work
-        // when there's more invalid than just the bottom line. If only the
-        // bottom line is invalid, then the next thing the Renderer is going to
-        // tell us to do is print the new line at the bottom of the viewport,
-        // and _MoveCursor will automatically give us the newline we want.
-        // When that's implemented, we'll probably want to make sure to add a
-        //   _lastText.Y += dy;
-        // statement here.
-
         // Move the cursor to the bottom of the current viewport
         const short bottom = _lastViewport.BottomInclusive();
         RETURN_IF_FAILED(_MoveCursor({ 0, bottom }));
@@ -392,6 +557,7 @@ try
         RETURN_IF_FAILED(_MoveCursor({ 0, 0 }));
         RETURN_IF_FAILED(_InsertLine(absDy));
     }
+    _ScrollShadow(dy);
 
     // Restore our wrap state.
     _wrappedRow = oldWrappedRow;
@@ -456,6 +622,42 @@ try
 }
 CATCH_RETURN();
 
+// Routine Description:
+// - Checks if we can scroll up by leaving it to the rows that scroll in: that's
+//      the case if they're the only part of the frame that needs painting,
+//      and the terminal's cursor is on the bottom row, where a newline
+//      scrolls. Lines that wrapped need the cursor right where it is, so we
+//      don't try while the cursor is waiting to wrap.
+// Arguments:
+// - lines: the number of rows that scrolled in at the bottom.
+// Return Value:
+// - true if ScrollFrame can leave the scrolling to _MoveCursor.
+bool XtermEngine::_CanDeferScroll(const short lines) const noexcept
+{
+    const short bottom = _lastViewport.BottomInclusive();
+    const auto newRowsTop = gsl::narrow_cast<short>(bottom - lines + 1);
+    if (newRowsTop <= 0 ||
+        newRowsTop < _virtualTop ||
+        (_resized && _resizeQuirk) ||
+        _lastText.Y != bottom ||
+        _lastText.X < 0 ||
+        _lastText.X >= _lastViewport.Width() ||
+        _delayedEolWrap ||
+        _wrappedRow.has_value())
+    {
+        return false;
+    }
+
+    for (const auto& rect : _invalidMap.runs())
+    {
+        if (rect.top() < newRowsTop)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
 // Routine Description:
 // - Notifies us that the console is attempting to scroll the existing screen
 //      area. Add the top or bottom rows to the invalid region, and update the
@@ -474,6 +676,15 @@ try
     {
         _trace.TraceInvalidateScroll(delta);
 
+        if (_passthrough)
+        {
+            // The terminal already scrolled. Changes that were pending from
+            // before move along with the text, but there's nothing to paint
+            // for the revealed area.
+            _invalidMap.translate(delta, false);
+            return S_OK;
+        }
+
         // Scroll the current offset and invalidate the revealed area
         _invalidMap.translate(delta, true);
 
@@ -518,9 +729,19 @@ CATCH_RETURN();
 // - S_OK or suitable HRESULT error from either conversion or writing pipe.
 [[nodiscard]] HRESULT XtermEngine::WriteTerminalW(const std::wstring_view wstr) noexcept
 {
+    // During a passthrough the terminal already got the whole string that
+    // this sequence was part of.
+    if (_passthrough)
+    {
+        return S_OK;
+    }
+
     RETURN_IF_FAILED(_fUseAsciiOnly ?
                          VtEngine::_WriteTerminalAscii(wstr) :
                          VtEngine::_WriteTerminalUtf8(wstr));
+    // We don't know what that string did to the screen.
+    _ResetShadow();
+
     // GH#4106, GH#2011 - WriteTerminalW is only ever called by the
     // StateMachine, when we've encountered a string we don't understand. When
     // this happens, we usually don't actually trigger another frame, but we
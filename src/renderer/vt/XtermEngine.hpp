@@ -58,6 +58,8 @@ namespace Microsoft::Console::Render
         bool _nextCursorIsVisible;
 
         [[nodiscard]] HRESULT _MoveCursor(const COORD coord) noexcept override;
+        [[nodiscard]] HRESULT _MoveCursorShortest(const COORD coord) noexcept;
+        bool _CanDeferScroll(const short lines) const noexcept;
 
         [[nodiscard]] HRESULT _DoUpdateTitle(const std::wstring_view newTitle) noexcept override;
 
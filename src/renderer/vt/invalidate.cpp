@@ -49,6 +49,12 @@ using namespace Microsoft::Console::Render;
 [[nodiscard]] HRESULT VtEngine::Invalidate(const SMALL_RECT* const psrRegion) noexcept
 try
 {
+    // During a passthrough the terminal already got this change.
+    if (_passthrough)
+    {
+        return S_OK;
+    }
+
     const til::rectangle rect{ Viewport::FromExclusive(*psrRegion).ToInclusive() };
     _trace.TraceInvalidate(rect);
     _invalidMap.set(rect);
@@ -91,6 +97,11 @@ CATCH_RETURN();
 [[nodiscard]] HRESULT VtEngine::InvalidateAll() noexcept
 try
 {
+    if (_passthrough)
+    {
+        return S_OK;
+    }
+
     _trace.TraceInvalidateAll(_lastViewport.ToOrigin().ToInclusive());
     _invalidMap.set_all();
     return S_OK;
@@ -112,6 +123,16 @@ CATCH_RETURN();
     {
         *pForcePaint = false;
     }
+    else if (_passthrough)
+    {
+        // The terminal scrolled on its own when it got the output that
+        // circled the buffer, there's nothing to paint for it.
+        *pForcePaint = false;
+        if (_virtualTop > 0)
+        {
+            _virtualTop--;
+        }
+    }
     else
     {
         *pForcePaint = true;
@@ -137,5 +158,14 @@ CATCH_RETURN();
 [[nodiscard]] HRESULT VtEngine::PrepareForTeardown(_Out_ bool* const pForcePaint) noexcept
 {
     *pForcePaint = true;
+
+    // Everything we already painted has to reach the terminal before we exit,
+    // and so does the last frame. Stop writing in the background.
+    _tearingDown = true;
+    if (_writer && !_pipeBroken)
+    {
+        LOG_IF_FAILED(_writer->Drain());
+    }
+
     return S_OK;
 }
@@ -75,6 +75,9 @@ using namespace Microsoft::Console::Types;
     }
     _circled = false;
 
+    // The terminal must have scrolled all the way by the end of the frame.
+    RETURN_IF_FAILED(_FinishDeferredScroll());
+
     // If we deferred a cursor movement during the frame, make sure we put the
     //      cursor in the right place before we end the frame.
     if (_deferredCursorPos != INVALID_COORDS)
@@ -87,17 +90,54 @@ using namespace Microsoft::Console::Types;
     return S_OK;
 }
 
+// Routine Description:
+// - Scrolls in the rest of the rows that ScrollFrame left to _MoveCursor. This
+//      is needed when the cursor has to go anywhere else before we got to all
+//      of them, and at the end of the frame.
+// Arguments:
+// - <none>
+// Return Value:
+// - S_OK, else an appropriate HRESULT for failing to allocate or write.
+[[nodiscard]] HRESULT VtEngine::_FinishDeferredScroll() noexcept
+try
+{
+    if (_deferredNewlines > 0)
+    {
+        RETURN_IF_FAILED(_Write(std::string(_deferredNewlines, '\n')));
+        _lastText.Y += _deferredNewlines;
+        _deferredNewlines = 0;
+    }
+    return S_OK;
+}
+CATCH_RETURN();
+
 // Routine Description:
 // - Used to perform longer running presentation steps outside the lock so the
 //      other threads can continue.
-// - Not currently used by VtEngine.
+// - For the VtEngine, this waits until the writer thread has picked up the
+//      frame we just painted, so that we never paint more than one frame ahead
+//      of the pipe. While a slow terminal holds us here, the client can go on
+//      writing to the buffer, and the next frame paints all of those changes
+//      at once, instead of queueing every intermediate state.
 // Arguments:
 // - <none>
 // Return Value:
-// - S_FALSE since we do nothing.
+// - S_OK, S_FALSE if there's no pipe to wait for, or a suitable HRESULT error
+//      from writing the pipe.
 [[nodiscard]] HRESULT VtEngine::Present() noexcept
 {
-    return S_FALSE;
+    if (!_writer || _pipeBroken)
+    {
+        return S_FALSE;
+    }
+
+    const auto hr = _writer->WaitForPending(0);
+    if (FAILED(hr))
+    {
+        return _OnPipeFailed(hr);
+    }
+
+    return S_OK;
 }
 
 // Routine Description:
@@ -381,6 +421,33 @@ using namespace Microsoft::Console::Types;
         return S_OK;
     }
 
+    const bool printingBottomLine = coord.Y == _lastViewport.BottomInclusive();
+
+    // The rows that a deferred scroll brings in are empty once they're in,
+    // just like a new bottom line. If this run starts one of them, the
+    // newline that scrolls it in is yet to come, and will fill it with the
+    // background we're painting with.
+    const bool printingNewLine = (_newBottomLine && printingBottomLine) ||
+                                 (_deferredNewlines > 0 && coord.Y >= _newRowsTop);
+    const bool scrollingIn = _deferredNewlines > 0 && coord.X == 0 && coord.Y == _lastText.Y + 1;
+
+    // If the terminal should already be showing most of this run, only paint
+    // the parts of it that changed. Wrapped rows, the rows after them and new
+    // bottom lines depend on exactly what we write, so they're left to the
+    // logic below.
+    if (!lineWrapped &&
+        !_wrappedRow.has_value() &&
+        !_clearedAllThisFrame &&
+        !printingNewLine)
+    {
+        bool painted = false;
+        RETURN_IF_FAILED(_PaintChangedSpans(clusters, coord, painted));
+        if (painted)
+        {
+            return S_OK;
+        }
+    }
+
     _bufferLine.clear();
     _bufferLine.reserve(clusters.size());
     short totalWidth = 0;
@@ -436,13 +503,13 @@ using namespace Microsoft::Console::Types;
     const bool useEraseChar = (optimalToUseECH) &&
                               (!_newBottomLine) &&
                               (!_clearedAllThisFrame);
-    const bool printingBottomLine = coord.Y == _lastViewport.BottomInclusive();
 
     // GH#5502 - If the background color of the "new bottom line" is different
     // than when we emitted the line, we can't optimize out the spaces from it.
     // We'll still need to emit those spaces, so that the connected terminal
     // will have the same background color on those blank cells.
-    const bool bgMatched = _newBottomLineBG.has_value() ? (_newBottomLineBG.value() == _lastTextAttributes.GetBackground()) : true;
+    const bool bgMatched = scrollingIn ||
+                           (_newBottomLineBG.has_value() ? (_newBottomLineBG.value() == _lastTextAttributes.GetBackground()) : true);
 
     // If we're not using erase char, but we did erase all at the start of the
     // frame, don't add spaces at the end.
@@ -458,7 +525,7 @@ using namespace Microsoft::Console::Types;
     // on the same line.
     const bool removeSpaces = !lineWrapped && (useEraseChar ||
                                                _clearedAllThisFrame ||
-                                               (_newBottomLine && printingBottomLine && bgMatched));
+                                               (printingNewLine && bgMatched));
     const size_t cchActual = removeSpaces ?
                                  (cchLine - numSpaces) :
                                  cchLine;
@@ -489,7 +556,18 @@ using namespace Microsoft::Console::Types;
     RETURN_IF_FAILED(_MoveCursor(coord));
 
     // Write the actual text string
-    RETURN_IF_FAILED(VtEngine::_WriteTerminalUtf8({ _bufferLine.data(), cchActual }));
+    RETURN_IF_FAILED(VtEngine::_WriteTerminalUtf8Runs({ _bufferLine.data(), cchActual }));
+
+    // Remember what the terminal shows now. The spaces we trimmed off the end
+    // get erased or skipped over below, so we can't vouch for those cells.
+    const auto trimmedClusters = removeSpaces ? std::min(numSpaces, clusters.size()) : 0;
+    _RecordShadow(clusters.first(clusters.size() - trimmedClusters), coord);
+    if (removeSpaces)
+    {
+        _ForgetShadow(coord.Y,
+                      gsl::narrow_cast<short>(coord.X + columnsActual),
+                      gsl::narrow_cast<short>(coord.X + totalWidth));
+    }
 
     // GH#4415, GH#5181
     // If the renderer told us that this was a wrapped line, then mark
@@ -558,9 +636,10 @@ using namespace Microsoft::Console::Types;
         else
         {
             RETURN_IF_FAILED(_EraseLine());
+            _ForgetShadow(coord.Y, _lastText.X, _lastViewport.Width());
         }
     }
-    else if (_newBottomLine && printingBottomLine)
+    else if (printingNewLine)
     {
         // If we're on a new line, then we don't need to erase the line. The
         //      line is already empty.
@@ -589,6 +668,316 @@ using namespace Microsoft::Console::Types;
     return S_OK;
 }
 
+// Routine Description:
+// - Paints only the parts of a run that differ from what the terminal is
+//      already showing, according to our shadow copy of the last frame.
+//   Unchanged cells between two changed ones are written again if that's
+//      shorter than the sequence we'd need to move the cursor over them.
+// Arguments:
+// - clusters - text and column widths to be written
+// - coord - character coordinate target to render within viewport
+// - painted - receives true if the run was handled here. False if we don't
+//      know what's in some of these cells, and the run has to be painted in
+//      full.
+// Return Value:
+// - S_OK or suitable HRESULT error from writing pipe.
+[[nodiscard]] HRESULT VtEngine::_PaintChangedSpans(gsl::span<const Cluster> const clusters,
+                                                   const COORD coord,
+                                                   bool& painted) noexcept
+try
+{
+    painted = false;
+
+    const size_t width = _lastViewport.Width();
+    const size_t height = _lastViewport.Height();
+    if (_shadow.size() != width * height || coord.X < 0 || coord.Y < 0 || gsl::narrow_cast<size_t>(coord.Y) >= height)
+    {
+        return S_OK;
+    }
+
+    // Long runs of trailing spaces are cheaper to erase with ECH, which the
+    // full paint already does.
+    size_t trailingSpaces = 0;
+    for (auto it = clusters.rbegin(); it != clusters.rend() && it->GetText() == L" "; ++it)
+    {
+        trailingSpaces++;
+    }
+    if (trailingSpaces > ERASE_CHARACTER_STRING_LENGTH)
+    {
+        return S_OK;
+    }
+
+    const auto row = gsl::span<const ShadowCell>{ _shadow }.subspan(coord.Y * width, width);
+
+    // Bail if any of the cells is unknown to us.
+    size_t x = coord.X;
+    for (const auto& cluster : clusters)
+    {
+        const auto columns = cluster.GetColumns();
+        if (x + columns > width)
+        {
+            return S_OK;
+        }
+        for (size_t i = 0; i < columns; ++i)
+        {
+            if (!til::at(row, x + i).known)
+            {
+                return S_OK;
+            }
+        }
+        x += columns;
+    }
+
+    const auto unchanged = [&](const Cluster& cluster, const size_t column) noexcept {
+        const auto text = cluster.GetText();
+        const auto& cell = til::at(row, column);
+        if (text.size() != 1 || cell.ch != til::at(text, 0) || cell.attributes != _lastTextAttributes)
+        {
+            return false;
+        }
+        // The remaining columns of a wide glyph must still be its trailing half.
+        for (size_t i = 1; i < cluster.GetColumns(); ++i)
+        {
+            if (til::at(row, column + i).ch != L'\0')
+            {
+                return false;
+            }
+        }
+        return true;
+    };
+
+    const auto paintSpan = [&](const size_t begin, const size_t end, const size_t column) -> HRESULT {
+        const auto span = clusters.subspan(begin, end - begin);
+        const COORD target{ gsl::narrow_cast<short>(column), coord.Y };
+
+        _bufferLine.clear();
+        short columns = 0;
+        for (const auto& cluster : span)
+        {
+            _bufferLine.append(cluster.GetText());
+            columns += gsl::narrow_cast<short>(cluster.GetColumns());
+        }
+
+        RETURN_IF_FAILED(_MoveCursor(target));
+        RETURN_IF_FAILED(VtEngine::_WriteTerminalUtf8Runs(_bufferLine));
+        _RecordShadow(span, target);
+
+        // Track the cursor the same way _PaintUtf8BufferLine does.
+        if (_lastText.X < _lastViewport.RightExclusive())
+        {
+            _lastText.X += columns;
+        }
+        if (_lastText.X >= _lastViewport.RightInclusive())
+        {
+            _delayedEolWrap = true;
+        }
+        return S_OK;
+    };
+
+    // Moving the cursor over n unchanged cells takes a CUF: ESC [ n C
+    const auto skipCost = [](const size_t columns) noexcept -> size_t {
+        return 3 + (columns >= 100 ? 3 : columns >= 10 ? 2 : 1);
+    };
+    const auto utf8Length = [](const std::wstring_view text) noexcept {
+        size_t length = 0;
+        for (const auto ch : text)
+        {
+            length += ch < 0x80 ? 1 : ch < 0x800 || (ch >= 0xD800 && ch <= 0xDFFF) ? 2 : 3;
+        }
+        return length;
+    };
+
+    std::optional<size_t> spanBegin;
+    size_t spanEnd = 0;
+    size_t spanColumn = 0;
+    size_t gapColumns = 0;
+    size_t gapBytes = 0;
+
+    x = coord.X;
+    for (size_t i = 0; i < clusters.size(); ++i)
+    {
+        const auto& cluster = til::at(clusters, i);
+        if (!unchanged(cluster, x))
+        {
+            // If it's cheaper to jump over the unchanged cells since the last
+            // changed one than to write them again, finish the current span.
+            if (spanBegin.has_value() && gapBytes > skipCost(gapColumns))
+            {
+                RETURN_IF_FAILED(paintSpan(*spanBegin, spanEnd, spanColumn));
+                spanBegin = std::nullopt;
+            }
+            if (!spanBegin.has_value())
+            {
+                spanBegin = i;
+                spanColumn = x;
+            }
+            spanEnd = i + 1;
+            gapColumns = 0;
+            gapBytes = 0;
+        }
+        else if (spanBegin.has_value())
+        {
+            gapColumns += cluster.GetColumns();
+            gapBytes += utf8Length(cluster.GetText());
+        }
+        x += cluster.GetColumns();
+    }
+
+    if (spanBegin.has_value())
+    {
+        RETURN_IF_FAILED(paintSpan(*spanBegin, spanEnd, spanColumn));
+    }
+
+    painted = true;
+    return S_OK;
+}
+CATCH_RETURN();
+
+// Method Description:
+// - Forgets everything we know about the terminal's contents, and sizes our
+//      shadow copy of the frame to the viewport. Called whenever we emit
+//      something whose effect on the screen we don't track, like a clear.
+// Arguments:
+// - <none>
+// Return Value:
+// - <none>
+void VtEngine::_ResetShadow() noexcept
+{
+    try
+    {
+        const size_t cells = gsl::narrow_cast<size_t>(_lastViewport.Width()) * _lastViewport.Height();
+        _shadow.assign(cells, ShadowCell{});
+    }
+    catch (...)
+    {
+        // Without a shadow every cell is unknown, so we'll just paint them all.
+        LOG_CAUGHT_EXCEPTION();
+        _shadow.clear();
+    }
+}
+
+// Method Description:
+// - Moves our shadow copy of the frame along with the terminal's contents,
+//      after we've scrolled the terminal by the given number of rows. The rows
+//      that scrolled in are blank, but we don't know their colors.
+// Arguments:
+// - dy - the number of rows we scrolled. Negative when the contents moved up.
+// Return Value:
+// - <none>
+void VtEngine::_ScrollShadow(const short dy) noexcept
+{
+    const size_t width = _lastViewport.Width();
+    const size_t height = _lastViewport.Height();
+    const size_t rows = std::abs(dy);
+    if (_shadow.size() != width * height || rows == 0)
+    {
+        return;
+    }
+
+    if (rows >= height)
+    {
+        std::fill(_shadow.begin(), _shadow.end(), ShadowCell{});
+        return;
+    }
+
+    const auto shift = gsl::narrow_cast<ptrdiff_t>(rows * width);
+    if (dy < 0)
+    {
+        std::move(_shadow.begin() + shift, _shadow.end(), _shadow.begin());
+        std::fill(_shadow.end() - shift, _shadow.end(), ShadowCell{});
+    }
+    else
+    {
+        std::move_backward(_shadow.begin(), _shadow.end() - shift, _shadow.end());
+        std::fill(_shadow.begin(), _shadow.begin() + shift, ShadowCell{});
+    }
+}
+
+// Method Description:
+// - Marks some cells of a row as unknown, because we erased them or otherwise
+//      can't be sure about what the terminal shows there.
+// Arguments:
+// - row - the row, relative to the viewport
+// - left - the first column to forget
+// - right - the column after the last one to forget
+// Return Value:
+// - <none>
+void VtEngine::_ForgetShadow(const short row, const short left, const short right) noexcept
+{
+    const auto width = _lastViewport.Width();
+    const auto height = _lastViewport.Height();
+    if (_shadow.size() != gsl::narrow_cast<size_t>(width) * height || row < 0 || row >= height)
+    {
+        return;
+    }
+
+    const auto rowStart = gsl::narrow_cast<size_t>(row) * width;
+    for (auto x = std::max<short>(left, 0); x < std::min(right, width); ++x)
+    {
+        til::at(_shadow, rowStart + x).known = false;
+    }
+}
+
+// Method Description:
+// - Records that we've written the given clusters to the terminal, with the
+//      current attributes, so that we can skip them if they get painted again.
+// Arguments:
+// - clusters - the text and column widths we've written
+// - coord - where we've written them, relative to the viewport
+// Return Value:
+// - <none>
+void VtEngine::_RecordShadow(gsl::span<const Cluster> const clusters, const COORD coord) noexcept
+{
+    const auto width = _lastViewport.Width();
+    const auto height = _lastViewport.Height();
+    if (coord.X < 0 || coord.Y < 0 || coord.Y >= height)
+    {
+        return;
+    }
+    if (_shadow.size() != gsl::narrow_cast<size_t>(width) * height)
+    {
+        _ResetShadow();
+        if (_shadow.empty())
+        {
+            return;
+        }
+    }
+
+    const auto rowStart = gsl::narrow_cast<size_t>(coord.Y) * width;
+    const auto cell = [&](const short x) noexcept -> ShadowCell& {
+        return til::at(_shadow, rowStart + x);
+    };
+
+    // Overwriting either half of a wide glyph erases all of it. A known cell
+    // holding a null is the trailing half of one.
+    auto x = coord.X;
+    if (x > 0 && x < width && cell(x).known && cell(x).ch == L'\0')
+    {
+        cell(x - 1).known = false;
+    }
+
+    for (const auto& cluster : clusters)
+    {
+        // We only keep track of glyphs made of a single code unit. Surrogate
+        // pairs and combining characters are left unknown.
+        const auto text = cluster.GetText();
+        const bool single = text.size() == 1;
+        const auto columns = gsl::narrow_cast<short>(cluster.GetColumns());
+        for (short i = 0; i < columns && x < width; ++i, ++x)
+        {
+            auto& shadowCell = cell(x);
+            shadowCell.ch = (single && i == 0) ? til::at(text, 0) : L'\0';
+            shadowCell.known = single;
+            shadowCell.attributes = _lastTextAttributes;
+        }
+    }
+
+    if (x < width && cell(x).known && cell(x).ch == L'\0')
+    {
+        cell(x).known = false;
+    }
+}
+
 // Method Description:
 // - Updates the window's title string. Emits the VT sequence to SetWindowTitle.
 //      Because wintelnet does not understand these sequences by default, we
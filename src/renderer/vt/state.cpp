@@ -63,6 +63,12 @@ VtEngine::VtEngine(_In_ wil::unique_hfile pipe,
     // member is only defined when UNIT_TESTING is.
     _usingTestCallback = false;
 #endif
+
+    // When unit testing, there might not be a pipe to write to.
+    if (_hFile.get() != INVALID_HANDLE_VALUE)
+    {
+        _writer = std::make_unique<PipeWriter>(_hFile.get());
+    }
 }
 
 // Method Description:
@@ -103,6 +109,15 @@ VtEngine::VtEngine(_In_ wil::unique_hfile pipe,
     CATCH_RETURN();
 }
 
+// Method Description:
+// - Hands everything written so far to the writer thread, which sends it to
+//      the pipe while we go on painting. This only waits for the pipe if so
+//      much output piled up that the terminal clearly isn't keeping up, or if
+//      we're about to exit and all of it has to get out first.
+// Arguments:
+// - <none>
+// Return Value:
+// - S_OK or suitable HRESULT error from writing pipe.
 [[nodiscard]] HRESULT VtEngine::_Flush() noexcept
 {
 #ifdef UNIT_TESTING
@@ -115,23 +130,41 @@ VtEngine::VtEngine(_In_ wil::unique_hfile pipe,
 
     if (!_pipeBroken)
     {
-        bool fSuccess = !!WriteFile(_hFile.get(), _buffer.data(), gsl::narrow_cast<DWORD>(_buffer.size()), nullptr, nullptr);
-        _buffer.clear();
-        if (!fSuccess)
+        auto hr = _writer->Write(_buffer);
+        if (SUCCEEDED(hr))
         {
-            _exitResult = HRESULT_FROM_WIN32(GetLastError());
-            _pipeBroken = true;
-            if (_terminalOwner)
-            {
-                _terminalOwner->CloseOutput();
-            }
-            return _exitResult;
+            hr = _tearingDown ? _writer->Drain() : _writer->WaitForPending(MAX_PENDING_OUTPUT_BYTES);
+        }
+        if (FAILED(hr))
+        {
+            return _OnPipeFailed(hr);
         }
     }
 
     return S_OK;
 }
 
+// Method Description:
+// - Stops writing to the pipe after a write failed, and lets the owner know
+//      that the terminal is gone. Only the first failure gets reported, since
+//      both the painting and the out-of-lock presentation can notice it.
+// Arguments:
+// - hr: the error the write failed with.
+// Return Value:
+// - The error we're exiting with.
+[[nodiscard]] HRESULT VtEngine::_OnPipeFailed(const HRESULT hr) noexcept
+{
+    if (!_pipeBroken.exchange(true))
+    {
+        _exitResult = hr;
+        if (_terminalOwner)
+        {
+            _terminalOwner->CloseOutput();
+        }
+    }
+    return _exitResult;
+}
+
 // Method Description:
 // - Wrapper for ITerminalOutputConnection. See _Write.
 [[nodiscard]] HRESULT VtEngine::WriteTerminalUtf8(const std::string_view str) noexcept
@@ -152,6 +185,80 @@ VtEngine::VtEngine(_In_ wil::unique_hfile pipe,
     return _Write(_conversionBuffer);
 }
 
+// Method Description:
+// - Writes the text of a run to the tty, encoded as utf-8, replacing each run
+//      of a repeated character with whichever is shortest: the characters
+//      themselves, the first one followed by a REP, or for spaces, an ECH and
+//      a CUF over them.
+//   ECH isn't used for spaces at the very end of the text, since only
+//      printing them puts the cursor into the delayed EOL wrap state, and
+//      callers already erase trailing spaces themselves where that's fine.
+// Arguments:
+// - wstr - wstring of text to be written
+// Return Value:
+// - S_OK or suitable HRESULT error from writing pipe.
+[[nodiscard]] HRESULT VtEngine::_WriteTerminalUtf8Runs(const std::wstring_view wstr) noexcept
+try
+{
+    // The length of ESC [ n <final>
+    const auto csiLength = [](const size_t n) noexcept -> size_t {
+        return 3 + (n >= 10000 ? 5 : n >= 1000 ? 4 : n >= 100 ? 3 : n >= 10 ? 2 : 1);
+    };
+
+    // Erased cells only have the background color, which looks the same as a
+    // space if nothing else about the attributes would show on a blank cell.
+    const auto& attributes = _lastTextAttributes;
+    const bool canErase = !attributes.IsAnyGridLineEnabled() &&
+                          !attributes.IsUnderlined() &&
+                          !attributes.IsDoublyUnderlined() &&
+                          !attributes.IsCrossedOut() &&
+                          !attributes.IsReverseVideo() &&
+                          !attributes.IsHyperlink();
+
+    _runBuffer.clear();
+    for (size_t i = 0; i < wstr.size();)
+    {
+        const auto wch = til::at(wstr, i);
+        size_t count = 1;
+        while (i + count < wstr.size() && til::at(wstr, i + count) == wch)
+        {
+            count++;
+        }
+
+        // REP repeats the last printed character. We only use it for ASCII,
+        // where every character is a cluster of its own.
+        const bool canRepeat = _repeatCharacters && wch >= L'\x20' && wch < L'\x7f';
+        const auto repeatLength = canRepeat ? 1 + csiLength(count - 1) : SIZE_MAX;
+        const auto eraseLength = (canErase && wch == L' ' && i + count < wstr.size()) ? 2 * csiLength(count) : SIZE_MAX;
+
+        if (repeatLength < count && repeatLength <= eraseLength)
+        {
+            _runBuffer.push_back(wch);
+            _runBuffer.append(L"\x1b[");
+            _runBuffer.append(std::to_wstring(count - 1));
+            _runBuffer.push_back(L'b');
+        }
+        else if (eraseLength < count)
+        {
+            const auto param = std::to_wstring(count);
+            _runBuffer.append(L"\x1b[");
+            _runBuffer.append(param);
+            _runBuffer.append(L"X\x1b[");
+            _runBuffer.append(param);
+            _runBuffer.push_back(L'C');
+        }
+        else
+        {
+            _runBuffer.append(count, wch);
+        }
+
+        i += count;
+    }
+
+    return _WriteTerminalUtf8(_runBuffer);
+}
+CATCH_RETURN();
+
 // Method Description:
 // - Writes a wstring to the tty, encoded as "utf-8" where characters that are
 //      outside the ASCII range are encoded as '?'
@@ -227,6 +334,10 @@ VtEngine::VtEngine(_In_ wil::unique_hfile pipe,
             hr = _ResizeWindow(newView.Width(), newView.Height());
         }
         _resized = true;
+
+        // The terminal may reflow its contents, so we can't rely on any of
+        // the cells we've painted so far.
+        _ResetShadow();
     }
 
     // See MSFT:19408543
@@ -455,3 +566,56 @@ HRESULT VtEngine::RequestWin32Input() noexcept
     RETURN_IF_FAILED(_Flush());
     return S_OK;
 }
+
+// Method Description:
+// - Writes a client's output to the terminal as is, and starts ignoring
+//   everything the console does to its buffer while it processes that same
+//   output. The terminal already got those changes, so they mustn't be painted
+//   again.
+// - Changes that were still pending stay invalidated and get painted by the
+//   next frame, from what the buffer holds by then. A pending scroll can't be
+//   replayed after the client's output though, so it becomes a full repaint.
+// - Call EndPassthrough once the console is done with the output.
+// Arguments:
+// - str - the client's output
+// Return Value:
+// - S_OK if we succeeded, else an appropriate HRESULT for failing to allocate or write.
+[[nodiscard]] HRESULT VtEngine::BeginPassthrough(const std::wstring_view str) noexcept
+{
+    RETURN_IF_FAILED(WriteTerminalW(str));
+
+    if (_scrollDelta != til::point{ 0, 0 })
+    {
+        _scrollDelta = { 0, 0 };
+        _invalidMap.set_all();
+    }
+
+    _passthrough = true;
+    return S_OK;
+}
+
+// Method Description:
+// - Ends a passthrough started by BeginPassthrough, and takes the cursor and
+//   attributes the console ended up with as the terminal's, since both parsed
+//   the same output.
+// Arguments:
+// - cursorPosition - the cursor position, relative to the viewport
+// - delayedEolWrap - true if the cursor is waiting to wrap at the end of the line
+// - attributes - the attributes that the client's output left active
+// Return Value:
+// - <none>
+void VtEngine::EndPassthrough(const COORD cursorPosition,
+                              const bool delayedEolWrap,
+                              const TextAttribute& attributes) noexcept
+{
+    _passthrough = false;
+
+    _deferredCursorPos = INVALID_COORDS;
+
+    _lastText = cursorPosition;
+    _lastTextAttributes = attributes;
+    // The terminal's cursor may be pending a wrap, which makes every relative
+    // cursor movement ambiguous. _MoveCursor will use an absolute one instead.
+    _delayedEolWrap = delayedEolWrap;
+    _wrappedRow = std::nullopt;
+}
@@ -20,6 +20,7 @@ Author(s):
 #include "../../inc/ITerminalOwner.hpp"
 #include "../../types/inc/Viewport.hpp"
 #include "tracing.hpp"
+#include "PipeWriter.hpp"
 #include <string>
 #include <functional>
 
@@ -38,6 +39,8 @@ namespace Microsoft::Console::Render
     public:
         // See _PaintUtf8BufferLine for explanation of this value.
         static const size_t ERASE_CHARACTER_STRING_LENGTH = 8;
+        // How much output may wait for the pipe before a flush blocks.
+        static const size_t MAX_PENDING_OUTPUT_BYTES = 1024 * 1024;
         static const COORD INVALID_COORDS;
 
         VtEngine(_In_ wil::unique_hfile hPipe,
@@ -108,9 +111,18 @@ namespace Microsoft::Console::Render
 
         [[nodiscard]] HRESULT RequestWin32Input() noexcept;
 
+        [[nodiscard]] HRESULT BeginPassthrough(const std::wstring_view str) noexcept;
+        void EndPassthrough(const COORD cursorPosition,
+                            const bool delayedEolWrap,
+                            const TextAttribute& attributes) noexcept;
+
     protected:
         wil::unique_hfile _hFile;
         std::string _buffer;
+        // Declared after _hFile, so that its thread is gone before the pipe
+        // is closed.
+        std::unique_ptr<PipeWriter> _writer;
+        std::atomic<bool> _tearingDown{ false };
 
         std::string _formatBuffer;
         std::string _conversionBuffer;
@@ -139,7 +151,16 @@ namespace Microsoft::Console::Render
         bool _newBottomLine;
         COORD _deferredCursorPos;
 
-        bool _pipeBroken;
+        // When a scroll only brought in new rows at the bottom, ScrollFrame
+        // leaves it to _MoveCursor to scroll each of them in with a newline as
+        // it gets to them. Until it's done, the terminal's cursor is on its
+        // bottom row, _deferredNewlines rows below _lastText. Those rows start
+        // out as empty as a new bottom line.
+        short _deferredNewlines{ 0 };
+        short _newRowsTop{ 0 };
+
+        // The writer thread's failures are noticed outside of the console lock.
+        std::atomic<bool> _pipeBroken;
         HRESULT _exitResult;
         Microsoft::Console::ITerminalOwner* _terminalOwner;
 
@@ -153,8 +174,26 @@ namespace Microsoft::Console::Render
         bool _resizeQuirk{ false };
         std::optional<TextColor> _newBottomLineBG{ std::nullopt };
 
+        bool _passthrough{ false };
+
+        // Whether the terminal understands REP, to print runs of a character.
+        bool _repeatCharacters{ false };
+
+        // What we believe the terminal is showing in the viewport, one entry
+        // per cell. Lets _PaintUtf8BufferLine skip the parts of a run that the
+        // terminal already has. Cells we can't be sure about are unknown, and
+        // always get painted.
+        struct ShadowCell
+        {
+            wchar_t ch{ L'\0' };
+            bool known{ false };
+            TextAttribute attributes;
+        };
+        std::vector<ShadowCell> _shadow;
+
         [[nodiscard]] HRESULT _Write(std::string_view const str) noexcept;
         [[nodiscard]] HRESULT _Flush() noexcept;
+        [[nodiscard]] HRESULT _OnPipeFailed(const HRESULT hr) noexcept;
 
         template<typename S, typename... Args>
         [[nodiscard]] HRESULT _WriteFormatted(S&& format, Args&&... args)
@@ -178,6 +217,11 @@ namespace Microsoft::Console::Render
         [[nodiscard]] HRESULT _DeleteLine(const short sLines) noexcept;
         [[nodiscard]] HRESULT _InsertLine(const short sLines) noexcept;
         [[nodiscard]] HRESULT _CursorForward(const short chars) noexcept;
+        [[nodiscard]] HRESULT _CursorBackward(const short chars) noexcept;
+        [[nodiscard]] HRESULT _CursorUp(const short lines) noexcept;
+        [[nodiscard]] HRESULT _CursorDown(const short lines) noexcept;
+        [[nodiscard]] HRESULT _CursorHorizontalAbsolute(const short column) noexcept;
+        [[nodiscard]] HRESULT _VerticalPositionAbsolute(const short line) noexcept;
         [[nodiscard]] HRESULT _EraseCharacter(const short chars) noexcept;
         [[nodiscard]] HRESULT _CursorPosition(const COORD coord) noexcept;
         [[nodiscard]] HRESULT _CursorHome() noexcept;
@@ -215,6 +259,7 @@ namespace Microsoft::Console::Render
         [[nodiscard]] HRESULT _RequestWin32Input() noexcept;
 
         [[nodiscard]] virtual HRESULT _MoveCursor(const COORD coord) noexcept = 0;
+        [[nodiscard]] HRESULT _FinishDeferredScroll() noexcept;
         [[nodiscard]] HRESULT _RgbUpdateDrawingBrushes(const TextAttribute& textAttributes) noexcept;
         [[nodiscard]] HRESULT _16ColorUpdateDrawingBrushes(const TextAttribute& textAttributes) noexcept;
 
@@ -223,6 +268,7 @@ namespace Microsoft::Console::Render
         // buffer space for these two functions to build their lines
         // so they don't have to alloc/free in a tight loop
         std::wstring _bufferLine;
+        std::wstring _runBuffer;
         [[nodiscard]] HRESULT _PaintUtf8BufferLine(gsl::span<const Cluster> const clusters,
                                                    const COORD coord,
                                                    const bool lineWrapped) noexcept;
@@ -230,7 +276,16 @@ namespace Microsoft::Console::Render
         [[nodiscard]] HRESULT _PaintAsciiBufferLine(gsl::span<const Cluster> const clusters,
                                                     const COORD coord) noexcept;
 
+        void _ResetShadow() noexcept;
+        void _ScrollShadow(const short dy) noexcept;
+        void _ForgetShadow(const short row, const short left, const short right) noexcept;
+        void _RecordShadow(gsl::span<const Cluster> const clusters, const COORD coord) noexcept;
+        [[nodiscard]] HRESULT _PaintChangedSpans(gsl::span<const Cluster> const clusters,
+                                                 const COORD coord,
+                                                 bool& painted) noexcept;
+
         [[nodiscard]] HRESULT _WriteTerminalUtf8(const std::wstring_view str) noexcept;
+        [[nodiscard]] HRESULT _WriteTerminalUtf8Runs(const std::wstring_view str) noexcept;
         [[nodiscard]] HRESULT _WriteTerminalAscii(const std::wstring_view str) noexcept;
 
         [[nodiscard]] virtual HRESULT _DoUpdateTitle(const std::wstring_view newTitle) noexcept override;
@@ -152,7 +152,7 @@
 
     std::unique_ptr<IWaitRoutine> waiter;
     HRESULT hr;
-    std::deque<std::unique_ptr<IInputEvent>> outEvents;
+    std::vector<INPUT_RECORD> outEvents;
     size_t const eventsToRead = cRecords;
     if (a->Unicode)
     {
@@ -228,19 +228,7 @@
     }
     else
     {
-        try
-        {
-            for (size_t i = 0; i < cRecords; ++i)
-            {
-                if (outEvents.empty())
-                {
-                    break;
-                }
-                rgRecords[i] = outEvents.front()->ToInputRecord();
-                outEvents.pop_front();
-            }
-        }
-        CATCH_RETURN();
+        std::copy_n(outEvents.begin(), std::min(cRecords, outEvents.size()), rgRecords);
     }
 
     if (SUCCEEDED(hr))
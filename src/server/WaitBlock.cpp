@@ -135,7 +135,7 @@ bool ConsoleWaitBlock::Notify(const WaitTerminationReason TerminationReason)
     DWORD dwControlKeyState;
     bool fIsUnicode = true;
 
-    std::deque<std::unique_ptr<IInputEvent>> outEvents;
+    std::vector<INPUT_RECORD> outEvents;
     // TODO: MSFT 14104228 - get rid of this void* and get the data
     // out of the read wait object properly.
     void* pOutputData = nullptr;
@@ -193,15 +193,7 @@ bool ConsoleWaitBlock::Notify(const WaitTerminationReason TerminationReason)
 
             INPUT_RECORD* const pRecordBuffer = static_cast<INPUT_RECORD* const>(buffer);
             a->NumRecords = static_cast<ULONG>(outEvents.size());
-            for (size_t i = 0; i < a->NumRecords; ++i)
-            {
-                if (outEvents.empty())
-                {
-                    break;
-                }
-                pRecordBuffer[i] = outEvents.front()->ToInputRecord();
-                outEvents.pop_front();
-            }
+            std::copy(outEvents.begin(), outEvents.end(), pRecordBuffer);
         }
         else if (API_NUMBER_READCONSOLE == _WaitReplyMessage.msgHeader.ApiNumber)
         {
@@ -0,0 +1,151 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+/*
+Module Name:
+- CommonGraphicsRendition.hpp
+
+Abstract:
+- The fast path for the SGR sequences that syntax highlighters and pagers
+    emit between almost every token. It's shared by the AdaptDispatch and the
+    TerminalDispatch, which differ in how they number the 16 colors and how
+    they apply 38/48 colors.
+*/
+
+#pragma once
+
+#include "DispatchTypes.hpp"
+#include "../../buffer/out/TextAttribute.hpp"
+
+namespace Microsoft::Console::VirtualTerminal
+{
+    class CommonGraphicsRendition final
+    {
+    public:
+        // How a single SGR option changes the colors of an attribute, for the
+        // options that select one of the 16 colors or a default color.
+        // Everything else has no transition here.
+        struct ColorTransition
+        {
+            enum class Kind : BYTE
+            {
+                None,
+                Foreground,
+                Background,
+                DefaultForeground,
+                DefaultBackground
+            };
+
+            Kind kind;
+            BYTE index;
+        };
+
+        using ColorTransitions = std::array<ColorTransition, DispatchTypes::BrightBackgroundWhite + 1>;
+
+        // Routine Description:
+        // - Builds the table of color transitions, indexed by the SGR option.
+        // Arguments:
+        // - ansiColors - The indices of the 8 dark colors. The 16-color options
+        //   list their colors in ANSI order, so these have to be in that order
+        //   too. The bright colors are the same indices with BRIGHT_ATTR set.
+        // Return Value:
+        // - the transition table.
+        static constexpr ColorTransitions s_BuildColorTransitions(const std::array<BYTE, 8>& ansiColors) noexcept
+        {
+            using namespace DispatchTypes;
+
+            ColorTransitions transitions{};
+            for (size_t i = 0; i < ansiColors.size(); i++)
+            {
+                const auto dark = ansiColors.at(i);
+                const auto bright = gsl::narrow_cast<BYTE>(dark | BRIGHT_ATTR);
+                transitions.at(ForegroundBlack + i) = { ColorTransition::Kind::Foreground, dark };
+                transitions.at(BackgroundBlack + i) = { ColorTransition::Kind::Background, dark };
+                transitions.at(BrightForegroundBlack + i) = { ColorTransition::Kind::Foreground, bright };
+                transitions.at(BrightBackgroundBlack + i) = { ColorTransition::Kind::Background, bright };
+            }
+            transitions.at(ForegroundDefault) = { ColorTransition::Kind::DefaultForeground, 0 };
+            transitions.at(BackgroundDefault) = { ColorTransition::Kind::DefaultBackground, 0 };
+            return transitions;
+        }
+
+        // Routine Description:
+        // - Applies the SGR sequences that consist of an optional reset,
+        //   followed by at most one color. The color can be one of the 16
+        //   colors, a default color, or a 38/48 sequence with a 256-color index
+        //   or an RGB value. Sequences of any other shape are left untouched,
+        //   to be handled by the general loop in SetGraphicsRendition.
+        // Arguments:
+        // - options - The options of the SGR sequence.
+        // - attr - The attribute that will be updated.
+        // - colorTransitions - The table built by s_BuildColorTransitions.
+        // - setExtendedColor - Called with the options following the 38/48 and
+        //   whether they're for the foreground, to apply them to attr.
+        // Return Value:
+        // - True if the sequence had one of these shapes and was applied to attr.
+        template<typename T>
+        static bool s_TryApply(const VTParameters options,
+                               TextAttribute& attr,
+                               const ColorTransitions& colorTransitions,
+                               T&& setExtendedColor) noexcept
+        {
+            using namespace DispatchTypes;
+
+            // An empty sequence counts as a reset, since its only option defaults to 0.
+            const GraphicsOptions first = options.at(0);
+            const size_t start = first == Off ? 1 : 0;
+            const auto count = options.size() - start;
+
+            const GraphicsOptions opt = options.at(start);
+            const auto transition = opt < colorTransitions.size() ? colorTransitions.at(opt) : ColorTransition{};
+            const auto extended = opt == ForegroundExtended || opt == BackgroundExtended;
+            const GraphicsOptions colorType = options.at(start + 1);
+
+            // Check the shape before changing anything, so that attr is left as
+            // it was for the sequences that the general loop has to deal with.
+            const auto common = count == 0 ||
+                                (count == 1 && transition.kind != ColorTransition::Kind::None) ||
+                                (extended && count == 3 && colorType == BlinkOrXterm256Index) ||
+                                (extended && count == 5 && colorType == RGBColorOrFaint);
+            if (!common)
+            {
+                return false;
+            }
+
+            if (start != 0)
+            {
+                attr.SetDefaultForeground();
+                attr.SetDefaultBackground();
+                attr.SetDefaultMetaAttrs();
+            }
+
+            if (extended)
+            {
+                setExtendedColor(options.subspan(start + 1), opt == ForegroundExtended);
+                return true;
+            }
+
+            switch (transition.kind)
+            {
+            case ColorTransition::Kind::Foreground:
+                attr.SetIndexedForeground(transition.index);
+                break;
+            case ColorTransition::Kind::Background:
+                attr.SetIndexedBackground(transition.index);
+                break;
+            case ColorTransition::Kind::DefaultForeground:
+                attr.SetDefaultForeground();
+                break;
+            case ColorTransition::Kind::DefaultBackground:
+                attr.SetDefaultBackground();
+                break;
+            default:
+                break;
+            }
+            return true;
+        }
+
+    private:
+        static constexpr BYTE BRIGHT_ATTR = 0x08;
+    };
+}
@@ -4,6 +4,7 @@
 #include <precomp.h>
 
 #include "adaptDispatch.hpp"
+#include "CommonGraphicsRendition.hpp"
 #include "conGetSet.hpp"
 #include "../../types/inc/utils.hpp"
 
@@ -36,6 +37,8 @@ constexpr BYTE BRIGHT_CYAN    = BRIGHT_ATTR | GREEN_ATTR | BLUE_ATTR;
 constexpr BYTE BRIGHT_WHITE   = BRIGHT_ATTR | RED_ATTR | GREEN_ATTR | BLUE_ATTR;
 // clang-format on
 
+static constexpr auto colorTransitions = CommonGraphicsRendition::s_BuildColorTransitions({ DARK_BLACK, DARK_RED, DARK_GREEN, DARK_YELLOW, DARK_BLUE, DARK_MAGENTA, DARK_CYAN, DARK_WHITE });
+
 // Routine Description:
 // - Helper to parse extended graphics options, which start with 38 (FG) or 48 (BG)
 //     These options are followed by either a 2 (RGB) or 5 (xterm index)
@@ -101,6 +104,15 @@ bool AdaptDispatch::SetGraphicsRendition(const VTParameters options)
     TextAttribute attr;
     bool success = _pConApi->PrivateGetTextAttributes(attr);
 
+    // Most sequences only reset and/or change one color. Those don't need to
+    // go through the loop below.
+    if (success && CommonGraphicsRendition::s_TryApply(options, attr, colorTransitions, [&](const VTParameters subOptions, const bool isForeground) noexcept {
+            _SetRgbColorsHelper(subOptions, attr, isForeground);
+        }))
+    {
+        return _pConApi->PrivateSetTextAttributes(attr);
+    }
+
     if (success)
     {
         // Run through the graphics options and apply them
@@ -28,8 +28,20 @@ namespace Microsoft::Console::VirtualTerminal
     class ConGetSet
     {
     public:
+        // The part of CONSOLE_SCREEN_BUFFER_INFOEX that most sequences need.
+        // Unlike the full structure, it can be filled in without copying the
+        // color table or measuring the window. Like srWindow, the viewport is
+        // exclusive.
+        struct BufferState
+        {
+            COORD size;
+            COORD cursorPosition;
+            SMALL_RECT viewport;
+        };
+
         virtual ~ConGetSet() = default;
         virtual bool GetConsoleScreenBufferInfoEx(CONSOLE_SCREEN_BUFFER_INFOEX& screenBufferInfo) const = 0;
+        virtual bool PrivateGetBufferState(BufferState& state) const = 0;
         virtual bool SetConsoleScreenBufferInfoEx(const CONSOLE_SCREEN_BUFFER_INFOEX& screenBufferInfo) = 0;
         virtual bool SetConsoleCursorPosition(const COORD position) = 0;
 
@@ -44,6 +56,8 @@ namespace Microsoft::Console::VirtualTerminal
 
         virtual bool PrivateWriteConsoleInputW(std::deque<std::unique_ptr<IInputEvent>>& events,
                                                size_t& eventsWritten) = 0;
+        virtual bool PrivateWriteConsoleInputString(const std::wstring_view text,
+                                                    size_t& eventsWritten) = 0;
         virtual bool SetConsoleWindowInfo(const bool absolute,
                                           const SMALL_RECT& window) = 0;
         virtual bool PrivateSetCursorKeysMode(const bool applicationMode) = 0;
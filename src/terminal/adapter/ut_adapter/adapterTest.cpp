@@ -72,6 +72,21 @@ public:
 
         return _getConsoleScreenBufferInfoExResult;
     }
+    bool PrivateGetBufferState(BufferState& state) const override
+    {
+        Log::Comment(L"PrivateGetBufferState MOCK returning data...");
+
+        // This is a subset of GetConsoleScreenBufferInfoEx, so the tests
+        // make it fail the same way.
+        if (_getConsoleScreenBufferInfoExResult)
+        {
+            state.size = _bufferSize;
+            state.viewport = _viewport;
+            state.cursorPosition = _cursorPos;
+        }
+
+        return _getConsoleScreenBufferInfoExResult;
+    }
     bool SetConsoleScreenBufferInfoEx(const CONSOLE_SCREEN_BUFFER_INFOEX& sbiex) override
     {
         Log::Comment(L"SetConsoleScreenBufferInfoEx MOCK returning data...");
@@ -269,6 +284,16 @@ public:
         return _privateWriteConsoleInputWResult;
     }
 
+    bool PrivateWriteConsoleInputString(const std::wstring_view text,
+                                        size_t& eventsWritten) override
+    {
+        Log::Comment(L"PrivateWriteConsoleInputString MOCK called...");
+
+        eventsWritten = _privateWriteConsoleInputWResult ? text.size() : 0;
+
+        return _privateWriteConsoleInputWResult;
+    }
+
     bool PrivateWriteConsoleControlInput(_In_ KeyEvent key) override
     {
         Log::Comment(L"PrivateWriteConsoleControlInput MOCK called...");
@@ -2332,6 +2357,88 @@ public:
         VERIFY_IS_TRUE(_pDispatch.get()->SetGraphicsRendition({ rgOptions, 5 }));
     }
 
+    TEST_METHOD(GraphicsResetAndColorTests)
+    {
+        Log::Comment(L"Starting test...");
+
+        _testGetSet->PrepData();
+
+        VTParameter rgOptions[16];
+
+        // Every test starts from a colored, bold, underlined attribute, so that
+        // a reset is visible in the result.
+        auto startingAttribute = TextAttribute{ FOREGROUND_GREEN | BACKGROUND_BLUE };
+        startingAttribute.SetBold(true);
+        startingAttribute.SetUnderlined(true);
+
+        Log::Comment(L"Test 1: Reset, then a 16-color foreground");
+        _testGetSet->_attribute = startingAttribute;
+        rgOptions[0] = DispatchTypes::GraphicsOptions::Off;
+        rgOptions[1] = DispatchTypes::GraphicsOptions::BrightForegroundRed;
+        _testGetSet->_expectedAttribute = {};
+        _testGetSet->_expectedAttribute.SetIndexedForeground(FOREGROUND_RED | FOREGROUND_INTENSITY);
+        VERIFY_IS_TRUE(_pDispatch.get()->SetGraphicsRendition({ rgOptions, 2 }));
+
+        Log::Comment(L"Test 2: Reset, then a default background");
+        _testGetSet->_attribute = startingAttribute;
+        rgOptions[0] = DispatchTypes::GraphicsOptions::Off;
+        rgOptions[1] = DispatchTypes::GraphicsOptions::BackgroundDefault;
+        _testGetSet->_expectedAttribute = {};
+        VERIFY_IS_TRUE(_pDispatch.get()->SetGraphicsRendition({ rgOptions, 2 }));
+
+        Log::Comment(L"Test 3: Defaulted reset, then a 256-color foreground");
+        _testGetSet->_attribute = startingAttribute;
+        rgOptions[0] = {};
+        rgOptions[1] = DispatchTypes::GraphicsOptions::ForegroundExtended;
+        rgOptions[2] = DispatchTypes::GraphicsOptions::BlinkOrXterm256Index;
+        rgOptions[3] = 208;
+        _testGetSet->_expectedAttribute = {};
+        _testGetSet->_expectedAttribute.SetIndexedForeground256(208);
+        VERIFY_IS_TRUE(_pDispatch.get()->SetGraphicsRendition({ rgOptions, 4 }));
+
+        Log::Comment(L"Test 4: Reset, then an RGB background");
+        _testGetSet->_attribute = startingAttribute;
+        rgOptions[0] = DispatchTypes::GraphicsOptions::Off;
+        rgOptions[1] = DispatchTypes::GraphicsOptions::BackgroundExtended;
+        rgOptions[2] = DispatchTypes::GraphicsOptions::RGBColorOrFaint;
+        rgOptions[3] = 40;
+        rgOptions[4] = 20;
+        rgOptions[5] = 10;
+        _testGetSet->_expectedAttribute = {};
+        _testGetSet->_expectedAttribute.SetBackground(RGB(40, 20, 10));
+        VERIFY_IS_TRUE(_pDispatch.get()->SetGraphicsRendition({ rgOptions, 6 }));
+
+        Log::Comment(L"Test 5: A single background color keeps everything else");
+        _testGetSet->_attribute = startingAttribute;
+        rgOptions[0] = DispatchTypes::GraphicsOptions::BackgroundYellow;
+        _testGetSet->_expectedAttribute = startingAttribute;
+        _testGetSet->_expectedAttribute.SetIndexedBackground(FOREGROUND_RED | FOREGROUND_GREEN);
+        VERIFY_IS_TRUE(_pDispatch.get()->SetGraphicsRendition({ rgOptions, 1 }));
+
+        Log::Comment(L"Test 6: Reset followed by more than one option");
+        _testGetSet->_attribute = startingAttribute;
+        rgOptions[0] = DispatchTypes::GraphicsOptions::Off;
+        rgOptions[1] = DispatchTypes::GraphicsOptions::BoldBright;
+        rgOptions[2] = DispatchTypes::GraphicsOptions::ForegroundCyan;
+        _testGetSet->_expectedAttribute = {};
+        _testGetSet->_expectedAttribute.SetBold(true);
+        _testGetSet->_expectedAttribute.SetIndexedForeground(FOREGROUND_GREEN | FOREGROUND_BLUE);
+        VERIFY_IS_TRUE(_pDispatch.get()->SetGraphicsRendition({ rgOptions, 3 }));
+
+        Log::Comment(L"Test 7: An RGB foreground followed by another option");
+        _testGetSet->_attribute = startingAttribute;
+        rgOptions[0] = DispatchTypes::GraphicsOptions::ForegroundExtended;
+        rgOptions[1] = DispatchTypes::GraphicsOptions::RGBColorOrFaint;
+        rgOptions[2] = 1;
+        rgOptions[3] = 2;
+        rgOptions[4] = 3;
+        rgOptions[5] = DispatchTypes::GraphicsOptions::Italics;
+        _testGetSet->_expectedAttribute = startingAttribute;
+        _testGetSet->_expectedAttribute.SetForeground(RGB(1, 2, 3));
+        _testGetSet->_expectedAttribute.SetItalic(true);
+        VERIFY_IS_TRUE(_pDispatch.get()->SetGraphicsRendition({ rgOptions, 6 }));
+    }
+
     TEST_METHOD(SetColorTableValue)
     {
         _testGetSet->PrepData();
@@ -20,7 +20,10 @@ namespace Microsoft::Console::VirtualTerminal
     class IStateMachineEngine
     {
     public:
-        using StringHandler = std::function<bool(const wchar_t)>;
+        // Receives the data string of a DCS sequence in contiguous chunks. A
+        // chunk holding a single ESC signals the end of the string. Returning
+        // false causes the remainder of the string to be ignored.
+        using StringHandler = std::function<bool(const std::wstring_view)>;
 
         virtual ~IStateMachineEngine() = 0;
         IStateMachineEngine(const IStateMachineEngine&) = default;
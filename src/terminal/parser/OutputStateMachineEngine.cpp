@@ -9,6 +9,7 @@
 
 #include "ascii.hpp"
 #include "../../types/inc/utils.hpp"
+#include "til/counters.h"
 
 using namespace Microsoft::Console;
 using namespace Microsoft::Console::VirtualTerminal;
@@ -45,6 +46,8 @@ ITermDispatch& OutputStateMachineEngine::Dispatch() noexcept
 // - true iff we successfully dispatched the sequence.
 bool OutputStateMachineEngine::ActionExecute(const wchar_t wch)
 {
+    TIL_COUNTER_INCREMENT(sequences_execute);
+
     switch (wch)
     {
     case AsciiChars::NUL:
@@ -189,6 +192,8 @@ bool OutputStateMachineEngine::ActionPassThroughString(const std::wstring_view s
 // - true iff we successfully dispatched the sequence.
 bool OutputStateMachineEngine::ActionEscDispatch(const VTID id)
 {
+    TIL_COUNTER_INCREMENT(sequences_esc);
+
     bool success = false;
 
     switch (id)
@@ -352,6 +357,8 @@ bool OutputStateMachineEngine::ActionEscDispatch(const VTID id)
 // - true iff we successfully dispatched the sequence.
 bool OutputStateMachineEngine::ActionVt52EscDispatch(const VTID id, const VTParameters parameters)
 {
+    TIL_COUNTER_INCREMENT(sequences_vt52);
+
     bool success = false;
 
     switch (id)
@@ -425,6 +432,8 @@ bool OutputStateMachineEngine::ActionVt52EscDispatch(const VTID id, const VTPara
 // - true iff we successfully dispatched the sequence.
 bool OutputStateMachineEngine::ActionCsiDispatch(const VTID id, const VTParameters parameters)
 {
+    TIL_COUNTER_INCREMENT(sequences_csi);
+
     bool success = false;
 
     switch (id)
@@ -647,6 +656,8 @@ bool OutputStateMachineEngine::ActionCsiDispatch(const VTID id, const VTParamete
 // - the data string handler function or nullptr if the sequence is not supported
 IStateMachineEngine::StringHandler OutputStateMachineEngine::ActionDcsDispatch(const VTID /*id*/, const VTParameters /*parameters*/) noexcept
 {
+    TIL_COUNTER_INCREMENT(sequences_dcs);
+
     StringHandler handler = nullptr;
 
     _ClearLastChar();
@@ -693,6 +704,8 @@ bool OutputStateMachineEngine::ActionOscDispatch(const wchar_t /*wch*/,
                                                  const size_t parameter,
                                                  const std::wstring_view string)
 {
+    TIL_COUNTER_INCREMENT(sequences_osc);
+
     bool success = false;
 
     switch (parameter)
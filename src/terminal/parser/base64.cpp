@@ -4,66 +4,96 @@
 #include "precomp.h"
 #include "base64.hpp"
 
+#if defined(_M_AMD64) || defined(_M_IX86)
+#include <emmintrin.h>
+#endif
+
 using namespace Microsoft::Console::VirtualTerminal;
 
-static const char base64Chars[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
-static const char padChar = '=';
+static constexpr char base64Chars[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+static constexpr wchar_t padChar = L'=';
+static constexpr uint8_t invalidValue = 0xff;
 
-#pragma warning(disable : 26446 26447 26482 26485 26493 26494)
+#pragma warning(disable : 26446 26447 26481 26482 26485 26493 26494)
+
+// Routine Description:
+// - Builds the table mapping each ASCII character to its 6-bit base64 value,
+//      or invalidValue for characters outside of the base64 alphabet.
+// Arguments:
+// - <none>
+// Return Value:
+// - the lookup table.
+static constexpr std::array<uint8_t, 128> s_BuildDecodeTable() noexcept
+{
+    std::array<uint8_t, 128> table{};
+    for (auto& value : table)
+    {
+        value = invalidValue;
+    }
+    for (uint8_t i = 0; i < 64; ++i)
+    {
+        table[base64Chars[i]] = i;
+    }
+    return table;
+}
+
+static constexpr auto decodeTable = s_BuildDecodeTable();
 
 // Routine Description:
 // - Encode a string using base64. When there are not enough characters
-//      for one quantum, paddings are added.
+//      for one quantum, paddings are added. The string is encoded as UTF-8,
+//      which is what s_Decode expects to get back.
 // Arguments:
 // - src - String to base64 encode.
 // Return Value:
 // - the encoded string.
 std::wstring Base64::s_Encode(const std::wstring_view src) noexcept
+try
 {
     std::wstring dst;
-    wchar_t input[3];
 
-    const auto len = (src.size() + 2) / 3 * 4;
+    std::string mbStr;
+    THROW_IF_FAILED(til::u16u8(src, mbStr));
+
+    const auto len = (mbStr.size() + 2) / 3 * 4;
     if (len == 0)
     {
         return dst;
     }
-    dst.reserve(len);
+    dst.resize(len);
+
+    const auto in = reinterpret_cast<const uint8_t*>(mbStr.data());
+    const auto size = mbStr.size();
+    auto out = dst.data();
+    size_t i = 0;
 
-    auto iter = src.cbegin();
-    // Encode each three chars into one quantum (four chars).
-    while (iter < src.cend() - 2)
+    // Encode each three bytes into one quantum (four chars).
+    for (; i + 3 <= size; i += 3)
     {
-        input[0] = *iter++;
-        input[1] = *iter++;
-        input[2] = *iter++;
-        dst.push_back(base64Chars[input[0] >> 2]);
-        dst.push_back(base64Chars[(input[0] & 0x03) << 4 | input[1] >> 4]);
-        dst.push_back(base64Chars[(input[1] & 0x0f) << 2 | input[2] >> 6]);
-        dst.push_back(base64Chars[(input[2] & 0x3f)]);
+        const uint32_t quantum = in[i] << 16 | in[i + 1] << 8 | in[i + 2];
+        *out++ = base64Chars[quantum >> 18];
+        *out++ = base64Chars[quantum >> 12 & 0x3f];
+        *out++ = base64Chars[quantum >> 6 & 0x3f];
+        *out++ = base64Chars[quantum & 0x3f];
     }
 
-    // Here only zero, or one, or two chars are left. We may need to add paddings.
-    if (iter < src.cend())
+    // Here only zero, or one, or two bytes are left. We may need to add paddings.
+    if (i < size)
     {
-        input[0] = *iter++;
-        dst.push_back(base64Chars[input[0] >> 2]);
-        if (iter < src.cend()) // Two chars left.
-        {
-            input[1] = *iter++;
-            dst.push_back(base64Chars[(input[0] & 0x03) << 4 | input[1] >> 4]);
-            dst.push_back(base64Chars[(input[1] & 0x0f) << 2]);
-        }
-        else // Only one char left.
-        {
-            dst.push_back(base64Chars[(input[0] & 0x03) << 4]);
-            dst.push_back(padChar);
-        }
-        dst.push_back(padChar);
+        const uint32_t quantum = in[i] << 16 | (i + 1 < size ? in[i + 1] << 8 : 0);
+        *out++ = base64Chars[quantum >> 18];
+        *out++ = base64Chars[quantum >> 12 & 0x3f];
+        *out++ = i + 1 < size ? base64Chars[quantum >> 6 & 0x3f] : padChar;
+        *out++ = padChar;
     }
 
     return dst;
 }
+catch (...)
+{
+    LOG_CAUGHT_EXCEPTION();
+    return {};
+}
 
 // Routine Description:
 // - Decode a base64 string. This requires the base64 string is properly padded.
@@ -74,110 +104,233 @@ std::wstring Base64::s_Encode(const std::wstring_view src) noexcept
 // Return Value:
 // - true if decoding successfully, otherwise false.
 bool Base64::s_Decode(const std::wstring_view src, std::wstring& dst) noexcept
+try
 {
-    std::string mbStr;
-    int state = 0;
-    char tmp;
-
     const auto len = src.size() / 4 * 3;
     if (len == 0)
     {
         return false;
     }
+
+    std::string mbStr;
     mbStr.reserve(len);
 
-    auto iter = src.cbegin();
-    while (iter < src.cend())
+    Decoder decoder;
+    return decoder.Decode(src, mbStr) && decoder.Finish() && SUCCEEDED(til::u8u16(mbStr, dst));
+}
+catch (...)
+{
+    LOG_CAUGHT_EXCEPTION();
+    return false;
+}
+
+// Routine Description:
+// - Decodes the next chunk of a base64 string and appends the decoded bytes.
+//      Whitespace may appear anywhere, and a quantum may be split across
+//      chunks. Once this fails, the decoder stays failed until it's Reset.
+// Arguments:
+// - src - The next chunk of the string to decode.
+// - dst - Destination to append the decoded bytes to.
+// Return Value:
+// - true if the chunk is valid so far, otherwise false.
+bool Base64::Decoder::Decode(const std::wstring_view src, std::string& dst)
+{
+    if (_failed)
     {
-        if (s_IsSpace(*iter)) // Skip whitespace anywhere.
+        return false;
+    }
+
+    auto it = src.data();
+    const auto end = it + src.size();
+
+    while (it < end)
+    {
+        // Whole quanta without any whitespace can be decoded in bulk.
+        if (_count == 0 && !_ended)
+        {
+            it = _DecodeBlocks(it, end, dst);
+            if (it == end)
+            {
+                break;
+            }
+        }
+
+        const auto ch = *it++;
+        if (s_IsSpace(ch)) // Skip whitespace anywhere.
         {
-            iter++;
             continue;
         }
 
-        if (*iter == padChar)
+        if (_ended || ch == padChar)
         {
-            break;
+            if (!_DecodePadding(ch, dst))
+            {
+                _failed = true;
+                return false;
+            }
+            continue;
         }
 
-        auto pos = strchr(base64Chars, *iter);
-        if (!pos) // A non-base64 character found.
+        const auto value = ch < decodeTable.size() ? decodeTable[ch] : invalidValue;
+        if (value == invalidValue) // A non-base64 character found.
         {
+            _failed = true;
             return false;
         }
 
-        switch (state)
+        _quantum = _quantum << 6 | value;
+        if (++_count == 4)
         {
-        case 0:
-            tmp = (char)(pos - base64Chars) << 2;
-            state = 1;
-            break;
-        case 1:
-            tmp |= (char)(pos - base64Chars) >> 4;
-            mbStr += tmp;
-            tmp = (char)((pos - base64Chars) & 0x0f) << 4;
-            state = 2;
-            break;
-        case 2:
-            tmp |= (char)(pos - base64Chars) >> 2;
-            mbStr += tmp;
-            tmp = (char)((pos - base64Chars) & 0x03) << 6;
-            state = 3;
-            break;
-        case 3:
-            tmp |= pos - base64Chars;
-            mbStr += tmp;
-            state = 0;
-            break;
-        default:
-            break;
+            dst.push_back(gsl::narrow_cast<char>(_quantum >> 16));
+            dst.push_back(gsl::narrow_cast<char>(_quantum >> 8));
+            dst.push_back(gsl::narrow_cast<char>(_quantum));
+            _quantum = 0;
+            _count = 0;
         }
+    }
 
-        iter++;
+    return true;
+}
+
+// Routine Description:
+// - Checks that the string that was decoded ended properly: either with a
+//      complete quantum, or with the right amount of padding.
+// Arguments:
+// - <none>
+// Return Value:
+// - true if the decoded string was valid, otherwise false.
+bool Base64::Decoder::Finish() const noexcept
+{
+    if (_failed)
+    {
+        return false;
     }
+    return _ended ? _paddingNeeded == 0 : _count == 0;
+}
 
-    if (iter < src.cend()) // Padding char is met.
+// Routine Description:
+// - Resets the decoder, so that it can be used for another string.
+// Arguments:
+// - <none>
+// Return Value:
+// - <none>
+void Base64::Decoder::Reset() noexcept
+{
+    *this = {};
+}
+
+// Routine Description:
+// - Decodes as many blocks of 8 base64 characters as possible. Decoding stops
+//      at the first block that contains anything but base64 characters, like
+//      whitespace or padding, which is then left to the regular path.
+// Arguments:
+// - it - The first character to decode. Must be at the start of a quantum.
+// - end - The end of the characters to decode.
+// - dst - Destination to append the decoded bytes to.
+// Return Value:
+// - the first character that wasn't decoded.
+const wchar_t* Base64::Decoder::_DecodeBlocks(const wchar_t* it, const wchar_t* const end, std::string& dst)
+{
+#if defined(_M_AMD64) || defined(_M_IX86)
+    const auto inRange = [](const __m128i block, const wchar_t first, const wchar_t last) noexcept {
+        return _mm_and_si128(_mm_cmpgt_epi16(block, _mm_set1_epi16(gsl::narrow_cast<short>(first - 1))),
+                             _mm_cmplt_epi16(block, _mm_set1_epi16(gsl::narrow_cast<short>(last + 1))));
+    };
+
+    for (; end - it >= 8; it += 8)
     {
-        iter++;
-        switch (state)
+        const auto block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(it));
+
+        // Classify each character. Code units above 0x7fff compare as negative,
+        // so they don't fall into any of these ranges.
+        const auto upper = inRange(block, L'A', L'Z');
+        const auto lower = inRange(block, L'a', L'z');
+        const auto digit = inRange(block, L'0', L'9');
+        const auto plus = _mm_cmpeq_epi16(block, _mm_set1_epi16(gsl::narrow_cast<short>(L'+')));
+        const auto slash = _mm_cmpeq_epi16(block, _mm_set1_epi16(gsl::narrow_cast<short>(L'/')));
+
+        const auto valid = _mm_or_si128(_mm_or_si128(upper, lower), _mm_or_si128(_mm_or_si128(digit, plus), slash));
+        if (_mm_movemask_epi8(valid) != 0xffff)
         {
-        // Invalid when state is 0 or 1.
-        case 0:
-        case 1:
-            return false;
-        case 2:
-            // Skip any number of spaces.
-            while (iter < src.cend() && s_IsSpace(*iter))
-            {
-                iter++;
-            }
-            // Make sure there is another trailing padding character.
-            if (iter == src.cend() || *iter != padChar)
-            {
-                return false;
-            }
-            iter++; // Skip the padding character and fallthrough to "single trailing padding character" case.
-            [[fallthrough]];
-        case 3:
-            while (iter < src.cend())
-            {
-                if (!s_IsSpace(*iter))
-                {
-                    return false;
-                }
-                iter++;
-            }
-            break;
-        default:
             break;
         }
+
+        // Turn each character into its 6-bit value by adding the offset of its range.
+        auto offset = _mm_and_si128(upper, _mm_set1_epi16(gsl::narrow_cast<short>(-L'A')));
+        offset = _mm_or_si128(offset, _mm_and_si128(lower, _mm_set1_epi16(gsl::narrow_cast<short>(26 - L'a'))));
+        offset = _mm_or_si128(offset, _mm_and_si128(digit, _mm_set1_epi16(gsl::narrow_cast<short>(52 - L'0'))));
+        offset = _mm_or_si128(offset, _mm_and_si128(plus, _mm_set1_epi16(gsl::narrow_cast<short>(62 - L'+'))));
+        offset = _mm_or_si128(offset, _mm_and_si128(slash, _mm_set1_epi16(gsl::narrow_cast<short>(63 - L'/'))));
+        const auto values = _mm_add_epi16(block, offset);
+
+        // Merge pairs of 6-bit values into 12 bits (first * 64 + second), then
+        // pairs of those into the 24 bits of a quantum, in the low 32 bits of
+        // each 64-bit lane.
+        const auto pairs = _mm_madd_epi16(values, _mm_set1_epi32(0x00010040));
+        const auto quanta = _mm_or_si128(_mm_slli_epi64(pairs, 12), _mm_srli_epi64(pairs, 32));
+
+        const auto first = gsl::narrow_cast<uint32_t>(_mm_cvtsi128_si32(quanta));
+        const auto second = gsl::narrow_cast<uint32_t>(_mm_cvtsi128_si32(_mm_srli_si128(quanta, 8)));
+        const char bytes[6]{
+            gsl::narrow_cast<char>(first >> 16),
+            gsl::narrow_cast<char>(first >> 8),
+            gsl::narrow_cast<char>(first),
+            gsl::narrow_cast<char>(second >> 16),
+            gsl::narrow_cast<char>(second >> 8),
+            gsl::narrow_cast<char>(second),
+        };
+        dst.append(&bytes[0], 6);
     }
-    else if (state != 0) // When no padding, we must be in state 0.
+#else
+    UNREFERENCED_PARAMETER(end);
+    UNREFERENCED_PARAMETER(dst);
+#endif
+
+    return it;
+}
+
+// Routine Description:
+// - Handles a character at or after the padding at the end of a base64 string.
+// Arguments:
+// - ch - The character, which is not whitespace.
+// - dst - Destination to append the last decoded bytes to.
+// Return Value:
+// - true if the character is valid at this point, otherwise false.
+bool Base64::Decoder::_DecodePadding(const wchar_t ch, std::string& dst)
+{
+    if (_ended)
+    {
+        // After the first padding character, only the rest of the padding
+        // (and whitespace) may follow.
+        if (ch == padChar && _paddingNeeded > 0)
+        {
+            --_paddingNeeded;
+            return true;
+        }
+        return false;
+    }
+
+    // The first padding character ends the data. The trailing bits of a
+    // partial quantum are always zero and get dropped.
+    switch (_count)
     {
+    case 2: // 12 bits: one byte, and there must be another padding character.
+        dst.push_back(gsl::narrow_cast<char>(_quantum >> 4));
+        _paddingNeeded = 1;
+        break;
+    case 3: // 18 bits: two bytes, and this was the only padding character.
+        dst.push_back(gsl::narrow_cast<char>(_quantum >> 10));
+        dst.push_back(gsl::narrow_cast<char>(_quantum >> 2));
+        _paddingNeeded = 0;
+        break;
+    default: // Invalid when there are no or not enough characters in this quantum.
         return false;
     }
 
-    return SUCCEEDED(til::u8u16(mbStr, dst));
+    _ended = true;
+    _quantum = 0;
+    _count = 0;
+    return true;
 }
 
 // Routine Description:
@@ -7,6 +7,8 @@ Module Name:
 
 Abstract:
 - This declares standard base64 encoding and decoding, with paddings when needed.
+- Decoding can also be done incrementally with a Base64::Decoder, for payloads
+  that arrive in several pieces.
 */
 
 #pragma once
@@ -16,6 +18,27 @@ namespace Microsoft::Console::VirtualTerminal
     class Base64
     {
     public:
+        // Decodes base64 text that may be split into any number of chunks. The
+        // decoded bytes are appended as they become available, so the encoded
+        // text never needs to be buffered as a whole.
+        class Decoder
+        {
+        public:
+            bool Decode(const std::wstring_view src, std::string& dst);
+            bool Finish() const noexcept;
+            void Reset() noexcept;
+
+        private:
+            const wchar_t* _DecodeBlocks(const wchar_t* it, const wchar_t* const end, std::string& dst);
+            bool _DecodePadding(const wchar_t ch, std::string& dst);
+
+            uint32_t _quantum{ 0 };
+            size_t _count{ 0 };
+            size_t _paddingNeeded{ 0 };
+            bool _ended{ false };
+            bool _failed{ false };
+        };
+
         static std::wstring s_Encode(const std::wstring_view src) noexcept;
         static bool s_Decode(const std::wstring_view src, std::wstring& dst) noexcept;
 
@@ -6,6 +6,7 @@
 #include "stateMachine.hpp"
 
 #include "ascii.hpp"
+#include "til/counters.h"
 
 using namespace Microsoft::Console::VirtualTerminal;
 
@@ -18,6 +19,9 @@ StateMachine::StateMachine(std::unique_ptr<IStateMachineEngine> engine) :
     _parameters{},
     _parameterLimitReached(false),
     _oscString{},
+    _maxStringLength(MAX_STRING_LENGTH),
+    _stringLength(0),
+    _stringLimitReached(false),
     _cachedSequence{ std::nullopt },
     _processingIndividually(false)
 {
@@ -29,6 +33,18 @@ void StateMachine::SetAnsiMode(bool ansiMode) noexcept
     _isInAnsiMode = ansiMode;
 }
 
+// Routine Description:
+// - Sets the maximum length of an OSC or DCS data string. Sequences with a
+//   longer data string are dropped. Defaults to MAX_STRING_LENGTH.
+// Arguments:
+// - maxStringLength - The maximum number of characters in a data string.
+// Return Value:
+// - <none>
+void StateMachine::SetMaxStringLength(const size_t maxStringLength) noexcept
+{
+    _maxStringLength = maxStringLength;
+}
+
 const IStateMachineEngine& StateMachine::Engine() const noexcept
 {
     return *_engine;
@@ -576,6 +592,9 @@ void StateMachine::_ActionClear()
     _oscString.clear();
     _oscParameter = 0;
 
+    _stringLength = 0;
+    _stringLimitReached = false;
+
     _dcsStringHandler = nullptr;
 
     _engine->ActionClear();
@@ -606,7 +625,7 @@ void StateMachine::_ActionInterrupt()
     if (_state == VTStates::DcsPassThrough)
     {
         // The ESC signals the end of the data string.
-        _dcsStringHandler(AsciiChars::ESC);
+        _dcsStringHandler(L"\x1b");
         _dcsStringHandler = nullptr;
     }
 }
@@ -634,7 +653,45 @@ void StateMachine::_ActionOscPut(const wchar_t wch)
 {
     _trace.TraceOnAction(L"OscPut");
 
-    _oscString.push_back(wch);
+    if (_ReserveStringLength(1))
+    {
+        _oscString.push_back(wch);
+    }
+}
+
+// Routine Description:
+// - Stores a run of characters as part of the OSC string
+// Arguments:
+// - string - Characters to store.
+// Return Value:
+// - <none>
+void StateMachine::_ActionOscPutString(const std::wstring_view string)
+{
+    _trace.TraceOnAction(L"OscPutString");
+
+    if (_ReserveStringLength(string.size()))
+    {
+        _oscString.append(string);
+    }
+}
+
+// Routine Description:
+// - Passes a run of characters of the DCS data string to the handler that was
+//   returned when the sequence was dispatched.
+// Arguments:
+// - string - Characters to pass through.
+// Return Value:
+// - <none>
+void StateMachine::_ActionDcsPassThrough(const std::wstring_view string)
+{
+    _trace.TraceOnAction(L"DcsPassThrough");
+
+    if (!_ReserveStringLength(string.size()) || !_dcsStringHandler(string))
+    {
+        // Release whatever the handler has gathered so far, we won't need it.
+        _dcsStringHandler = nullptr;
+        _EnterDcsIgnore();
+    }
 }
 
 // Routine Description:
@@ -648,7 +705,10 @@ void StateMachine::_ActionOscDispatch(const wchar_t wch)
 {
     _trace.TraceOnAction(L"OscDispatch");
 
-    const bool success = _engine->ActionOscDispatch(wch, _oscParameter, _oscString);
+    // A string that went over the length limit is incomplete, so the sequence
+    // is dropped rather than acting on a truncated payload.
+    const bool success = !_stringLimitReached &&
+                         _engine->ActionOscDispatch(wch, _oscParameter, _oscString);
 
     // Trace the result.
     _trace.DispatchSequenceTrace(success);
@@ -999,25 +1059,247 @@ void StateMachine::_EnterSosPmApcString() noexcept
 }
 
 // Routine Description:
-// - Processes a character event into an Action that occurs while in the Ground state.
-//   Events in this state will:
-//   1. Execute C0 control characters
-//   2. Print all other characters
-// Arguments:
+// - Determines the action and the next state for a character event in one of
+//   the states that only depend on the character itself. This is evaluated at
+//   compile time by _BuildTransitionTable, it's never called while parsing.
+//   The states and their events follow the DEC parser described at
+//   http://vt100.net/emu/dec_ansi_parser:
+//   - Ground: execute C0 controls and DEL, print everything else.
+//   - CsiEntry, CsiParam, Ss3Entry, Ss3Param: execute C0 controls, ignore DEL,
+//       store parameters, collect intermediates and private markers, ignore
+//       the rest of the sequence on an invalid character (CsiIgnore), and
+//       dispatch on everything else. SS3 sequences are structurally the same
+//       as CSI sequences, so they share CsiIgnore.
+//   - CsiIntermediate: like CsiParam, but only intermediates may follow.
+//   - CsiIgnore: wait for the final character and return to Ground.
+//   - OscParam: collect the numeric parameter up to the delimiter.
+//   - OscString: collect the string up to BEL or ESC. ESC enters OscTermination
+//       where we wait for one more character before dispatching.
+//   - DcsEntry, DcsIntermediate: like their CSI counterparts, but C0 controls
+//       are ignored and the final character prepares the data string handler.
+//   - DcsIgnore, SosPmApcString: ignore everything. The termination is handled
+//       in ProcessCharacter when an ESC is seen.
+//   All other states depend on the engine or the ANSI mode as well and call
+//   their _Event function (Action::Handler).
+// Arguments:
+// - state - The state the event occurs in
 // - wch - Character that triggered the event
 // Return Value:
-// - <none>
-void StateMachine::_EventGround(const wchar_t wch)
+// - The action to take and the state to enter afterwards.
+//   If the state is returned unchanged, no state is entered.
+constexpr StateMachine::Transition StateMachine::_GetTransition(const VTStates state, const wchar_t wch) noexcept
 {
-    _trace.TraceOnEvent(L"Ground");
-    if (_isC0Code(wch) || _isDelete(wch))
+    switch (state)
     {
-        _ActionExecute(wch);
+    case VTStates::Ground:
+        if (_isC0Code(wch) || _isDelete(wch))
+        {
+            return { Action::Execute, state };
+        }
+        return { Action::Print, state };
+    case VTStates::CsiEntry:
+        if (_isC0Code(wch))
+        {
+            return { Action::Execute, state };
+        }
+        if (_isDelete(wch))
+        {
+            return { Action::Ignore, state };
+        }
+        if (_isIntermediate(wch))
+        {
+            return { Action::Collect, VTStates::CsiIntermediate };
+        }
+        if (_isCsiInvalid(wch))
+        {
+            return { Action::None, VTStates::CsiIgnore };
+        }
+        if (_isNumericParamValue(wch) || _isParameterDelimiter(wch))
+        {
+            return { Action::Param, VTStates::CsiParam };
+        }
+        if (_isCsiPrivateMarker(wch))
+        {
+            return { Action::Collect, VTStates::CsiParam };
+        }
+        return { Action::CsiDispatch, VTStates::Ground };
+    case VTStates::CsiIntermediate:
+        if (_isC0Code(wch))
+        {
+            return { Action::Execute, state };
+        }
+        if (_isIntermediate(wch))
+        {
+            return { Action::Collect, state };
+        }
+        if (_isDelete(wch))
+        {
+            return { Action::Ignore, state };
+        }
+        if (_isIntermediateInvalid(wch))
+        {
+            return { Action::None, VTStates::CsiIgnore };
+        }
+        return { Action::CsiDispatch, VTStates::Ground };
+    case VTStates::CsiIgnore:
+        if (_isC0Code(wch))
+        {
+            return { Action::Execute, state };
+        }
+        if (_isDelete(wch) || _isIntermediate(wch) || _isIntermediateInvalid(wch))
+        {
+            return { Action::Ignore, state };
+        }
+        return { Action::None, VTStates::Ground };
+    case VTStates::CsiParam:
+        if (_isC0Code(wch))
+        {
+            return { Action::Execute, state };
+        }
+        if (_isDelete(wch))
+        {
+            return { Action::Ignore, state };
+        }
+        if (_isNumericParamValue(wch) || _isParameterDelimiter(wch))
+        {
+            return { Action::Param, state };
+        }
+        if (_isIntermediate(wch))
+        {
+            return { Action::Collect, VTStates::CsiIntermediate };
+        }
+        if (_isParameterInvalid(wch))
+        {
+            return { Action::None, VTStates::CsiIgnore };
+        }
+        return { Action::CsiDispatch, VTStates::Ground };
+    case VTStates::OscParam:
+        if (_isOscTerminator(wch))
+        {
+            return { Action::None, VTStates::Ground };
+        }
+        if (_isNumericParamValue(wch))
+        {
+            return { Action::OscParam, state };
+        }
+        if (_isOscDelimiter(wch))
+        {
+            return { Action::None, VTStates::OscString };
+        }
+        return { Action::Ignore, state };
+    case VTStates::OscString:
+        if (_isOscTerminator(wch))
+        {
+            return { Action::OscDispatch, VTStates::Ground };
+        }
+        if (_isEscape(wch))
+        {
+            return { Action::None, VTStates::OscTermination };
+        }
+        if (_isOscInvalid(wch))
+        {
+            return { Action::Ignore, state };
+        }
+        return { Action::OscPut, state };
+    case VTStates::Ss3Entry:
+        if (_isC0Code(wch))
+        {
+            return { Action::Execute, state };
+        }
+        if (_isDelete(wch))
+        {
+            return { Action::Ignore, state };
+        }
+        if (_isCsiInvalid(wch))
+        {
+            return { Action::None, VTStates::CsiIgnore };
+        }
+        if (_isNumericParamValue(wch) || _isParameterDelimiter(wch))
+        {
+            return { Action::Param, VTStates::Ss3Param };
+        }
+        return { Action::Ss3Dispatch, VTStates::Ground };
+    case VTStates::Ss3Param:
+        if (_isC0Code(wch))
+        {
+            return { Action::Execute, state };
+        }
+        if (_isDelete(wch))
+        {
+            return { Action::Ignore, state };
+        }
+        if (_isNumericParamValue(wch) || _isParameterDelimiter(wch))
+        {
+            return { Action::Param, state };
+        }
+        if (_isParameterInvalid(wch))
+        {
+            return { Action::None, VTStates::CsiIgnore };
+        }
+        return { Action::Ss3Dispatch, VTStates::Ground };
+    case VTStates::DcsEntry:
+        if (_isC0Code(wch) || _isDelete(wch))
+        {
+            return { Action::Ignore, state };
+        }
+        if (_isCsiInvalid(wch))
+        {
+            return { Action::None, VTStates::DcsIgnore };
+        }
+        if (_isNumericParamValue(wch) || _isParameterDelimiter(wch))
+        {
+            return { Action::Param, VTStates::DcsParam };
+        }
+        if (_isIntermediate(wch))
+        {
+            return { Action::Collect, VTStates::DcsIntermediate };
+        }
+        // _ActionDcsDispatch enters DcsPassThrough or DcsIgnore by itself.
+        return { Action::DcsDispatch, state };
+    case VTStates::DcsIntermediate:
+        if (_isC0Code(wch) || _isDelete(wch))
+        {
+            return { Action::Ignore, state };
+        }
+        if (_isIntermediate(wch))
+        {
+            return { Action::Collect, state };
+        }
+        if (_isIntermediateInvalid(wch))
+        {
+            return { Action::None, VTStates::DcsIgnore };
+        }
+        return { Action::DcsDispatch, state };
+    case VTStates::DcsIgnore:
+    case VTStates::SosPmApcString:
+        return { Action::Ignore, state };
+    default:
+        return { Action::Handler, state };
     }
-    else
+}
+
+// Routine Description:
+// - Builds the transition table used by _EventFromTable. It has a dense column
+//   for every ASCII character and a single column for everything above, since
+//   C1 controls are converted to ESC sequences before they reach the table and
+//   no state distinguishes between the remaining non-ASCII characters.
+// Arguments:
+// - <none>
+// Return Value:
+// - The transition table, indexed by state and character.
+constexpr StateMachine::TransitionTable StateMachine::_BuildTransitionTable() noexcept
+{
+    TransitionTable table{};
+    for (size_t state = 0; state < table.size(); ++state)
     {
-        _ActionPrint(wch);
+        auto& row = table[state];
+        for (size_t ch = 0; ch < NonAsciiColumn; ++ch)
+        {
+            row[ch] = _GetTransition(static_cast<VTStates>(state), static_cast<wchar_t>(ch));
+        }
+        row[NonAsciiColumn] = _GetTransition(static_cast<VTStates>(state), L'\xA0');
     }
+    return table;
 }
 
 // Routine Description:
@@ -1146,109 +1428,43 @@ void StateMachine::_EventEscapeIntermediate(const wchar_t wch)
 }
 
 // Routine Description:
-// - Processes a character event into an Action that occurs while in the CsiEntry state.
+// - Handle the two-character termination of a OSC sequence.
 //   Events in this state will:
-//   1. Execute C0 control characters
-//   2. Ignore Delete characters
-//   3. Collect Intermediate characters
-//   4. Begin to ignore all remaining parameters when an invalid character is detected (CsiIgnore)
-//   5. Store parameter data
-//   6. Collect Control Sequence Private markers
-//   7. Dispatch a control sequence with parameters for action
+//   1. Trigger the OSC action associated with the param on an OscTerminator
+//   2. Otherwise treat this as a normal escape character event.
 // Arguments:
 // - wch - Character that triggered the event
 // Return Value:
 // - <none>
-void StateMachine::_EventCsiEntry(const wchar_t wch)
+void StateMachine::_EventOscTermination(const wchar_t wch)
 {
-    _trace.TraceOnEvent(L"CsiEntry");
-    if (_isC0Code(wch))
-    {
-        _ActionExecute(wch);
-    }
-    else if (_isDelete(wch))
-    {
-        _ActionIgnore();
-    }
-    else if (_isIntermediate(wch))
-    {
-        _ActionCollect(wch);
-        _EnterCsiIntermediate();
-    }
-    else if (_isCsiInvalid(wch))
-    {
-        _EnterCsiIgnore();
-    }
-    else if (_isNumericParamValue(wch) || _isParameterDelimiter(wch))
-    {
-        _ActionParam(wch);
-        _EnterCsiParam();
-    }
-    else if (_isCsiPrivateMarker(wch))
-    {
-        _ActionCollect(wch);
-        _EnterCsiParam();
-    }
-    else
+    _trace.TraceOnEvent(L"OscTermination");
+    if (_isStringTerminatorIndicator(wch))
     {
-        _ActionCsiDispatch(wch);
+        _ActionOscDispatch(wch);
         _EnterGround();
     }
-}
-
-// Routine Description:
-// - Processes a character event into an Action that occurs while in the CsiIntermediate state.
-//   Events in this state will:
-//   1. Execute C0 control characters
-//   2. Ignore Delete characters
-//   3. Collect Intermediate characters
-//   4. Begin to ignore all remaining parameters when an invalid character is detected (CsiIgnore)
-//   5. Dispatch a control sequence with parameters for action
-// Arguments:
-// - wch - Character that triggered the event
-// Return Value:
-// - <none>
-void StateMachine::_EventCsiIntermediate(const wchar_t wch)
-{
-    _trace.TraceOnEvent(L"CsiIntermediate");
-    if (_isC0Code(wch))
-    {
-        _ActionExecute(wch);
-    }
-    else if (_isIntermediate(wch))
-    {
-        _ActionCollect(wch);
-    }
-    else if (_isDelete(wch))
-    {
-        _ActionIgnore();
-    }
-    else if (_isIntermediateInvalid(wch))
-    {
-        _EnterCsiIgnore();
-    }
     else
     {
-        _ActionCsiDispatch(wch);
-        _EnterGround();
+        _EnterEscape();
+        _EventEscape(wch);
     }
 }
 
 // Routine Description:
-// - Processes a character event into an Action that occurs while in the CsiIgnore state.
+// - Processes a character event into an Action that occurs while in the Vt52Param state.
 //   Events in this state will:
 //   1. Execute C0 control characters
 //   2. Ignore Delete characters
-//   3. Collect Intermediate characters
-//   4. Begin to ignore all remaining parameters when an invalid character is detected (CsiIgnore)
-//   5. Return to Ground
+//   3. Store exactly two parameter characters
+//   4. Dispatch a control sequence with parameters for action (always Direct Cursor Address)
 // Arguments:
 // - wch - Character that triggered the event
 // Return Value:
 // - <none>
-void StateMachine::_EventCsiIgnore(const wchar_t wch)
+void StateMachine::_EventVt52Param(const wchar_t wch)
 {
-    _trace.TraceOnEvent(L"CsiIgnore");
+    _trace.TraceOnEvent(L"Vt52Param");
     if (_isC0Code(wch))
     {
         _ActionExecute(wch);
@@ -1257,88 +1473,78 @@ void StateMachine::_EventCsiIgnore(const wchar_t wch)
     {
         _ActionIgnore();
     }
-    else if (_isIntermediate(wch))
-    {
-        _ActionIgnore();
-    }
-    else if (_isIntermediateInvalid(wch))
-    {
-        _ActionIgnore();
-    }
     else
     {
-        _EnterGround();
+        _parameters.push_back(wch);
+        if (_parameters.size() == 2)
+        {
+            // The command character is processed before the parameter values,
+            // but it will always be 'Y', the Direct Cursor Address command.
+            _ActionVt52EscDispatch(L'Y');
+            _EnterGround();
+        }
     }
 }
 
 // Routine Description:
-// - Processes a character event into an Action that occurs while in the CsiParam state.
+// - Processes a character event into an Action that occurs while in the DcsParam state.
 //   Events in this state will:
-//   1. Execute C0 control characters
+//   1. Ignore C0 control characters
 //   2. Ignore Delete characters
-//   3. Collect Intermediate characters
-//   4. Begin to ignore all remaining parameters when an invalid character is detected (CsiIgnore)
-//   5. Store parameter data
-//   6. Dispatch a control sequence with parameters for action
+//   3. Collect DCS parameter data
+//   4. Enter DcsIntermediate if we see an intermediate
+//   5. Begin to ignore all remaining parameters when an invalid character is detected (DcsIgnore)
+//   6. Dispatch the Final character in preparation for parsing the data string
 // Arguments:
 // - wch - Character that triggered the event
 // Return Value:
 // - <none>
-void StateMachine::_EventCsiParam(const wchar_t wch)
+void StateMachine::_EventDcsParam(const wchar_t wch)
 {
-    _trace.TraceOnEvent(L"CsiParam");
+    _trace.TraceOnEvent(L"DcsParam");
     if (_isC0Code(wch))
     {
-        _ActionExecute(wch);
+        _ActionIgnore();
     }
     else if (_isDelete(wch))
     {
         _ActionIgnore();
     }
-    else if (_isNumericParamValue(wch) || _isParameterDelimiter(wch))
+    if (_isNumericParamValue(wch) || _isParameterDelimiter(wch))
     {
         _ActionParam(wch);
     }
     else if (_isIntermediate(wch))
     {
         _ActionCollect(wch);
-        _EnterCsiIntermediate();
+        _EnterDcsIntermediate();
     }
     else if (_isParameterInvalid(wch))
     {
-        _EnterCsiIgnore();
+        _EnterDcsIgnore();
     }
     else
     {
-        _ActionCsiDispatch(wch);
-        _EnterGround();
+        _ActionDcsDispatch(wch);
     }
 }
 
 // Routine Description:
-// - Processes a character event into an Action that occurs while in the OscParam state.
+// - Processes a character event into an Action that occurs while in the DcsPassThrough state.
 //   Events in this state will:
-//   1. Collect numeric values into an Osc Param
-//   2. Move to the OscString state on a delimiter
-//   3. Ignore everything else.
+//   1. Pass through if character is valid.
+//   2. Ignore everything else.
+//   The termination state is handled outside when an ESC is seen.
 // Arguments:
 // - wch - Character that triggered the event
 // Return Value:
 // - <none>
-void StateMachine::_EventOscParam(const wchar_t wch) noexcept
+void StateMachine::_EventDcsPassThrough(const wchar_t wch)
 {
-    _trace.TraceOnEvent(L"OscParam");
-    if (_isOscTerminator(wch))
-    {
-        _EnterGround();
-    }
-    else if (_isNumericParamValue(wch))
-    {
-        _ActionOscParam(wch);
-    }
-    else if (_isOscDelimiter(wch))
+    _trace.TraceOnEvent(L"DcsPassThrough");
+    if (_isC0Code(wch) || _isDcsPassThroughValid(wch))
     {
-        _EnterOscString();
+        _ActionDcsPassThrough({ &wch, 1 });
     }
     else
     {
@@ -1347,360 +1553,222 @@ void StateMachine::_EventOscParam(const wchar_t wch) noexcept
 }
 
 // Routine Description:
-// - Processes a character event into a Action that occurs while in the OscParam state.
-//   Events in this state will:
-//   1. Trigger the OSC action associated with the param on an OscTerminator
-//   2. If we see a ESC, enter the OscTermination state. We'll wait for one
-//      more character before we dispatch the string.
-//   3. Ignore OscInvalid characters.
-//   4. Collect everything else into the OscString
+// - Enters the given state, as requested by the transition table.
+// Arguments:
+// - state - The state to enter
+// Return Value:
+// - <none>
+void StateMachine::_EnterState(const VTStates state)
+{
+    switch (state)
+    {
+    case VTStates::Ground:
+        return _EnterGround();
+    case VTStates::Escape:
+        return _EnterEscape();
+    case VTStates::EscapeIntermediate:
+        return _EnterEscapeIntermediate();
+    case VTStates::CsiEntry:
+        return _EnterCsiEntry();
+    case VTStates::CsiIntermediate:
+        return _EnterCsiIntermediate();
+    case VTStates::CsiIgnore:
+        return _EnterCsiIgnore();
+    case VTStates::CsiParam:
+        return _EnterCsiParam();
+    case VTStates::OscParam:
+        return _EnterOscParam();
+    case VTStates::OscString:
+        return _EnterOscString();
+    case VTStates::OscTermination:
+        return _EnterOscTermination();
+    case VTStates::Ss3Entry:
+        return _EnterSs3Entry();
+    case VTStates::Ss3Param:
+        return _EnterSs3Param();
+    case VTStates::Vt52Param:
+        return _EnterVt52Param();
+    case VTStates::DcsEntry:
+        return _EnterDcsEntry();
+    case VTStates::DcsIgnore:
+        return _EnterDcsIgnore();
+    case VTStates::DcsIntermediate:
+        return _EnterDcsIntermediate();
+    case VTStates::DcsParam:
+        return _EnterDcsParam();
+    case VTStates::DcsPassThrough:
+        return _EnterDcsPassThrough();
+    case VTStates::SosPmApcString:
+        return _EnterSosPmApcString();
+    default:
+        return;
+    }
+}
+
+// Routine Description:
+// - Processes a character event in the current state. The action and the next
+//   state are looked up in a table that is generated at compile time, instead
+//   of testing the character against each class of characters in turn.
 // Arguments:
 // - wch - Character that triggered the event
 // Return Value:
 // - <none>
-void StateMachine::_EventOscString(const wchar_t wch)
-{
-    _trace.TraceOnEvent(L"OscString");
-    if (_isOscTerminator(wch))
-    {
-        _ActionOscDispatch(wch);
-        _EnterGround();
-    }
-    else if (_isEscape(wch))
-    {
-        _EnterOscTermination();
-    }
-    else if (_isOscInvalid(wch))
-    {
-        _ActionIgnore();
-    }
-    else
-    {
-        // add this character to our OSC string
-        _ActionOscPut(wch);
+void StateMachine::_EventFromTable(const wchar_t wch)
+{
+    static constexpr auto transitions = _BuildTransitionTable();
+    static constexpr std::array<const wchar_t*, StateCount> names{
+        L"Ground",
+        L"Escape",
+        L"EscapeIntermediate",
+        L"CsiEntry",
+        L"CsiIntermediate",
+        L"CsiIgnore",
+        L"CsiParam",
+        L"OscParam",
+        L"OscString",
+        L"OscTermination",
+        L"Ss3Entry",
+        L"Ss3Param",
+        L"Vt52Param",
+        L"DcsEntry",
+        L"DcsIgnore",
+        L"DcsIntermediate",
+        L"DcsParam",
+        L"DcsPassThrough",
+        L"SosPmApcString"
+    };
+
+    const auto state = _state;
+    const auto& row = til::at(transitions, static_cast<size_t>(state));
+    const auto& transition = til::at(row, std::min<size_t>(wch, NonAsciiColumn));
+
+    if (transition.action == Action::Handler)
+    {
+        switch (state)
+        {
+        case VTStates::Escape:
+            return _EventEscape(wch);
+        case VTStates::EscapeIntermediate:
+            return _EventEscapeIntermediate(wch);
+        case VTStates::OscTermination:
+            return _EventOscTermination(wch);
+        case VTStates::Vt52Param:
+            return _EventVt52Param(wch);
+        case VTStates::DcsParam:
+            return _EventDcsParam(wch);
+        case VTStates::DcsPassThrough:
+            return _EventDcsPassThrough(wch);
+        default:
+            return;
+        }
     }
-}
 
-// Routine Description:
-// - Handle the two-character termination of a OSC sequence.
-//   Events in this state will:
-//   1. Trigger the OSC action associated with the param on an OscTerminator
-//   2. Otherwise treat this as a normal escape character event.
-// Arguments:
-// - wch - Character that triggered the event
-// Return Value:
-// - <none>
-void StateMachine::_EventOscTermination(const wchar_t wch)
-{
-    _trace.TraceOnEvent(L"OscTermination");
-    if (_isStringTerminatorIndicator(wch))
-    {
-        _ActionOscDispatch(wch);
-        _EnterGround();
-    }
-    else
-    {
-        _EnterEscape();
-        _EventEscape(wch);
-    }
-}
+    _trace.TraceOnEvent(til::at(names, static_cast<size_t>(state)));
 
-// Routine Description:
-// - Processes a character event into an Action that occurs while in the Ss3Entry state.
-//   Events in this state will:
-//   1. Execute C0 control characters
-//   2. Ignore Delete characters
-//   3. Begin to ignore all remaining parameters when an invalid character is detected (CsiIgnore)
-//   4. Store parameter data
-//   5. Dispatch a control sequence with parameters for action
-//  SS3 sequences are structurally the same as CSI sequences, just with a
-//      different initiation. It's safe to reuse CSI's functions for
-//      determining if a character is a parameter, delimiter, or invalid.
-// Arguments:
-// - wch - Character that triggered the event
-// Return Value:
-// - <none>
-void StateMachine::_EventSs3Entry(const wchar_t wch)
-{
-    _trace.TraceOnEvent(L"Ss3Entry");
-    if (_isC0Code(wch))
-    {
-        _ActionExecute(wch);
-    }
-    else if (_isDelete(wch))
+    switch (transition.action)
     {
+    case Action::Ignore:
         _ActionIgnore();
-    }
-    else if (_isCsiInvalid(wch))
-    {
-        // It's safe for us to go into the CSI ignore here, because both SS3 and
-        //      CSI sequences ignore characters the same way.
-        _EnterCsiIgnore();
-    }
-    else if (_isNumericParamValue(wch) || _isParameterDelimiter(wch))
-    {
-        _ActionParam(wch);
-        _EnterSs3Param();
-    }
-    else
-    {
-        _ActionSs3Dispatch(wch);
-        _EnterGround();
-    }
-}
-
-// Routine Description:
-// - Processes a character event into an Action that occurs while in the CsiParam state.
-//   Events in this state will:
-//   1. Execute C0 control characters
-//   2. Ignore Delete characters
-//   3. Begin to ignore all remaining parameters when an invalid character is detected (CsiIgnore)
-//   4. Store parameter data
-//   5. Dispatch a control sequence with parameters for action
-// Arguments:
-// - wch - Character that triggered the event
-// Return Value:
-// - <none>
-void StateMachine::_EventSs3Param(const wchar_t wch)
-{
-    _trace.TraceOnEvent(L"Ss3Param");
-    if (_isC0Code(wch))
-    {
+        break;
+    case Action::Execute:
         _ActionExecute(wch);
-    }
-    else if (_isDelete(wch))
-    {
-        _ActionIgnore();
-    }
-    else if (_isNumericParamValue(wch) || _isParameterDelimiter(wch))
-    {
+        break;
+    case Action::Print:
+        _ActionPrint(wch);
+        break;
+    case Action::Collect:
+        _ActionCollect(wch);
+        break;
+    case Action::Param:
         _ActionParam(wch);
-    }
-    else if (_isParameterInvalid(wch))
-    {
-        _EnterCsiIgnore();
-    }
-    else
-    {
+        break;
+    case Action::CsiDispatch:
+        _ActionCsiDispatch(wch);
+        break;
+    case Action::Ss3Dispatch:
         _ActionSs3Dispatch(wch);
-        _EnterGround();
+        break;
+    case Action::DcsDispatch:
+        _ActionDcsDispatch(wch);
+        break;
+    case Action::OscParam:
+        _ActionOscParam(wch);
+        break;
+    case Action::OscPut:
+        _ActionOscPut(wch);
+        break;
+    case Action::OscDispatch:
+        _ActionOscDispatch(wch);
+        break;
+    default:
+        break;
     }
-}
 
-// Routine Description:
-// - Processes a character event into an Action that occurs while in the Vt52Param state.
-//   Events in this state will:
-//   1. Execute C0 control characters
-//   2. Ignore Delete characters
-//   3. Store exactly two parameter characters
-//   4. Dispatch a control sequence with parameters for action (always Direct Cursor Address)
-// Arguments:
-// - wch - Character that triggered the event
-// Return Value:
-// - <none>
-void StateMachine::_EventVt52Param(const wchar_t wch)
-{
-    _trace.TraceOnEvent(L"Vt52Param");
-    if (_isC0Code(wch))
-    {
-        _ActionExecute(wch);
-    }
-    else if (_isDelete(wch))
-    {
-        _ActionIgnore();
-    }
-    else
+    // Compare against the state we started in: some actions, like
+    // _ActionDcsDispatch, already moved us on to another state.
+    if (transition.next != state)
     {
-        _parameters.push_back(wch);
-        if (_parameters.size() == 2)
-        {
-            // The command character is processed before the parameter values,
-            // but it will always be 'Y', the Direct Cursor Address command.
-            _ActionVt52EscDispatch(L'Y');
-            _EnterGround();
-        }
+        _EnterState(transition.next);
     }
 }
 
 // Routine Description:
-// - Processes a character event into an Action that occurs while in the DcsEntry state.
-//   Events in this state will:
-//   1. Ignore C0 control characters
-//   2. Ignore Delete characters
-//   3. Begin to ignore all remaining characters when an invalid character is detected (DcsIgnore)
-//   4. Store parameter data
-//   5. Collect Intermediate characters
-//   6. Dispatch the Final character in preparation for parsing the data string
-//  DCS sequences are structurally almost the same as CSI sequences, just with an
-//      extra data string. It's safe to reuse CSI functions for
-//      determining if a character is a parameter, delimiter, or invalid.
+// - Accounts for characters being added to the current OSC or DCS data string.
+//   Once the string would grow past the maximum length, the limit is flagged and
+//   the remainder of the string is dropped.
 // Arguments:
-// - wch - Character that triggered the event
+// - length - The number of characters being added.
 // Return Value:
-// - <none>
-void StateMachine::_EventDcsEntry(const wchar_t wch)
+// - True if the characters fit within the limit. False otherwise.
+bool StateMachine::_ReserveStringLength(const size_t length) noexcept
 {
-    _trace.TraceOnEvent(L"DcsEntry");
-    if (_isC0Code(wch))
-    {
-        _ActionIgnore();
-    }
-    else if (_isDelete(wch))
-    {
-        _ActionIgnore();
-    }
-    else if (_isCsiInvalid(wch))
-    {
-        _EnterDcsIgnore();
-    }
-    else if (_isNumericParamValue(wch) || _isParameterDelimiter(wch))
-    {
-        _ActionParam(wch);
-        _EnterDcsParam();
-    }
-    else if (_isIntermediate(wch))
-    {
-        _ActionCollect(wch);
-        _EnterDcsIntermediate();
-    }
-    else
+    if (!_stringLimitReached &&
+        _stringLength <= _maxStringLength &&
+        length <= _maxStringLength - _stringLength)
     {
-        _ActionDcsDispatch(wch);
+        _stringLength += length;
+        return true;
     }
-}
-
-// Routine Description:
-// - Processes a character event into an Action that occurs while in the DcsIgnore state.
-//   In this state the entire DCS string is considered invalid and we will ignore everything.
-//   The termination state is handled outside when an ESC is seen.
-// Arguments:
-// - wch - Character that triggered the event
-// Return Value:
-// - <none>
-void StateMachine::_EventDcsIgnore() noexcept
-{
-    _trace.TraceOnEvent(L"DcsIgnore");
-    _ActionIgnore();
-}
 
-// Routine Description:
-// - Processes a character event into an Action that occurs while in the DcsIntermediate state.
-//   Events in this state will:
-//   1. Ignore C0 control characters
-//   2. Ignore Delete characters
-//   3. Collect intermediate data.
-//   4. Begin to ignore all remaining intermediates when an invalid character is detected (DcsIgnore)
-//   5. Dispatch the Final character in preparation for parsing the data string
-// Arguments:
-// - wch - Character that triggered the event
-// Return Value:
-// - <none>
-void StateMachine::_EventDcsIntermediate(const wchar_t wch)
-{
-    _trace.TraceOnEvent(L"DcsIntermediate");
-    if (_isC0Code(wch))
-    {
-        _ActionIgnore();
-    }
-    else if (_isDelete(wch))
-    {
-        _ActionIgnore();
-    }
-    else if (_isIntermediate(wch))
-    {
-        _ActionCollect(wch);
-    }
-    else if (_isIntermediateInvalid(wch))
-    {
-        _EnterDcsIgnore();
-    }
-    else
+    if (!_stringLimitReached)
     {
-        _ActionDcsDispatch(wch);
-    }
-}
+        _stringLimitReached = true;
 
-// Routine Description:
-// - Processes a character event into an Action that occurs while in the DcsParam state.
-//   Events in this state will:
-//   1. Ignore C0 control characters
-//   2. Ignore Delete characters
-//   3. Collect DCS parameter data
-//   4. Enter DcsIntermediate if we see an intermediate
-//   5. Begin to ignore all remaining parameters when an invalid character is detected (DcsIgnore)
-//   6. Dispatch the Final character in preparation for parsing the data string
-// Arguments:
-// - wch - Character that triggered the event
-// Return Value:
-// - <none>
-void StateMachine::_EventDcsParam(const wchar_t wch)
-{
-    _trace.TraceOnEvent(L"DcsParam");
-    if (_isC0Code(wch))
-    {
-        _ActionIgnore();
-    }
-    else if (_isDelete(wch))
-    {
-        _ActionIgnore();
-    }
-    if (_isNumericParamValue(wch) || _isParameterDelimiter(wch))
-    {
-        _ActionParam(wch);
-    }
-    else if (_isIntermediate(wch))
-    {
-        _ActionCollect(wch);
-        _EnterDcsIntermediate();
-    }
-    else if (_isParameterInvalid(wch))
-    {
-        _EnterDcsIgnore();
-    }
-    else
-    {
-        _ActionDcsDispatch(wch);
+        // Don't hold on to the memory of a string that will never be dispatched.
+        _oscString.clear();
+        _oscString.shrink_to_fit();
+        _cachedSequence.reset();
     }
+    return false;
 }
 
 // Routine Description:
-// - Processes a character event into an Action that occurs while in the DcsPassThrough state.
-//   Events in this state will:
-//   1. Pass through if character is valid.
-//   2. Ignore everything else.
-//   The termination state is handled outside when an ESC is seen.
+// - Determines how many characters at the start of the given string are plain
+//   data of the OSC or DCS string we're currently in, meaning that they would
+//   be stored or passed through without changing the state.
 // Arguments:
-// - wch - Character that triggered the event
+// - string - The characters to look at.
 // Return Value:
-// - <none>
-void StateMachine::_EventDcsPassThrough(const wchar_t wch)
+// - The number of data characters, or 0 if we're not in a data string state.
+size_t StateMachine::_StringDataLength(const std::wstring_view string) const noexcept
 {
-    _trace.TraceOnEvent(L"DcsPassThrough");
-    if (_isC0Code(wch) || _isDcsPassThroughValid(wch))
-    {
-        if (!_dcsStringHandler(wch))
+    const auto isData = [state = _state](const wchar_t wch) noexcept {
+        switch (state)
         {
-            _EnterDcsIgnore();
+        case VTStates::OscString:
+            // C0 controls (including the BEL and ESC terminators) are either
+            // ignored or end the string, and C1 controls are turned into ESC.
+            return wch >= AsciiChars::SPC && !_isC1ControlCharacter(wch);
+        case VTStates::DcsPassThrough:
+            // _isC0Code doesn't include ESC, CAN or SUB, which end the string.
+            return _isC0Code(wch) || _isDcsPassThroughValid(wch);
+        default:
+            return false;
         }
-    }
-    else
-    {
-        _ActionIgnore();
-    }
-}
+    };
 
-// Routine Description:
-// - Handle SOS/PM/APC string.
-//   In this state the entire string is ignored.
-//   The termination state is handled outside when an ESC is seen.
-// Arguments:
-// - wch - Character that triggered the event
-// Return Value:
-// - <none>
-void StateMachine::_EventSosPmApcString(const wchar_t /*wch*/) noexcept
-{
-    _trace.TraceOnEvent(L"SosPmApcString");
-    _ActionIgnore();
+    const auto end = std::find_if_not(string.begin(), string.end(), isData);
+    return gsl::narrow_cast<size_t>(end - string.begin());
 }
 
 // Routine Description:
@@ -1741,49 +1809,7 @@ void StateMachine::ProcessCharacter(const wchar_t wch)
     else
     {
         // Then pass to the current state as an event
-        switch (_state)
-        {
-        case VTStates::Ground:
-            return _EventGround(wch);
-        case VTStates::Escape:
-            return _EventEscape(wch);
-        case VTStates::EscapeIntermediate:
-            return _EventEscapeIntermediate(wch);
-        case VTStates::CsiEntry:
-            return _EventCsiEntry(wch);
-        case VTStates::CsiIntermediate:
-            return _EventCsiIntermediate(wch);
-        case VTStates::CsiIgnore:
-            return _EventCsiIgnore(wch);
-        case VTStates::CsiParam:
-            return _EventCsiParam(wch);
-        case VTStates::OscParam:
-            return _EventOscParam(wch);
-        case VTStates::OscString:
-            return _EventOscString(wch);
-        case VTStates::OscTermination:
-            return _EventOscTermination(wch);
-        case VTStates::Ss3Entry:
-            return _EventSs3Entry(wch);
-        case VTStates::Ss3Param:
-            return _EventSs3Param(wch);
-        case VTStates::Vt52Param:
-            return _EventVt52Param(wch);
-        case VTStates::DcsEntry:
-            return _EventDcsEntry(wch);
-        case VTStates::DcsIgnore:
-            return _EventDcsIgnore();
-        case VTStates::DcsIntermediate:
-            return _EventDcsIntermediate(wch);
-        case VTStates::DcsParam:
-            return _EventDcsParam(wch);
-        case VTStates::DcsPassThrough:
-            return _EventDcsPassThrough(wch);
-        case VTStates::SosPmApcString:
-            return _EventSosPmApcString(wch);
-        default:
-            return;
-        }
+        _EventFromTable(wch);
     }
 }
 // Method Description:
@@ -1793,8 +1819,8 @@ void StateMachine::ProcessCharacter(const wchar_t wch)
 //      get handed to the OutputStateMachineEngine, so that it can write strings
 //      it doesn't understand to the tty.
 //  This does not modify the state of the state machine. Callers should be in
-//      the Action*Dispatch state, and upon completion, the state's handler (eg
-//      _EventCsiParam) should move us into the ground state.
+//      the Action*Dispatch state, and upon completion, the state's transition (eg
+//      CsiParam to Ground) should move us into the ground state.
 // Arguments:
 // - <none>
 // Return Value:
@@ -1835,6 +1861,8 @@ bool StateMachine::FlushToTerminal()
 // - <none>
 void StateMachine::ProcessString(const std::wstring_view string)
 {
+    TIL_COUNTER_ADD(chars_parsed, string.size());
+
     size_t start = 0;
     size_t current = start;
 
@@ -1852,6 +1880,24 @@ void StateMachine::ProcessString(const std::wstring_view string)
 
         if (_processingIndividually)
         {
+            // OSC and DCS data strings can be megabytes long. Rather than feeding
+            // them through the state machine one character at a time, hand over
+            // everything up to the next control character in one go.
+            if (const auto dataLength = _StringDataLength(string.substr(current)))
+            {
+                const auto data = string.substr(current, dataLength);
+                if (_state == VTStates::OscString)
+                {
+                    _ActionOscPutString(data);
+                }
+                else
+                {
+                    _ActionDcsPassThrough(data);
+                }
+                current += dataLength;
+                continue;
+            }
+
             // If we're processing characters individually, send it to the state machine.
             ProcessCharacter(til::at(string, current));
             ++current;
@@ -1976,14 +2022,171 @@ void StateMachine::ProcessString(const std::wstring_view string)
             // If the engine doesn't require flushing at the end of the string, we
             // want to cache the partial sequence in case we have to flush the whole
             // thing to the terminal later.
-            if (!_cachedSequence)
+            // A data string that went over the length limit won't be dispatched,
+            // so there's nothing to flush and no point in holding on to it.
+            if (!_stringLimitReached)
             {
-                _cachedSequence.emplace(std::wstring{});
+                if (!_cachedSequence)
+                {
+                    _cachedSequence.emplace(std::wstring{});
+                }
+
+                auto& cachedSequence = *_cachedSequence;
+                cachedSequence.append(run);
             }
+        }
+    }
+}
+
+// Routine Description:
+// - Determines if the UTF-8 code unit at the given offset has to be handled by
+//   the state machine when we're in the ground state. These are the same
+//   characters _isActionableFromGround matches: C0 controls, DEL and C1
+//   controls (U+0080-U+009F, encoded as C2 80-C2 9F in UTF-8).
+// Arguments:
+// - string - The UTF-8 string to check.
+// - offset - The offset of the code unit to check.
+// Return Value:
+// - True if it is. False if it isn't.
+static constexpr bool _isUtf8ActionableFromGround(const std::string_view string, const size_t offset) noexcept
+{
+    const auto ch = gsl::narrow_cast<uint8_t>(til::at(string, offset));
+    if (ch <= AsciiChars::US || ch == AsciiChars::DEL)
+    {
+        return true;
+    }
+    if (ch == 0xC2)
+    {
+        // A trailing lead byte might still turn into a C1 control.
+        if (offset + 1 >= string.size())
+        {
+            return true;
+        }
+        const auto next = gsl::narrow_cast<uint8_t>(til::at(string, offset + 1));
+        return next >= 0x80 && next <= 0x9F;
+    }
+    return false;
+}
 
-            auto& cachedSequence = *_cachedSequence;
-            cachedSequence.append(run);
+// Routine Description:
+// - Determines if the UTF-8 code unit right before the given offset could be
+//   the last one of a control sequence or control function, which means that
+//   the state machine might be back in the ground state once it has processed it.
+// - This is only a cheap guess: C0 controls other than ESC, and final
+//   characters that don't directly follow an ESC (like the '[' in ESC [).
+// Arguments:
+// - string - The UTF-8 string to check.
+// - offset - The offset right after the code unit to check.
+// Return Value:
+// - True if it might be. False if it isn't.
+static constexpr bool _isUtf8SequenceEnd(const std::string_view string, const size_t offset) noexcept
+{
+    const auto ch = gsl::narrow_cast<uint8_t>(til::at(string, offset - 1));
+    if (ch <= AsciiChars::US)
+    {
+        return ch != AsciiChars::ESC;
+    }
+    if (ch >= 0x40 && ch <= 0x7E)
+    {
+        return offset < 2 || til::at(string, offset - 2) != AsciiChars::ESC;
+    }
+    return false;
+}
+
+// Routine Description:
+// - Transcodes the given UTF-8 string into our reusable buffer. Incomplete
+//   code points at the end are carried over to the next call.
+// - Pure ASCII, which is the bulk of build logs and the like, is simply
+//   widened instead of going through the platform converter.
+// Arguments:
+// - string - The UTF-8 string to transcode.
+// Return Value:
+// - A view of the UTF-16 text. It's valid until the next call.
+std::wstring_view StateMachine::_TranscodeUtf8(const std::string_view string)
+{
+    const auto isAscii = std::all_of(string.begin(), string.end(), [](const char ch) {
+        return gsl::narrow_cast<uint8_t>(ch) < 0x80;
+    });
+
+    if (isAscii && !_utf8MayHavePartials)
+    {
+        _utf8Buffer.resize(string.size());
+        std::transform(string.begin(), string.end(), _utf8Buffer.begin(), [](const char ch) {
+            return gsl::narrow_cast<wchar_t>(ch);
+        });
+    }
+    else
+    {
+        THROW_IF_FAILED(til::u8u16(string, _utf8Buffer, _utf8State));
+        // The state only ever holds on to a partial if the string ended in a
+        // non-ASCII code unit. Until we've seen an ASCII one again we have to
+        // go through the converter, so that the partial gets completed.
+        _utf8MayHavePartials = !string.empty() && gsl::narrow_cast<uint8_t>(string.back()) >= 0x80;
+    }
+
+    return _utf8Buffer;
+}
+
+// Routine Description:
+// - Processes UTF-8 encoded output directly, without requiring the caller to
+//   transcode whole chunks to UTF-16 first.
+// - Runs of printable text in the ground state are found on the UTF-8 bytes,
+//   transcoded into a buffer the state machine reuses, and handed to the
+//   engine in one go. Only the stretches of input around control characters
+//   and sequences go through ProcessString.
+// - Code points split across two calls are handled.
+// Arguments:
+// - string - UTF-8 encoded output to process.
+// Return Value:
+// - <none>
+void StateMachine::ProcessUtf8(const std::string_view string)
+{
+    // Engines that flush at the end of every string interpret partial
+    // sequences at the end of a call. We'd be introducing such ends whenever
+    // we split the input, so they get the whole string at once.
+    if (_engine->FlushAtEndOfString())
+    {
+        ProcessString(_TranscodeUtf8(string));
+        return;
+    }
+
+    size_t current = 0;
+    while (current < string.size())
+    {
+        const auto start = current;
+
+        // A continuation byte at the start may complete a C1 control that was
+        // split across two calls, so that has to go through the state machine.
+        const auto mayCompletePartial = start == 0 && _utf8MayHavePartials;
+
+        if (_state == VTStates::Ground && !_processingIndividually && !mayCompletePartial && !_isUtf8ActionableFromGround(string, current))
+        {
+            do
+            {
+                ++current;
+            } while (current < string.size() && !_isUtf8ActionableFromGround(string, current));
+
+            const auto run = _TranscodeUtf8(string.substr(start, current - start));
+            if (!run.empty())
+            {
+                // Everything else is counted by ProcessString.
+                TIL_COUNTER_ADD(chars_parsed, run.size());
+                _engine->ActionPrintString(run);
+                _trace.DispatchPrintRunTrace(run);
+            }
+            continue;
         }
+
+        // Everything else goes through the state machine, up to a point where
+        // a control sequence or function may have ended and printable text starts.
+        // If we guessed wrong, we'll simply end up back here on the next iteration.
+        do
+        {
+            ++current;
+        } while (current < string.size() &&
+                 !(_isUtf8SequenceEnd(string, current) && !_isUtf8ActionableFromGround(string, current)));
+
+        ProcessString(_TranscodeUtf8(string.substr(start, current - start)));
     }
 }
 
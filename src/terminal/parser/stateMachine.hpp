@@ -32,6 +32,12 @@ namespace Microsoft::Console::VirtualTerminal
     // that number.
     constexpr size_t MAX_PARAMETER_COUNT = 32;
 
+    // OSC and DCS data strings have no length limit in the standards, but we
+    // have to buffer them (or hand them to an engine which does), so a runaway
+    // or hostile payload could consume all of our memory. The default is large
+    // enough for an OSC 52 clipboard copy of a few megabytes of base64.
+    constexpr size_t MAX_STRING_LENGTH = 8 * 1024 * 1024;
+
     class StateMachine final
     {
 #ifdef UNIT_TESTING
@@ -43,9 +49,11 @@ namespace Microsoft::Console::VirtualTerminal
         StateMachine(std::unique_ptr<IStateMachineEngine> engine);
 
         void SetAnsiMode(bool ansiMode) noexcept;
+        void SetMaxStringLength(const size_t maxStringLength) noexcept;
 
         void ProcessCharacter(const wchar_t wch);
         void ProcessString(const std::wstring_view string);
+        void ProcessUtf8(const std::string_view string);
 
         void ResetState() noexcept;
 
@@ -65,6 +73,8 @@ namespace Microsoft::Console::VirtualTerminal
         void _ActionCsiDispatch(const wchar_t wch);
         void _ActionOscParam(const wchar_t wch) noexcept;
         void _ActionOscPut(const wchar_t wch);
+        void _ActionOscPutString(const std::wstring_view string);
+        void _ActionDcsPassThrough(const std::wstring_view string);
         void _ActionOscDispatch(const wchar_t wch);
         void _ActionSs3Dispatch(const wchar_t wch);
         void _ActionDcsDispatch(const wchar_t wch);
@@ -93,28 +103,17 @@ namespace Microsoft::Console::VirtualTerminal
         void _EnterDcsPassThrough() noexcept;
         void _EnterSosPmApcString() noexcept;
 
-        void _EventGround(const wchar_t wch);
         void _EventEscape(const wchar_t wch);
         void _EventEscapeIntermediate(const wchar_t wch);
-        void _EventCsiEntry(const wchar_t wch);
-        void _EventCsiIntermediate(const wchar_t wch);
-        void _EventCsiIgnore(const wchar_t wch);
-        void _EventCsiParam(const wchar_t wch);
-        void _EventOscParam(const wchar_t wch) noexcept;
-        void _EventOscString(const wchar_t wch);
         void _EventOscTermination(const wchar_t wch);
-        void _EventSs3Entry(const wchar_t wch);
-        void _EventSs3Param(const wchar_t wch);
         void _EventVt52Param(const wchar_t wch);
-        void _EventDcsEntry(const wchar_t wch);
-        void _EventDcsIgnore() noexcept;
-        void _EventDcsIntermediate(const wchar_t wch);
         void _EventDcsParam(const wchar_t wch);
         void _EventDcsPassThrough(const wchar_t wch);
-        void _EventSosPmApcString(const wchar_t wch) noexcept;
 
         void _AccumulateTo(const wchar_t wch, size_t& value) noexcept;
 
+        std::wstring_view _TranscodeUtf8(const std::string_view string);
+
         enum class VTStates
         {
             Ground,
@@ -138,6 +137,44 @@ namespace Microsoft::Console::VirtualTerminal
             SosPmApcString
         };
 
+        // The actions of the table-driven states. Action::Handler marks the
+        // states that depend on more than the character, like the engine's
+        // settings or the ANSI mode, and still have an _Event function.
+        enum class Action : uint8_t
+        {
+            None,
+            Ignore,
+            Execute,
+            Print,
+            Collect,
+            Param,
+            CsiDispatch,
+            Ss3Dispatch,
+            DcsDispatch,
+            OscParam,
+            OscPut,
+            OscDispatch,
+            Handler
+        };
+
+        struct Transition
+        {
+            Action action;
+            VTStates next;
+        };
+
+        static constexpr size_t StateCount = static_cast<size_t>(VTStates::SosPmApcString) + 1;
+        static constexpr size_t NonAsciiColumn = 0x80;
+        using TransitionTable = std::array<std::array<Transition, NonAsciiColumn + 1>, StateCount>;
+
+        static constexpr Transition _GetTransition(const VTStates state, const wchar_t wch) noexcept;
+        static constexpr TransitionTable _BuildTransitionTable() noexcept;
+        void _EnterState(const VTStates state);
+        void _EventFromTable(const wchar_t wch);
+
+        bool _ReserveStringLength(const size_t length) noexcept;
+        size_t _StringDataLength(const std::wstring_view string) const noexcept;
+
         Microsoft::Console::VirtualTerminal::ParserTracing _trace;
 
         std::unique_ptr<IStateMachineEngine> _engine;
@@ -166,6 +203,10 @@ namespace Microsoft::Console::VirtualTerminal
         std::wstring _oscString;
         size_t _oscParameter;
 
+        size_t _maxStringLength;
+        size_t _stringLength;
+        bool _stringLimitReached;
+
         IStateMachineEngine::StringHandler _dcsStringHandler;
 
         std::optional<std::wstring> _cachedSequence;
@@ -173,5 +214,11 @@ namespace Microsoft::Console::VirtualTerminal
         // This is tracked per state machine instance so that separate calls to Process*
         //   can start and finish a sequence.
         bool _processingIndividually;
+
+        // State for ProcessUtf8. The buffer is reused across calls so that we
+        // don't allocate a new string for every chunk of output.
+        til::u8state _utf8State;
+        std::wstring _utf8Buffer;
+        bool _utf8MayHavePartials{ false };
     };
 }
@@ -35,6 +35,9 @@ class Microsoft::Console::VirtualTerminal::Base64Test
         VERIFY_ARE_EQUAL(L"Zm9vYmE=", Base64::s_Encode(L"fooba"));
         VERIFY_ARE_EQUAL(L"Zm9vYmFy", Base64::s_Encode(L"foobar"));
         VERIFY_ARE_EQUAL(L"Zm9vYmFyDQo=", Base64::s_Encode(L"foobar\r\n"));
+
+        // Non-ASCII text is encoded as UTF-8.
+        VERIFY_ARE_EQUAL(L"44Gr44G744KT44GU5rGJ6K+t7ZWc6rWt", Base64::s_Encode(L"にほんご汉语한국"));
     }
 
     TEST_METHOD(TestBase64Decode)
@@ -98,4 +101,85 @@ class Microsoft::Console::VirtualTerminal::Base64Test
         VERIFY_ARE_EQUAL(true, success);
         VERIFY_ARE_EQUAL(L"👍👍🏻👍🏼👍🏽👍🏾👍🏿", result);
     }
+
+    TEST_METHOD(TestBase64DecodeLongStrings)
+    {
+        // Long enough for the bulk decoding of blocks to kick in, covering
+        // all of ASCII and some multi-byte UTF-8 sequences.
+        std::wstring text;
+        for (wchar_t ch = 0; ch < 0x80; ++ch)
+        {
+            text.push_back(ch);
+        }
+        text.append(L"にほんご汉语한국👍🏽");
+
+        const auto encoded = Base64::s_Encode(text);
+
+        std::wstring result;
+        VERIFY_ARE_EQUAL(true, Base64::s_Decode(encoded, result));
+        VERIFY_ARE_EQUAL(text, result);
+
+        // Whitespace interrupting the blocks at any offset.
+        for (size_t offset = 1; offset < 16; ++offset)
+        {
+            auto wrapped = encoded;
+            for (auto pos = offset; pos < wrapped.size(); pos += 19)
+            {
+                wrapped.insert(pos, L"\r\n");
+            }
+
+            result = L"";
+            VERIFY_ARE_EQUAL(true, Base64::s_Decode(wrapped, result));
+            VERIFY_ARE_EQUAL(text, result);
+        }
+
+        // An invalid character in the middle of a block, and after a block.
+        auto invalid = encoded;
+        invalid[5] = L'!';
+        VERIFY_ARE_EQUAL(false, Base64::s_Decode(invalid, result));
+        invalid = encoded;
+        invalid[8] = L'\x4100';
+        VERIFY_ARE_EQUAL(false, Base64::s_Decode(invalid, result));
+    }
+
+    TEST_METHOD(TestBase64DecoderChunks)
+    {
+        const std::wstring encoded = L"Zm9vYmFyZm9v\r\nYmFyZm9vYmE=";
+        const std::string expected = "foobarfoobarfooba";
+
+        for (size_t chunkSize = 1; chunkSize <= encoded.size(); ++chunkSize)
+        {
+            Base64::Decoder decoder;
+            std::string result;
+            for (size_t i = 0; i < encoded.size(); i += chunkSize)
+            {
+                VERIFY_ARE_EQUAL(true, decoder.Decode(std::wstring_view{ encoded }.substr(i, chunkSize), result));
+            }
+            VERIFY_ARE_EQUAL(true, decoder.Finish());
+            VERIFY_ARE_EQUAL(expected, result);
+        }
+
+        Base64::Decoder decoder;
+        std::string result;
+
+        // A string that stops in the middle of a quantum or the padding isn't complete.
+        VERIFY_ARE_EQUAL(true, decoder.Decode(L"Zm9vY", result));
+        VERIFY_ARE_EQUAL(false, decoder.Finish());
+        VERIFY_ARE_EQUAL(true, decoder.Decode(L"g=", result));
+        VERIFY_ARE_EQUAL(false, decoder.Finish());
+        VERIFY_ARE_EQUAL(true, decoder.Decode(L"=", result));
+        VERIFY_ARE_EQUAL(true, decoder.Finish());
+        VERIFY_ARE_EQUAL(std::string{ "foob" }, result);
+
+        // Nothing but whitespace may follow the padding, and a failed decoder stays failed.
+        VERIFY_ARE_EQUAL(false, decoder.Decode(L"Zm9v", result));
+        VERIFY_ARE_EQUAL(false, decoder.Decode(L"", result));
+        VERIFY_ARE_EQUAL(false, decoder.Finish());
+
+        decoder.Reset();
+        result.clear();
+        VERIFY_ARE_EQUAL(true, decoder.Decode(L"Zm9v", result));
+        VERIFY_ARE_EQUAL(true, decoder.Finish());
+        VERIFY_ARE_EQUAL(std::string{ "foo" }, result);
+    }
 };
@@ -38,6 +38,9 @@ public:
         dcsId = 0;
         dcsParams.clear();
         dcsDataString.clear();
+        dcsDataChunks = 0;
+        oscString.clear();
+        oscDispatchCount = 0;
     }
 
     bool ActionExecute(const wchar_t wch) override
@@ -70,8 +73,10 @@ public:
 
     bool ActionOscDispatch(const wchar_t /* wch */,
                            const size_t /* parameter */,
-                           const std::wstring_view /* string */) override
+                           const std::wstring_view string) override
     {
+        oscString = string;
+        ++oscDispatchCount;
         if (pfnFlushToTerminal)
         {
             pfnFlushToTerminal();
@@ -115,7 +120,7 @@ public:
             dcsParams.push_back(parameters.at(i).value_or(0));
         }
         dcsDataString.clear();
-        return [=](const auto ch) { dcsDataString += ch; return true; };
+        return [=](const auto chunk) { dcsDataString += chunk; ++dcsDataChunks; return true; };
     }
 
     // These will only be populated if ActionCsiDispatch is called.
@@ -138,6 +143,11 @@ public:
     uint64_t dcsId = 0;
     std::vector<size_t> dcsParams;
     std::wstring dcsDataString;
+    size_t dcsDataChunks = 0;
+
+    // These will only be populated if ActionOscDispatch is called.
+    std::wstring oscString;
+    size_t oscDispatchCount = 0;
 };
 
 class Microsoft::Console::VirtualTerminal::StateMachineTest
@@ -162,6 +172,12 @@ class Microsoft::Console::VirtualTerminal::StateMachineTest
     TEST_METHOD(PassThroughUnhandledSplitAcrossWrites);
 
     TEST_METHOD(DcsDataStringsReceivedByHandler);
+    TEST_METHOD(DataStringsDeliveredInChunks);
+    TEST_METHOD(DataStringsOverLimitAreDropped);
+
+    TEST_METHOD(Utf8TextAndSequences);
+    TEST_METHOD(Utf8SplitAcrossWrites);
+    TEST_METHOD(Utf8C1Controls);
 };
 
 void StateMachineTest::TwoStateMachinesDoNotInterfereWithEachother()
@@ -342,3 +358,148 @@ void StateMachineTest::DcsDataStringsReceivedByHandler()
     // Verify the control characters were executed (if expected).
     VERIFY_ARE_EQUAL(expectedExecuted, engine.executed);
 }
+
+void StateMachineTest::DataStringsDeliveredInChunks()
+{
+    auto enginePtr{ std::make_unique<TestStateMachineEngine>() };
+    // this dance is required because StateMachine presumes to take ownership of its engine.
+    auto& engine{ *enginePtr.get() };
+    StateMachine machine{ std::move(enginePtr) };
+
+    const std::wstring data(1000, L'x');
+
+    Log::Comment(L"A DCS data string is handed over in one piece, followed by the terminating ESC.");
+    machine.ProcessString(L"\033P1;2;3|" + data + L"\033\\");
+    VERIFY_ARE_EQUAL(data + L"\033", engine.dcsDataString);
+    VERIFY_ARE_EQUAL(2u, engine.dcsDataChunks);
+
+    Log::Comment(L"A data string split across writes is handed over once per write.");
+    engine.ResetTestState();
+    machine.ProcessString(L"\033P|" + data);
+    machine.ProcessString(data + L"\033\\");
+    VERIFY_ARE_EQUAL(data + data + L"\033", engine.dcsDataString);
+    VERIFY_ARE_EQUAL(3u, engine.dcsDataChunks);
+
+    Log::Comment(L"An OSC string is still dispatched as a whole, C0 controls excluded.");
+    engine.ResetTestState();
+    machine.ProcessString(L"\033]52;" + data + L"\001" + data);
+    machine.ProcessString(data + L"\a");
+    VERIFY_ARE_EQUAL(data + data + data, engine.oscString);
+    VERIFY_ARE_EQUAL(1u, engine.oscDispatchCount);
+}
+
+void StateMachineTest::DataStringsOverLimitAreDropped()
+{
+    auto enginePtr{ std::make_unique<TestStateMachineEngine>() };
+    // this dance is required because StateMachine presumes to take ownership of its engine.
+    auto& engine{ *enginePtr.get() };
+    StateMachine machine{ std::move(enginePtr) };
+    machine.SetMaxStringLength(16);
+
+    Log::Comment(L"An OSC string at the limit is dispatched.");
+    machine.ProcessString(L"\033]0;" + std::wstring(16, L'x') + L"\a");
+    VERIFY_ARE_EQUAL(1u, engine.oscDispatchCount);
+    VERIFY_ARE_EQUAL(std::wstring(16, L'x'), engine.oscString);
+
+    Log::Comment(L"An OSC string over the limit is dropped, even when it arrives in pieces.");
+    engine.ResetTestState();
+    machine.ProcessString(L"\033]0;" + std::wstring(10, L'x'));
+    machine.ProcessString(std::wstring(10, L'x') + L"\a");
+    VERIFY_ARE_EQUAL(0u, engine.oscDispatchCount);
+
+    Log::Comment(L"A DCS string over the limit is ignored up to its terminator.");
+    engine.ResetTestState();
+    machine.ProcessString(L"\033P|" + std::wstring(20, L'x') + L"\033\\");
+    VERIFY_ARE_EQUAL(L"", engine.dcsDataString);
+
+    Log::Comment(L"The limit applies per string, so the following sequences work again.");
+    machine.ProcessString(L"\033]0;title\a");
+    machine.ProcessString(L"printed text");
+    VERIFY_ARE_EQUAL(1u, engine.oscDispatchCount);
+    VERIFY_ARE_EQUAL(L"title", engine.oscString);
+    VERIFY_ARE_EQUAL(L"printed text", engine.printed);
+}
+
+void StateMachineTest::Utf8TextAndSequences()
+{
+    auto enginePtr{ std::make_unique<TestStateMachineEngine>() };
+    // this dance is required because StateMachine presumes to take ownership of its engine.
+    auto& engine{ *enginePtr.get() };
+    StateMachine machine{ std::move(enginePtr) };
+
+    // "caf\u00e9 \U0001F32F" followed by a CSI sequence, more text and a CRLF.
+    machine.ProcessUtf8("caf\xC3\xA9 \xF0\x9F\x8C\xAF\x1b[12;34mdone\r\n");
+
+    VERIFY_ARE_EQUAL(L"caf\u00e9 \U0001F32Fdone", engine.printed);
+    VERIFY_ARE_EQUAL(std::vector<size_t>({ 12, 34 }), engine.csiParams);
+    VERIFY_ARE_EQUAL(L"\r\n", engine.executed);
+
+    engine.ResetTestState();
+
+    // The same output must produce the same result through ProcessString.
+    machine.ProcessString(L"caf\u00e9 \U0001F32F\x1b[12;34mdone\r\n");
+
+    VERIFY_ARE_EQUAL(L"caf\u00e9 \U0001F32Fdone", engine.printed);
+    VERIFY_ARE_EQUAL(std::vector<size_t>({ 12, 34 }), engine.csiParams);
+    VERIFY_ARE_EQUAL(L"\r\n", engine.executed);
+}
+
+void StateMachineTest::Utf8SplitAcrossWrites()
+{
+    auto enginePtr{ std::make_unique<TestStateMachineEngine>() };
+    // this dance is required because StateMachine presumes to take ownership of its engine.
+    auto& engine{ *enginePtr.get() };
+    StateMachine machine{ std::move(enginePtr) };
+
+    Log::Comment(L"A code point split across two writes");
+    machine.ProcessUtf8("caf\xC3");
+    VERIFY_ARE_EQUAL(L"caf", engine.printed);
+    machine.ProcessUtf8("\xA9!");
+    VERIFY_ARE_EQUAL(L"caf\u00e9!", engine.printed);
+
+    engine.ResetTestState();
+
+    Log::Comment(L"A four byte code point split across three writes");
+    machine.ProcessUtf8("\xF0\x9F");
+    machine.ProcessUtf8("\x8C");
+    machine.ProcessUtf8("\xAF");
+    VERIFY_ARE_EQUAL(L"\U0001F32F", engine.printed);
+
+    engine.ResetTestState();
+
+    Log::Comment(L"A sequence split across two writes");
+    machine.ProcessUtf8("a\x1b[1");
+    VERIFY_ARE_EQUAL(L"a", engine.printed);
+    VERIFY_ARE_EQUAL(0u, engine.csiParams.size());
+    machine.ProcessUtf8("2;34mb");
+    VERIFY_ARE_EQUAL(L"ab", engine.printed);
+    VERIFY_ARE_EQUAL(std::vector<size_t>({ 12, 34 }), engine.csiParams);
+}
+
+void StateMachineTest::Utf8C1Controls()
+{
+    auto enginePtr{ std::make_unique<TestStateMachineEngine>() };
+    // this dance is required because StateMachine presumes to take ownership of its engine.
+    auto& engine{ *enginePtr.get() };
+    StateMachine machine{ std::move(enginePtr) };
+
+    Log::Comment(L"U+009B (C1 CSI) encoded as UTF-8");
+    machine.ProcessUtf8("a\xC2\x9B" "31mb");
+    VERIFY_ARE_EQUAL(L"ab", engine.printed);
+    VERIFY_ARE_EQUAL(std::vector<size_t>({ 31 }), engine.csiParams);
+
+    engine.ResetTestState();
+
+    Log::Comment(L"U+009B split across two writes");
+    machine.ProcessUtf8("a\xC2");
+    machine.ProcessUtf8("\x9B" "5mb");
+    VERIFY_ARE_EQUAL(L"ab", engine.printed);
+    VERIFY_ARE_EQUAL(std::vector<size_t>({ 5 }), engine.csiParams);
+
+    engine.ResetTestState();
+
+    Log::Comment(L"Other characters with the same lead byte are printed");
+    machine.ProcessUtf8("\xC2\xA9");
+    VERIFY_ARE_EQUAL(L"\u00a9", engine.printed);
+    VERIFY_ARE_EQUAL(0u, engine.csiParams.size());
+}
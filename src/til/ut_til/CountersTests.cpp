@@ -0,0 +1,76 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#include "precomp.h"
+
+#include "til/counters.h"
+
+using namespace WEX::Common;
+using namespace WEX::Logging;
+using namespace WEX::TestExecution;
+
+using namespace til::counters;
+
+class CountersTests
+{
+    TEST_CLASS(CountersTests);
+
+    TEST_METHOD_SETUP(MethodSetup)
+    {
+        reset();
+        return true;
+    }
+
+    TEST_METHOD(AddAndReset)
+    {
+        add(counter::chars_parsed, 10);
+        add(counter::chars_parsed, 5);
+        add(counter::sequences_csi);
+
+        auto s = collect();
+        VERIFY_ARE_EQUAL(15u, s.counters[static_cast<size_t>(counter::chars_parsed)]);
+        VERIFY_ARE_EQUAL(1u, s.counters[static_cast<size_t>(counter::sequences_csi)]);
+        VERIFY_ARE_EQUAL(0u, s.counters[static_cast<size_t>(counter::reflows)]);
+
+        reset();
+
+        s = collect();
+        VERIFY_ARE_EQUAL(0u, s.counters[static_cast<size_t>(counter::chars_parsed)]);
+        VERIFY_ARE_EQUAL(0u, s.counters[static_cast<size_t>(counter::sequences_csi)]);
+    }
+
+    TEST_METHOD(HistogramBuckets)
+    {
+        record(histogram::lock_wait_ns, 0);
+        record(histogram::lock_wait_ns, 1);
+        record(histogram::lock_wait_ns, 100);
+        record(histogram::lock_wait_ns, 127);
+
+        const auto s = collect();
+        const auto& h = s.histograms[static_cast<size_t>(histogram::lock_wait_ns)];
+        VERIFY_ARE_EQUAL(228u, h.sum);
+        VERIFY_ARE_EQUAL(1u, h.buckets[0]);
+        VERIFY_ARE_EQUAL(1u, h.buckets[1]);
+        VERIFY_ARE_EQUAL(2u, h.buckets[7]);
+    }
+
+    TEST_METHOD(CountsFromOtherThreads)
+    {
+        Log::Comment(L"Counts of threads that have exited must be kept.");
+        std::thread{ [] { add(counter::rows_written, 3); } }.join();
+        add(counter::rows_written, 4);
+
+        const auto s = collect();
+        VERIFY_ARE_EQUAL(7u, s.counters[static_cast<size_t>(counter::rows_written)]);
+    }
+
+    TEST_METHOD(Json)
+    {
+        add(counter::reflows, 2);
+        record(histogram::lock_wait_ns, 100);
+
+        const auto json = dump_json();
+        VERIFY_ARE_NOT_EQUAL(std::string::npos, json.find("\"reflows\":2"));
+        VERIFY_ARE_NOT_EQUAL(std::string::npos, json.find("\"lockWaitNs\":{\"count\":1,\"sum\":100,\"buckets\":{\"7\":1}}"));
+    }
+};
@@ -17,6 +17,9 @@ class Utf8Utf16ConvertTests
     TEST_METHOD(TestU8ToU16Partials);
     TEST_METHOD(TestU16ToU8Partials);
     TEST_METHOD(TestU8ToU16OneByOne);
+    TEST_METHOD(TestU8ToU16AsciiBlocks);
+    TEST_METHOD(TestU16ToU8AsciiBlocks);
+    TEST_METHOD(TestU8StateWithoutPartials);
 };
 
 void Utf8Utf16ConvertTests::TestU8ToU16()
@@ -191,3 +194,74 @@ void Utf8Utf16ConvertTests::TestU8ToU16OneByOne()
     VERIFY_SUCCEEDED(til::u8u16(u8String1_4, u16Out1, state));
     VERIFY_ARE_EQUAL(u16StringComp1, u16Out1);
 }
+
+// The ASCII fast path works on blocks of 16 code units. Put a non-ASCII
+// character at every position across a few blocks, so that it is found in
+// the SIMD loop, in the scalar tail and right at their borders.
+void Utf8Utf16ConvertTests::TestU8ToU16AsciiBlocks()
+{
+    for (size_t length = 0; length <= 40; ++length)
+    {
+        for (size_t pos = 0; pos <= length; ++pos)
+        {
+            std::string u8String(length, 'a');
+            std::wstring u16StringComp(length, L'a');
+            if (pos < length)
+            {
+                u8String.replace(pos, 1, "\xE2\x82\xAC"); // EURO SIGN (3 bytes)
+                u16StringComp[pos] = gsl::narrow_cast<wchar_t>(0x20acU);
+            }
+
+            std::wstring u16Out{};
+            VERIFY_ARE_EQUAL(S_OK, til::u8u16(u8String, u16Out));
+            VERIFY_ARE_EQUAL(u16StringComp, u16Out);
+        }
+    }
+}
+
+void Utf8Utf16ConvertTests::TestU16ToU8AsciiBlocks()
+{
+    for (size_t length = 0; length <= 40; ++length)
+    {
+        for (size_t pos = 0; pos <= length; ++pos)
+        {
+            std::wstring u16String(length, L'a');
+            std::string u8StringComp(length, 'a');
+            if (pos < length)
+            {
+                // 0x0100 is the smallest code unit that an unsigned saturation
+                // would silently turn into 0xFF. It must not be taken for ASCII.
+                u16String[pos] = gsl::narrow_cast<wchar_t>(0x0100U); // LATIN CAPITAL LETTER A WITH MACRON
+                u8StringComp.replace(pos, 1, "\xC4\x80");
+            }
+
+            std::string u8Out{};
+            VERIFY_ARE_EQUAL(S_OK, til::u16u8(u16String, u8Out));
+            VERIFY_ARE_EQUAL(u8StringComp, u8Out);
+        }
+    }
+}
+
+void Utf8Utf16ConvertTests::TestU8StateWithoutPartials()
+{
+    const std::string_view u8String1{ "abc\xC3" }; // ends with the lead byte of LATIN SMALL LETTER O WITH DIAERESIS
+    const std::string_view u8String2{ "\xB6" "def" };
+    const std::string_view u8String3{ "ghi" };
+
+    til::u8state state{};
+    std::string_view u8Out{};
+
+    Log::Comment(L"Without cached partials the input is handed out as is, minus the trailing partial.");
+    VERIFY_ARE_EQUAL(S_OK, state(u8String1, u8Out));
+    VERIFY_ARE_EQUAL(std::string{ "abc" }, std::string{ u8Out });
+    VERIFY_IS_TRUE(u8Out.data() == u8String1.data());
+
+    Log::Comment(L"The cached partial is still prepended to the next input.");
+    VERIFY_ARE_EQUAL(S_OK, state(u8String2, u8Out));
+    VERIFY_ARE_EQUAL(std::string{ "\xC3\xB6" "def" }, std::string{ u8Out });
+
+    Log::Comment(L"Once the partial is consumed, the input isn't copied anymore.");
+    VERIFY_ARE_EQUAL(S_OK, state(u8String3, u8Out));
+    VERIFY_ARE_EQUAL(std::string{ u8String3 }, std::string{ u8Out });
+    VERIFY_IS_TRUE(u8Out.data() == u8String3.data());
+}
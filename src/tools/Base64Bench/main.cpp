@@ -0,0 +1,192 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+//
+// Base64Bench
+// Compares the throughput of the base64 decoder used for OSC 52 clipboard
+// payloads against the character-at-a-time decoder it replaced.
+//
+// Usage: Base64Bench [iterations]
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <string>
+#include <string_view>
+
+#define NOMINMAX
+#include <windows.h>
+
+#include <gsl/gsl_util>
+#include <wil/result_macros.h>
+
+// til/u8u16convert.h relies on the chromium safe math that LibraryIncludes.h
+// usually provides, and this tool doesn't use the precompiled header.
+#pragma warning(push)
+#pragma warning(disable : 4100) // unreferenced parameter
+#include <base/numerics/safe_math.h>
+#pragma warning(pop)
+
+#include <til/u8u16convert.h>
+
+#include "../../terminal/parser/base64.hpp"
+
+using namespace Microsoft::Console::VirtualTerminal;
+
+namespace
+{
+    // The decoder as it was before Base64::Decoder, minus the final
+    // transcoding to UTF-16, which both versions share.
+    bool LegacyDecode(const std::wstring_view src, std::string& mbStr)
+    {
+        static const char base64Chars[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+        const auto isSpace = [](const wchar_t ch) { return ch == L'\r' || ch == L'\n'; };
+
+        int state = 0;
+        char tmp = 0;
+
+        mbStr.reserve(src.size() / 4 * 3);
+
+        auto iter = src.cbegin();
+        while (iter < src.cend())
+        {
+            if (isSpace(*iter))
+            {
+                iter++;
+                continue;
+            }
+
+            if (*iter == L'=')
+            {
+                break;
+            }
+
+            auto pos = strchr(base64Chars, *iter);
+            if (!pos)
+            {
+                return false;
+            }
+
+            switch (state)
+            {
+            case 0:
+                tmp = (char)(pos - base64Chars) << 2;
+                state = 1;
+                break;
+            case 1:
+                tmp |= (char)(pos - base64Chars) >> 4;
+                mbStr += tmp;
+                tmp = (char)((pos - base64Chars) & 0x0f) << 4;
+                state = 2;
+                break;
+            case 2:
+                tmp |= (char)(pos - base64Chars) >> 2;
+                mbStr += tmp;
+                tmp = (char)((pos - base64Chars) & 0x03) << 6;
+                state = 3;
+                break;
+            case 3:
+                tmp |= pos - base64Chars;
+                mbStr += tmp;
+                state = 0;
+                break;
+            default:
+                break;
+            }
+
+            iter++;
+        }
+
+        // Padding validation is skipped, the payloads here are all well-formed.
+        return true;
+    }
+
+    bool CurrentDecode(const std::wstring_view src, std::string& mbStr)
+    {
+        mbStr.reserve(src.size() / 4 * 3);
+
+        Base64::Decoder decoder;
+        return decoder.Decode(src, mbStr) && decoder.Finish();
+    }
+
+    // Builds a payload like the one an OSC 52 copy of some source code would
+    // carry: printable ASCII with line breaks, encoded in one long line.
+    std::wstring MakePayload(const size_t size)
+    {
+        std::mt19937 rng{ 42 };
+        std::uniform_int_distribution<int> dist{ 0x20, 0x7e };
+
+        std::wstring text;
+        text.reserve(size);
+        while (text.size() < size)
+        {
+            text.push_back(text.size() % 80 == 79 ? L'\n' : gsl::narrow_cast<wchar_t>(dist(rng)));
+        }
+        return Base64::s_Encode(text);
+    }
+
+    // Wraps the payload into lines of 76 characters, like MIME does.
+    std::wstring Wrap(const std::wstring_view payload)
+    {
+        std::wstring wrapped;
+        for (size_t i = 0; i < payload.size(); i += 76)
+        {
+            wrapped.append(payload.substr(i, 76));
+            wrapped.append(L"\r\n");
+        }
+        return wrapped;
+    }
+
+    template<typename Decode>
+    double Measure(const Decode& decode, const std::wstring_view payload, const size_t iterations, std::string& result)
+    {
+        const auto start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < iterations; ++i)
+        {
+            result.clear();
+            if (!decode(payload, result))
+            {
+                return 0;
+            }
+        }
+        const auto end = std::chrono::steady_clock::now();
+
+        const auto megabytes = payload.size() * iterations / (1024.0 * 1024.0);
+        return megabytes / std::chrono::duration<double>(end - start).count();
+    }
+}
+
+int __cdecl wmain(int argc, wchar_t* argv[])
+{
+    const size_t iterations = argc > 1 ? std::max<size_t>(std::wcstoul(argv[1], nullptr, 10), 1) : 20;
+
+    wprintf(L"%-24s %12s %12s %10s\n", L"payload", L"legacy MB/s", L"MB/s", L"speedup");
+
+    for (const size_t size : { 1024u, 64u * 1024u, 4u * 1024u * 1024u })
+    {
+        const auto payload = MakePayload(size);
+        const auto wrapped = Wrap(payload);
+
+        for (const auto& [name, input] : { std::pair{ L"single line", std::wstring_view{ payload } },
+                                           std::pair{ L"wrapped", std::wstring_view{ wrapped } } })
+        {
+            std::string legacyResult;
+            std::string currentResult;
+            const auto legacy = Measure(LegacyDecode, input, iterations, legacyResult);
+            const auto current = Measure(CurrentDecode, input, iterations, currentResult);
+
+            if (legacyResult != currentResult)
+            {
+                fwprintf(stderr, L"Results differ for %zu bytes, %s\n", size, name);
+                return 1;
+            }
+
+            wchar_t label[32];
+            swprintf_s(label, L"%zu KB, %s", size / 1024, name);
+            wprintf(L"%-24s %12.1f %12.1f %9.1fx\n", label, legacy, current, legacy > 0 ? current / legacy : 0.0);
+        }
+    }
+
+    return 0;
+}
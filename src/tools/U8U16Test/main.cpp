@@ -3,6 +3,8 @@
 // NOTE The functions u8u16 and u16u8 contain own algorithms. Tests have shown that they perform
 // worse than the platform API functions.
 // Thus, these functions are *unrelated* to the til::u8u16 and til::u16u8 implementation.
+// The CompTil_* tests measure the til functions themselves, in order to see what
+// their ASCII fast path gains over calling the platform API functions directly.
 
 #include <iostream>
 #include <memory>
@@ -13,6 +15,18 @@
 
 #include "U8U16Test.hpp"
 
+#include <gsl/gsl_util>
+#include <wil/result_macros.h>
+
+// til/u8u16convert.h relies on the chromium safe math that LibraryIncludes.h
+// usually provides, and this tool doesn't use the precompiled header.
+#pragma warning(push)
+#pragma warning(disable : 4100) // unreferenced parameter
+#include <base/numerics/safe_math.h>
+#pragma warning(pop)
+
+#include <til/u8u16convert.h>
+
 typedef NTSTATUS(WINAPI* t_RtlUTF8ToUnicodeN)(PWSTR, ULONG, PULONG, PCCH, ULONG);
 typedef NTSTATUS(WINAPI* t_RtlUnicodeToUTF8N)(PCHAR, ULONG, PULONG, PCWSTR, ULONG);
 NTSTATUS(WINAPI* p_RtlUTF8ToUnicodeN)
@@ -442,6 +456,62 @@ void CompNaturalLang_Chunks(const std::string& fileName)
     std::cout << " u16u8_ptr           length " << lenTotalU16U8 << " elapsed " << durTotalU16U8 << std::endl;
 }
 
+void CompTil_WholeString(const std::string& name, const std::string& u8Str)
+{
+    std::string head{ __func__ };
+    head += " - " + name;
+    PrintHeader(head.c_str());
+
+    GetDuration();
+    std::unique_ptr<wchar_t[]> u16Buffer{ std::make_unique<wchar_t[]>(u8Str.length()) };
+    int length = MultiByteToWideChar(65001, 0, u8Str.data(), static_cast<int>(u8Str.length()), u16Buffer.get(), static_cast<int>(u8Str.length()));
+    double duration = GetDuration();
+    u16Buffer.reset();
+    std::cout << " MultiByteToWideChar length " << length << " elapsed " << duration << std::endl;
+
+    GetDuration();
+    std::wstring u16Str{};
+    HRESULT hRes = til::u8u16(u8Str, u16Str);
+    duration = GetDuration();
+    std::cout << " til::u8u16          length " << u16Str.length() << " elapsed " << duration << " HRESULT " << hRes << std::endl;
+
+    GetDuration();
+    std::unique_ptr<char[]> u8Buffer{ std::make_unique<char[]>(u16Str.length() * 3) };
+    length = WideCharToMultiByte(65001, 0, u16Str.data(), static_cast<int>(u16Str.length()), u8Buffer.get(), static_cast<int>(u16Str.length()) * 3, nullptr, nullptr);
+    duration = GetDuration();
+    u8Buffer.reset();
+    std::cout << " WideCharToMultiByte length " << length << " elapsed " << duration << std::endl;
+
+    GetDuration();
+    std::string u8StrOut{};
+    hRes = til::u16u8(u16Str, u8StrOut);
+    duration = GetDuration();
+    std::cout << " til::u16u8          length " << u8StrOut.length() << " elapsed " << duration << " HRESULT " << hRes << std::endl;
+}
+
+// conpty hands over its output in reads of at most 4 KiB, each of which goes through a til::u8state
+void CompTil_Chunks(const std::string& name, const std::string& u8Str)
+{
+    std::string head{ __func__ };
+    head += " - " + name;
+    PrintHeader(head.c_str());
+
+    constexpr const size_t chunkSize{ 4096u };
+    til::u8state state{};
+    std::wstring u16Str{};
+    size_t length{};
+    HRESULT hRes{};
+
+    GetDuration();
+    for (size_t idx = 0u; idx < u8Str.length(); idx += chunkSize)
+    {
+        hRes = til::u8u16(std::string_view{ u8Str }.substr(idx, chunkSize), u16Str, state);
+        length += u16Str.length();
+    }
+    const double duration = GetDuration();
+    std::cout << " til::u8u16 (state)  length " << length << " elapsed " << duration << " HRESULT " << hRes << std::endl;
+}
+
 int main()
 {
     // UTF-16 string length
@@ -519,6 +589,24 @@ int main()
     CompNaturalLang_Chunks("ru.txt");
     CompNaturalLang_Chunks("zh.txt");
 
+    std::cout << "\n\n### til ###" << std::endl;
+
+    const std::string asciiStr(u16Length, '~');
+    CompTil_WholeString("ASCII", asciiStr);
+    CompTil_Chunks("ASCII", asciiStr);
+    CompTil_WholeString("U+20AC", u8Str);
+    CompTil_Chunks("U+20AC", u8Str);
+    for (const auto fileName : { "en.txt", "fr.txt", "ru.txt", "zh.txt" })
+    {
+        std::ostringstream u8Ss{};
+        std::ostringstream buf{};
+        buf << std::ifstream{ fileName }.rdbuf();
+        std::fill_n(std::ostream_iterator<const char*>{ u8Ss }, 300000u, buf.str().c_str());
+        const std::string natural{ u8Ss.str() };
+        CompTil_WholeString(fileName, natural);
+        CompTil_Chunks(fileName, natural);
+    }
+
     FreeLibrary(ntdll);
     return 0;
 }
@@ -0,0 +1,169 @@
+################################################################################
+#                                                                              #
+# Copyright (c) Microsoft Corporation.
+# Licensed under the MIT license.
+#                                                                              #
+################################################################################
+
+"""
+Regenerates the synthetic VT streams vtbench and vtbench-conhost replay. The
+output is deterministic (fixed seed), so the committed files only change when
+this script does, and numbers stay comparable across versions.
+
+Run this file with:
+    python generate.py
+"""
+import os
+import random
+
+CSI = '\x1b['
+TARGET_SIZE = 256 * 1024
+
+WORDS = ['warning', 'error', 'note', 'include', 'template', 'instantiated',
+         'from', 'here', 'const', 'std::vector', 'unsigned', 'int', 'return',
+         'value', 'buffer', 'textBuffer.cpp', 'renderer.cpp', 'size_t', 'auto']
+
+EMOJI = ['\U0001F32F', '\U0001F9C0', '\U0001F336', '\U0001F345', '\U0001F469\u200d\U0001F373',
+         '\u2764\ufe0f', '\U0001F44D\U0001F3FD', '\U0001F1FA\U0001F1F8', 'e\u0301', '\u4e2d\u6587']
+
+
+def sentence(rng, words):
+    return ' '.join(rng.choice(words) for _ in range(rng.randint(4, 14)))
+
+
+def plain(rng):
+    # A build log: plain ASCII lines, no escape sequences at all.
+    while True:
+        yield '[%5d] %s\r\n' % (rng.randint(0, 99999), sentence(rng, WORDS))
+
+
+def sgr(rng):
+    # Compiler/syntax highlighted output: an SGR change every few words.
+    colors = ['31', '32', '33', '34', '35', '36', '1;31', '38;5;208', '38;2;255;128;0', '0;1;33']
+    while True:
+        line = ''
+        for word in sentence(rng, WORDS).split(' '):
+            line += '%s%sm%s%s0m ' % (CSI, rng.choice(colors), word, CSI)
+        yield line + '\r\n'
+
+
+def emoji(rng):
+    # Wide glyphs, ZWJ sequences and combining characters mixed with text.
+    while True:
+        parts = []
+        for _ in range(rng.randint(4, 12)):
+            parts.append(rng.choice(EMOJI) if rng.random() < 0.5 else rng.choice(WORDS))
+        yield ' '.join(parts) + '\r\n'
+
+
+def highlight(rng):
+    # A syntax highlighting pager in the style of bat or delta: a 256-color
+    # line number gutter, then a truecolor foreground for every token, reset
+    # after each one, and a truecolor background on added and removed lines.
+    colors = ['38;2;%d;%d;%d' % (rng.randint(0, 255), rng.randint(0, 255), rng.randint(0, 255)) for _ in range(12)]
+    backgrounds = ['48;2;0;64;0', '48;2;64;0;0']
+    number = 0
+    while True:
+        number += 1
+        line = '%s38;5;238m%5d %s0m' % (CSI, number, CSI)
+        background = rng.choice(backgrounds) if rng.random() < 0.3 else None
+        for word in sentence(rng, WORDS).split(' '):
+            if background:
+                line += '%s%sm' % (CSI, background)
+            line += '%s%sm%s%s0m ' % (CSI, rng.choice(colors), word, CSI)
+        yield line + CSI + '0m\r\n'
+
+
+def tui(rng):
+    # A full-screen, cursor-addressed app redrawing parts of a 120x30 screen,
+    # in the style of htop or a scrolling editor with a status line.
+    width, height = 120, 30
+    yield CSI + '?1049h' + CSI + 'H' + CSI + '2J'
+    while True:
+        out = CSI + '1;%dr' % (height - 1)
+        for _ in range(rng.randint(5, 20)):
+            row, col = rng.randint(1, height - 1), rng.randint(1, width - 20)
+            out += '%s%d;%dH%s%sm%s' % (CSI, row, col, CSI, rng.choice(['7', '0', '1;32', '44']), rng.choice(WORDS))
+        out += CSI + '%d;1H' % (height - 1) + '\n'
+        out += '%s%d;1H%s7m%s%s0m' % (CSI, height, CSI, sentence(rng, WORDS)[:width].ljust(width), CSI)
+        yield out
+
+
+def vim(rng):
+    # Scrolling through a file in an editor: the text area is a scroll region
+    # above a status line, and every step scrolls it by a line or a page and
+    # redraws the lines that were revealed.
+    width, height = 120, 30
+    yield CSI + '?1049h' + CSI + 'H' + CSI + '2J'
+    number = 0
+    while True:
+        out = CSI + '1;%dr' % (height - 1)
+        lines = 1 if rng.random() < 0.8 else height - 1
+        if rng.random() < 0.5:
+            out += CSI + '%dS' % lines
+            rows = range(height - lines, height)
+        else:
+            out += CSI + 'H' + ('\x1bM' * lines)
+            rows = range(1, lines + 1)
+        for row in rows:
+            number += 1
+            out += '%s%d;1H%s33m%4d %s0m%s%s' % (CSI, row, CSI, number, CSI, sentence(rng, WORDS)[:width - 5], CSI + 'K')
+        out += CSI + 'r' + '%s%d;1H%s7m%s%s0m' % (CSI, height, CSI, ('line %d' % number).ljust(width), CSI)
+        yield out
+
+
+def cmatrix(rng):
+    # Falling green characters: every character is written with its own
+    # cursor position and color, all over the screen.
+    width, height = 120, 30
+    yield CSI + '?1049h' + CSI + '?25l' + CSI + 'H' + CSI + '2J'
+    while True:
+        out = ''
+        for _ in range(rng.randint(20, 60)):
+            out += '%s%d;%dH%s%sm%s' % (CSI, rng.randint(1, height), rng.randint(1, width),
+                                        CSI, rng.choice(['32', '1;32', '92']), chr(rng.randint(0x21, 0x7e)))
+        yield out
+
+
+def rtl(rng):
+    # Hebrew and Arabic text, mixed with left-to-right words and numbers.
+    hebrew = ['\u05e9\u05dc\u05d5\u05dd', '\u05e2\u05d5\u05dc\u05dd', '\u05e7\u05d5\u05d1\u05e5', '\u05e9\u05d2\u05d9\u05d0\u05d4']
+    arabic = ['\u0645\u0631\u062d\u0628\u0627', '\u0627\u0644\u0639\u0627\u0644\u0645', '\u0645\u0644\u0641', '\u062e\u0637\u0623']
+    while True:
+        words = hebrew if rng.random() < 0.5 else arabic
+        parts = [rng.choice(words) if rng.random() < 0.7 else rng.choice(WORDS) for _ in range(rng.randint(4, 12))]
+        yield '%d: %s\r\n' % (rng.randint(0, 999), ' '.join(parts))
+
+
+def hyperlinks(rng):
+    # A flood of OSC 8 hyperlinks, like ls --hyperlink or a linkified log,
+    # with a different URI for almost every link.
+    while True:
+        line = ''
+        for word in sentence(rng, WORDS).split(' '):
+            uri = 'file:///home/user/src/%s/%d' % (word, rng.randint(0, 9999))
+            line += '\x1b]8;;%s\x1b\\%s\x1b]8;;\x1b\\ ' % (uri, word)
+        yield line + '\r\n'
+
+
+def write(name, generator):
+    rng = random.Random(name)
+    data = b''
+    for chunk in generator(rng):
+        data += chunk.encode('utf-8')
+        if len(data) >= TARGET_SIZE:
+            break
+    with open(os.path.join(os.path.dirname(os.path.abspath(__file__)), name), 'wb') as f:
+        f.write(data)
+
+
+if __name__ == '__main__':
+    write('plain.txt', plain)
+    write('sgr.txt', sgr)
+    write('emoji.txt', emoji)
+    write('highlight.txt', highlight)
+    write('tui.txt', tui)
+    write('vim.txt', vim)
+    write('cmatrix.txt', cmatrix)
+    write('rtl.txt', rtl)
+    write('hyperlinks.txt', hyperlinks)
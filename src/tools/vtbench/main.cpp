@@ -0,0 +1,88 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+//
+// vtbench
+// Feeds captured VT streams through StateMachine -> Terminal -> Renderer
+// without a window, using the headless RecordingRenderEngine, and reports
+// throughput, frame counts, heap allocations, write and frame times.
+// vtbench-conhost (src/host/ft_vtbench) does the same for conhost.
+//
+// Usage: vtbench [-w width] [-h height] [-c chunkBytes] [-n iterations] [-r] [-t] [-j] file...
+//   -w, -h  Size of the terminal viewport (default 120x30).
+//   -c      Number of bytes handed to the terminal between two frames,
+//           mimicking the read size of a connection (default 4096).
+//   -n      Number of times each file is replayed (default 5).
+//   -r      Record the painted clusters and brushes like a real engine would
+//           need them, instead of only counting the calls.
+//   -t      Transcode every chunk to UTF-16 before writing it, like
+//           ConptyConnection does, instead of using the UTF-8 entry point.
+//   -j      Print the results as JSON, for tracking them across versions.
+
+#include "pch.h"
+
+#include "../../cascadia/TerminalCore/Terminal.hpp"
+#include "../../renderer/base/renderer.hpp"
+#include "../../renderer/inc/RecordingRenderEngine.hpp"
+#include "replay.hpp"
+
+using namespace Microsoft::Terminal::Core;
+using namespace Microsoft::Console::Render;
+using namespace Microsoft::Console::VtBench;
+
+namespace
+{
+    // Replays a single stream once through a freshly created terminal.
+    void RunOnce(const Options& options, const std::string_view data, Result& result)
+    {
+        Terminal terminal;
+        RecordingRenderEngine engine{ options.record };
+        IRenderEngine* engines[] = { &engine };
+
+        // No render thread: we drive PaintFrame ourselves after every chunk,
+        // so that each chunk is exactly one frame.
+        Renderer renderer{ &terminal, engines, ARRAYSIZE(engines), nullptr };
+        terminal.Create({ options.width, options.height }, ScrollbackLines, renderer);
+
+        til::u8state state;
+        std::wstring text;
+
+        const Stopwatch stopwatch;
+
+        for (size_t offset = 0; offset < data.size(); offset += options.chunkSize)
+        {
+            const auto chunk = data.substr(offset, options.chunkSize);
+            Time(result.writeTimes, [&]() {
+                if (options.transcode)
+                {
+                    THROW_IF_FAILED(til::u8u16(chunk, text, state));
+                    terminal.Write(text);
+                }
+                else
+                {
+                    terminal.WriteUtf8(chunk);
+                }
+            });
+
+            Time(result.frameTimes, [&]() {
+                THROW_IF_FAILED(renderer.PaintFrame());
+            });
+        }
+
+        stopwatch.Stop(result);
+        result.bytes += data.size();
+        result.frames += engine.GetCounters().frames;
+        result.paintedLines += engine.GetCounters().paintedLines;
+    }
+}
+
+int __cdecl wmain(int argc, wchar_t* argv[])
+try
+{
+    return Run(L"terminal", argc, argv, RunOnce);
+}
+catch (...)
+{
+    LOG_CAUGHT_EXCEPTION();
+    fwprintf(stderr, L"vtbench failed: 0x%08x\n", static_cast<unsigned int>(wil::ResultFromCaughtException()));
+    return 1;
+}
@@ -0,0 +1,40 @@
+/*++
+Copyright (c) Microsoft Corporation
+Licensed under the MIT license.
+
+Module Name:
+- pch.h
+
+Abstract:
+- Contains external headers to include in the precompile phase of console build process.
+- Avoid including internal project headers. Instead include them only in the classes that need them (helps with test project building).
+--*/
+
+#pragma once
+
+// Block minwindef.h min/max macros to prevent <algorithm> conflict
+#define NOMINMAX
+
+#define WIN32_LEAN_AND_MEAN
+#define NOMCX
+#define NOHELP
+#define NOCOMM
+#include <unknwn.h>
+
+#include <windows.h>
+
+#define BLOCK_TIL
+#include "LibraryIncludes.h"
+#ifdef GetCurrentTime
+#undef GetCurrentTime
+#endif
+
+#include <wil/cppwinrt.h>
+
+#include <winrt/Windows.Foundation.h>
+#include <winrt/Microsoft.Terminal.Core.h>
+
+#include "til.h"
+
+#include <chrono>
+#include <cstdio>
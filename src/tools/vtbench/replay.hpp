@@ -0,0 +1,315 @@
+/*++
+Copyright (c) Microsoft Corporation
+Licensed under the MIT license.
+
+Module Name:
+- replay.hpp
+
+Abstract:
+- The parts of the VT replay benchmarks that don't depend on the pipeline
+  being measured: argument parsing, allocation counting, statistics and the
+  report. vtbench replays through Terminal and TerminalDispatch, vtbench-conhost
+  through conhost and AdaptDispatch.
+- This replaces the global operator new, so it must only be included by the
+  translation unit that defines wmain.
+--*/
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "til/counters.h"
+
+// Every heap allocation in this process goes through these, which lets us
+// count allocations done by the pipeline without any external tooling.
+static std::atomic<size_t> s_allocations{ 0 };
+
+void* operator new(size_t size)
+{
+    s_allocations.fetch_add(1, std::memory_order_relaxed);
+    if (const auto p = malloc(size ? size : 1))
+    {
+        return p;
+    }
+    throw std::bad_alloc{};
+}
+
+void operator delete(void* p) noexcept
+{
+    free(p);
+}
+
+void operator delete(void* p, size_t) noexcept
+{
+    free(p);
+}
+
+namespace Microsoft::Console::VtBench
+{
+    // Bump this whenever the meaning of a reported number changes, so that
+    // results from different versions aren't compared by accident.
+    static constexpr int ReportVersion = 1;
+
+    static constexpr SHORT ScrollbackLines = 9001;
+
+    struct Options
+    {
+        SHORT width = 120;
+        SHORT height = 30;
+        size_t chunkSize = 4096;
+        size_t iterations = 5;
+        bool record = false;
+        bool transcode = false;
+        bool json = false;
+        std::vector<std::filesystem::path> files;
+    };
+
+    struct Result
+    {
+        size_t bytes = 0;
+        double seconds = 0;
+        size_t frames = 0;
+        size_t paintedLines = 0;
+        size_t allocations = 0;
+        std::vector<double> writeTimes; // in microseconds
+        std::vector<double> frameTimes; // in microseconds
+    };
+
+    // Replays a stream once through a fresh instance of the pipeline, and adds
+    // the time and allocations spent on it to the result.
+    using Runner = std::function<void(const Options& options, const std::string_view data, Result& result)>;
+
+    // Measures the time and allocations between its construction and Stop().
+    class Stopwatch
+    {
+    public:
+        Stopwatch() noexcept :
+            _allocations{ s_allocations.load(std::memory_order_relaxed) },
+            _start{ std::chrono::steady_clock::now() }
+        {
+        }
+
+        void Stop(Result& result) const noexcept
+        {
+            const auto end = std::chrono::steady_clock::now();
+            result.allocations += s_allocations.load(std::memory_order_relaxed) - _allocations;
+            result.seconds += std::chrono::duration<double>(end - _start).count();
+        }
+
+    private:
+        size_t _allocations;
+        std::chrono::steady_clock::time_point _start;
+    };
+
+    // Times a single call and records it in the given list, in microseconds.
+    template<typename T>
+    void Time(std::vector<double>& times, const T& func)
+    {
+        const auto start = std::chrono::steady_clock::now();
+        func();
+        const auto end = std::chrono::steady_clock::now();
+        times.emplace_back(std::chrono::duration<double, std::micro>(end - start).count());
+    }
+
+    inline std::string ReadFile(const std::filesystem::path& path)
+    {
+        std::ifstream file{ path, std::ios::binary };
+        THROW_HR_IF(HRESULT_FROM_WIN32(ERROR_FILE_NOT_FOUND), !file);
+        return { std::istreambuf_iterator<char>{ file }, std::istreambuf_iterator<char>{} };
+    }
+
+    inline double Percentile(std::vector<double>& values, const double percentile)
+    {
+        if (values.empty())
+        {
+            return 0;
+        }
+
+        const auto index = gsl::narrow_cast<size_t>(percentile * (values.size() - 1));
+        std::nth_element(values.begin(), values.begin() + index, values.end());
+        return values[index];
+    }
+
+    inline bool ParseArgs(const int argc, const wchar_t* const argv[], Options& options)
+    {
+        for (int i = 1; i < argc; ++i)
+        {
+            const std::wstring_view arg{ argv[i] };
+            const auto hasValue = i + 1 < argc;
+
+            if (arg == L"-w" && hasValue)
+            {
+                options.width = gsl::narrow<SHORT>(std::stoi(argv[++i]));
+            }
+            else if (arg == L"-h" && hasValue)
+            {
+                options.height = gsl::narrow<SHORT>(std::stoi(argv[++i]));
+            }
+            else if (arg == L"-c" && hasValue)
+            {
+                options.chunkSize = std::max<size_t>(std::stoul(argv[++i]), 1);
+            }
+            else if (arg == L"-n" && hasValue)
+            {
+                options.iterations = std::max<size_t>(std::stoul(argv[++i]), 1);
+            }
+            else if (arg == L"-r")
+            {
+                options.record = true;
+            }
+            else if (arg == L"-t")
+            {
+                options.transcode = true;
+            }
+            else if (arg == L"-j")
+            {
+                options.json = true;
+            }
+            else if (!arg.empty() && arg.front() != L'-')
+            {
+                options.files.emplace_back(arg);
+            }
+            else
+            {
+                return false;
+            }
+        }
+
+        return !options.files.empty();
+    }
+
+    // Escapes a file name for use in a JSON string.
+    inline std::wstring JsonEscape(const std::wstring_view text)
+    {
+        std::wstring escaped;
+        for (const auto ch : text)
+        {
+            if (ch == L'"' || ch == L'\\')
+            {
+                escaped.push_back(L'\\');
+                escaped.push_back(ch);
+            }
+            else if (ch < L' ')
+            {
+                wchar_t buffer[8];
+                swprintf_s(buffer, L"\\u%04x", static_cast<unsigned int>(ch));
+                escaped.append(buffer);
+            }
+            else
+            {
+                escaped.push_back(ch);
+            }
+        }
+        return escaped;
+    }
+
+    // Runs every file given on the command line and prints one line per
+    // file, either as a table or, with -j, as a JSON document that can be
+    // stored and compared across versions.
+    inline int Run(const wchar_t* const pipeline, const int argc, const wchar_t* const argv[], const Runner& runOnce)
+    {
+        Options options;
+        if (!ParseArgs(argc, argv, options))
+        {
+            fwprintf(stderr, L"Usage: %s [-w width] [-h height] [-c chunkBytes] [-n iterations] [-r] [-t] [-j] file...\n", argv[0]);
+            return 1;
+        }
+
+        if (options.json)
+        {
+            wprintf(L"{\n  \"version\": %d,\n  \"pipeline\": \"%s\",\n", ReportVersion, pipeline);
+            wprintf(L"  \"width\": %d,\n  \"height\": %d,\n  \"chunkSize\": %zu,\n  \"iterations\": %zu,\n",
+                    options.width,
+                    options.height,
+                    options.chunkSize,
+                    options.iterations);
+            wprintf(L"  \"results\": [");
+        }
+        else
+        {
+            wprintf(L"%-24s %10s %10s %12s %12s %10s %10s %10s %10s\n",
+                    L"corpus",
+                    L"MB/s",
+                    L"frames",
+                    L"lines",
+                    L"allocs",
+                    L"write p50",
+                    L"write p99",
+                    L"frame p50",
+                    L"frame p99");
+        }
+
+        for (size_t fileIndex = 0; fileIndex < options.files.size(); ++fileIndex)
+        {
+            const auto& file = options.files[fileIndex];
+            const auto data = ReadFile(file);
+
+            // One untimed warm-up run, so that the first corpus doesn't pay for
+            // faulting in code and the allocator's initial growth.
+            Result warmup;
+            runOnce(options, data, warmup);
+
+            til::counters::reset();
+
+            Result result;
+            for (size_t i = 0; i < options.iterations; ++i)
+            {
+                runOnce(options, data, result);
+            }
+
+            const auto megabytes = result.bytes / (1024.0 * 1024.0);
+            const auto throughput = result.seconds > 0 ? megabytes / result.seconds : 0.0;
+            const auto writeP50 = Percentile(result.writeTimes, 0.50);
+            const auto writeP99 = Percentile(result.writeTimes, 0.99);
+            const auto frameP50 = Percentile(result.frameTimes, 0.50);
+            const auto frameP99 = Percentile(result.frameTimes, 0.99);
+
+            if (options.json)
+            {
+                wprintf(L"%s\n    {\n", fileIndex ? L"," : L"");
+                wprintf(L"      \"corpus\": \"%s\",\n", JsonEscape(file.filename().native()).c_str());
+                wprintf(L"      \"bytes\": %zu,\n", data.size());
+                wprintf(L"      \"mbPerSecond\": %.3f,\n", throughput);
+                wprintf(L"      \"frames\": %zu,\n", result.frames / options.iterations);
+                wprintf(L"      \"paintedLines\": %zu,\n", result.paintedLines / options.iterations);
+                wprintf(L"      \"allocations\": %zu,\n", result.allocations / options.iterations);
+                wprintf(L"      \"writeP50Us\": %.2f,\n      \"writeP99Us\": %.2f,\n", writeP50, writeP99);
+                wprintf(L"      \"frameP50Us\": %.2f,\n      \"frameP99Us\": %.2f", frameP50, frameP99);
+#if TIL_COUNTERS_ENABLED
+                // The counters are totals over all iterations.
+                wprintf(L",\n      \"counters\": %hs", til::counters::dump_json().c_str());
+#endif
+                wprintf(L"\n    }");
+            }
+            else
+            {
+                wprintf(L"%-24s %10.2f %10zu %12zu %12zu %10.1f %10.1f %10.1f %10.1f\n",
+                        file.filename().c_str(),
+                        throughput,
+                        result.frames / options.iterations,
+                        result.paintedLines / options.iterations,
+                        result.allocations / options.iterations,
+                        writeP50,
+                        writeP99,
+                        frameP50,
+                        frameP99);
+            }
+        }
+
+        if (options.json)
+        {
+            wprintf(L"\n  ]\n}\n");
+        }
+
+        return 0;
+    }
+}